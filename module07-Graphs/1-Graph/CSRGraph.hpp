@@ -0,0 +1,273 @@
+#pragma once
+
+#include <doctest.h>
+#include <stdexcept>
+#include <vector>
+#include "Graph.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Immutable compressed sparse row (CSR) snapshot of a Graph.
+ *
+ * A Graph stores each adjacency list as a separate std::list, so walking the
+ * edges means chasing one pointer per edge. This class copies the edges of a
+ * Graph into a handful of contiguous arrays instead:
+ *
+ * - the out-edges of vertex u are stored in positions
+ *   [outBegin(u), outEnd(u)) of the outTarget / outWeight arrays (CSR form)
+ *
+ * - the in-edges of vertex v are stored in positions
+ *   [inBegin(v), inEnd(v)) of the inSource / inWeight arrays (CSC form)
+ *
+ * Vertices are numbered [1, |V|], exactly as they are in the Graph. Edges
+ * keep the order they had in the Graph's adjacency lists, and parallel edges
+ * are kept. The snapshot does not change if the original Graph does, and
+ * since it has no mutating methods it can be read by many threads at once.
+ */
+class CSRGraph {
+public:
+    /**
+     * @brief Construct a new CSRGraph snapshot of a Graph.
+     *
+     * @param g Graph to copy. Runs in O(|V| + |E|) time.
+     */
+    CSRGraph(const Graph &g);
+
+    /**
+     * @brief Get number of vertices in the graph.
+     *
+     * @return size_t value holding the number of vertices in the graph.
+     */
+    size_t numVertices() const { return numV; }
+
+    /**
+     * @brief Get number of edges in the graph.
+     *
+     * @return size_t value holding the number of edges in the graph.
+     */
+    size_t numEdges() const { return outTargets.size(); }
+
+    /**
+     * @brief Index of the first out-edge of vertex u.
+     *
+     * @param u Vertex number in [1, |V|]. Not range checked.
+     * @return size_t index into the outTarget / outWeight arrays.
+     */
+    size_t outBegin(size_t u) const { return outOffsets[u]; }
+
+    /**
+     * @brief Index one past the last out-edge of vertex u.
+     *
+     * @param u Vertex number in [1, |V|]. Not range checked.
+     * @return size_t index into the outTarget / outWeight arrays.
+     */
+    size_t outEnd(size_t u) const { return outOffsets[u + 1]; }
+
+    /**
+     * @brief Number of edges leaving vertex u.
+     *
+     * @param u Vertex number in [1, |V|]. Not range checked.
+     * @return size_t out-degree of u.
+     */
+    size_t outDegree(size_t u) const { return outOffsets[u + 1] - outOffsets[u]; }
+
+    /**
+     * @brief "To" vertex of out-edge e.
+     *
+     * @param e Edge index in [0, |E|). Not range checked.
+     * @return size_t vertex number v of the edge (u, v).
+     */
+    size_t outTarget(size_t e) const { return outTargets[e]; }
+
+    /**
+     * @brief Weight of out-edge e.
+     *
+     * @param e Edge index in [0, |E|). Not range checked.
+     * @return double weight of the edge.
+     */
+    double outWeight(size_t e) const { return outWeights[e]; }
+
+    /**
+     * @brief Index of the first in-edge of vertex v.
+     *
+     * @param v Vertex number in [1, |V|]. Not range checked.
+     * @return size_t index into the inSource / inWeight arrays.
+     */
+    size_t inBegin(size_t v) const { return inOffsets[v]; }
+
+    /**
+     * @brief Index one past the last in-edge of vertex v.
+     *
+     * @param v Vertex number in [1, |V|]. Not range checked.
+     * @return size_t index into the inSource / inWeight arrays.
+     */
+    size_t inEnd(size_t v) const { return inOffsets[v + 1]; }
+
+    /**
+     * @brief "From" vertex of in-edge e.
+     *
+     * @param e Edge index in [0, |E|). Not range checked.
+     * @return size_t vertex number u of the edge (u, v).
+     */
+    size_t inSource(size_t e) const { return inSources[e]; }
+
+    /**
+     * @brief Weight of in-edge e.
+     *
+     * @param e Edge index in [0, |E|). Not range checked.
+     * @return double weight of the edge.
+     */
+    double inWeight(size_t e) const { return inWeights[e]; }
+
+    /**
+     * @brief Raw pointer to the in-edge source array, for tight loops that
+     * should not pay for a function call per edge.
+     *
+     * @return const size_t* pointer to the first of |E| source vertices.
+     */
+    const size_t *inSourceData() const { return inSources.data(); }
+
+private:
+    /**
+     * @brief Number of vertices in the graph.
+     */
+    size_t numV;
+
+    /**
+     * @brief |V| + 2 offsets; out-edges of u are [outOffsets[u],
+     * outOffsets[u + 1]).
+     */
+    std::vector<size_t> outOffsets;
+
+    /**
+     * @brief "To" vertex of each out-edge.
+     */
+    std::vector<size_t> outTargets;
+
+    /**
+     * @brief Weight of each out-edge.
+     */
+    std::vector<double> outWeights;
+
+    /**
+     * @brief |V| + 2 offsets; in-edges of v are [inOffsets[v],
+     * inOffsets[v + 1]).
+     */
+    std::vector<size_t> inOffsets;
+
+    /**
+     * @brief "From" vertex of each in-edge.
+     */
+    std::vector<size_t> inSources;
+
+    /**
+     * @brief Weight of each in-edge.
+     */
+    std::vector<double> inWeights;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * constructor implementation.
+ */
+CSRGraph::CSRGraph(const Graph &g) : numV(g.numV),
+    outOffsets(g.numV + 2, 0u), inOffsets(g.numV + 2, 0u) {
+
+    // counting pass: out-degree of each vertex, in-degree of each vertex
+    for(size_t u = 1; u <= numV; u++) {
+        outOffsets[u + 1] = g.pAdjacents[u]->size();
+        for(const Graph::AdjEntry &a : *(g.pAdjacents[u])) {
+            inOffsets[a.v + 1]++;
+        }
+    }
+
+    // prefix sums turn the degrees into starting offsets
+    for(size_t u = 1; u <= numV; u++) {
+        outOffsets[u + 1] += outOffsets[u];
+        inOffsets[u + 1] += inOffsets[u];
+    }
+
+    size_t m = outOffsets[numV + 1];
+    outTargets.resize(m);
+    outWeights.resize(m);
+    inSources.resize(m);
+    inWeights.resize(m);
+
+    // placement pass; next[v] is the next free in-edge slot for vertex v
+    std::vector<size_t> next(inOffsets.begin(), inOffsets.end());
+    for(size_t u = 1; u <= numV; u++) {
+        size_t e = outOffsets[u];
+        for(const Graph::AdjEntry &a : *(g.pAdjacents[u])) {
+            outTargets[e] = a.v;
+            outWeights[e] = a.wUV;
+            e++;
+
+            inSources[next[a.v]] = u;
+            inWeights[next[a.v]] = a.wUV;
+            next[a.v]++;
+        }
+    }
+}
+
+// doctest unit test for the CSRGraph constructor
+TEST_CASE("testing CSRGraph::CSRGraph()") {
+    Graph g(5);
+
+    g.addEdge(1, 2, 10);
+    g.addEdge(1, 4, 5);
+    g.addEdge(2, 3, 1);
+    g.addEdge(2, 4, 2);
+    g.addEdge(3, 5, 4);
+    g.addEdge(4, 2, 3);
+    g.addEdge(4, 3, 9);
+    g.addEdge(4, 5, 1);
+    g.addEdge(5, 1, 7);
+    g.addEdge(5, 3, 6);
+
+    CSRGraph c(g);
+    CHECK(5 == c.numVertices());
+    CHECK(g.numEdges() == c.numEdges());
+
+    // every out-edge in the snapshot must be an edge in the graph
+    size_t outCount = 0u;
+    for(size_t u = 1; u <= 5; u++) {
+        for(size_t e = c.outBegin(u); e < c.outEnd(u); e++) {
+            CHECK(g.getEdge(u, c.outTarget(e)) == c.outWeight(e));
+            outCount++;
+        }
+    }
+    CHECK(10 == outCount);
+
+    // ... and so must every in-edge
+    size_t inCount = 0u;
+    for(size_t v = 1; v <= 5; v++) {
+        for(size_t e = c.inBegin(v); e < c.inEnd(v); e++) {
+            CHECK(g.getEdge(c.inSource(e), v) == c.inWeight(e));
+            inCount++;
+        }
+    }
+    CHECK(10 == inCount);
+
+    // spot check degrees and edge order
+    CHECK(2 == c.outDegree(1));
+    CHECK(3 == c.outDegree(4));
+    CHECK(2 == c.outTarget(c.outBegin(1)));
+    CHECK(4 == c.outTarget(c.outBegin(1) + 1));
+    CHECK(3 == c.inEnd(3) - c.inBegin(3));
+    CHECK(0 == c.inEnd(1) - c.inBegin(1) - 1);
+
+    // a graph with no edges
+    Graph h(3);
+    CSRGraph d(h);
+    CHECK(0 == d.numEdges());
+    for(size_t u = 1; u <= 3; u++) {
+        CHECK(0 == d.outDegree(u));
+        CHECK(d.inBegin(u) == d.inEnd(u));
+    }
+}
@@ -12,6 +12,8 @@
 #include <string>
 #include <vector> 
 
+class CSRGraph;
+
 /*-----------------------------------------------------------------------------
  * class definition
  *---------------------------------------------------------------------------*/
@@ -24,6 +26,9 @@
  * based on the graph algorithms discussed in 
  * 
  * Cormen, T. H., &; Leiserson, C. E. (2009). Introduction to algorithms, 3rd Ed. 
+ * 
+ * Graph is not thread-safe. To answer queries from several threads at once,
+ * wrap the graph in a GraphQueryService (GraphQueryService.hpp).
  */
 class Graph {
 private:
@@ -210,6 +215,12 @@ private:
      * 
      */
     std::list<AdjEntry> **pAdjacents;
+
+    /**
+     * @brief CSRGraph reads the adjacency lists directly when it builds its
+     * contiguous snapshot of the graph.
+     */
+    friend class CSRGraph;
 };
 
 //-----------------------------------------------------------------------------
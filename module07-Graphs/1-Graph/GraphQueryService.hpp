@@ -0,0 +1,495 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <doctest.h>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "CSRGraph.hpp"
+#include "SearchWorkspace.hpp"
+#include "ThreadPool.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Distances and predecessors from one source vertex, laid out like
+ * the pDist / pPred arrays of Graph::BFS() and Graph::Dijkstra().
+ */
+class ShortestPaths {
+public:
+    /**
+     * @brief Elements [1, |V|] hold the distance from the source to each
+     * vertex, infinity if it cannot be reached.
+     */
+    std::vector<double> dist;
+
+    /**
+     * @brief Elements [1, |V|] hold each vertex's predecessor on its path
+     * from the source, 0 if there is none.
+     */
+    std::vector<size_t> pred;
+};
+
+/**
+ * @brief Cheapest path between two vertices.
+ */
+class Route {
+public:
+    /**
+     * @brief Construct a new, empty Route.
+     */
+    Route() : cost(std::numeric_limits<double>::infinity()) { }
+
+    /**
+     * @brief Vertices on the path, source first; empty if there is no path.
+     */
+    std::vector<size_t> vertices;
+
+    /**
+     * @brief Total edge weight of the path, infinity if there is no path.
+     */
+    double cost;
+};
+
+/**
+ * @brief Throughput and latency figures for a GraphQueryService.
+ */
+class QueryStats {
+public:
+    /**
+     * @brief Construct a new, empty QueryStats object.
+     */
+    QueryStats() : queries(0), queriesPerSecond(0), p50(0), p99(0) { }
+
+    /**
+     * @brief Number of queries completed.
+     */
+    size_t queries;
+
+    /**
+     * @brief Queries completed per second of wall-clock time.
+     */
+    double queriesPerSecond;
+
+    /**
+     * @brief Median time, in seconds, from submitting a query to its
+     * result being ready.
+     */
+    double p50;
+
+    /**
+     * @brief 99th percentile time, in seconds, from submitting a query to
+     * its result being ready.
+     */
+    double p99;
+};
+
+/**
+ * @brief Thread-safe query front end for a Graph.
+ *
+ * Graph makes no promises about concurrent use, and its BFS() and
+ * Dijkstra() methods allocate fresh scratch memory on every call. This
+ * class freezes a Graph into an immutable CSRGraph snapshot, which any
+ * number of threads may read at once, and answers queries on a
+ * work-stealing ThreadPool. Each worker thread searches with its own
+ * SearchWorkspace, so queries share no mutable state and allocate no
+ * per-vertex scratch memory.
+ *
+ * Queries may be submitted from any number of threads. Each returns a
+ * std::future for its result. The service records how long every query
+ * takes from submission to completion, and reports throughput and median
+ * and 99th percentile latency through stats().
+ */
+class GraphQueryService {
+public:
+    /**
+     * @brief Construct a new GraphQueryService.
+     *
+     * @param g Graph to serve queries for. Later changes to g are not seen
+     * by the service.
+     * @param numThreads Number of worker threads; 0 means one per hardware
+     * thread.
+     */
+    GraphQueryService(const Graph &g, size_t numThreads = 0);
+
+    /**
+     * @brief Queue a breadth-first search from vertex s.
+     *
+     * @throws std::out_of_range if s is < 1 or > |V|.
+     */
+    std::future<ShortestPaths> BFS(size_t s);
+
+    /**
+     * @brief Queue a Dijkstra search from vertex s.
+     *
+     * @throws std::out_of_range if s is < 1 or > |V|.
+     */
+    std::future<ShortestPaths> Dijkstra(size_t s);
+
+    /**
+     * @brief Queue a search for the cheapest path from s to t. The search
+     * stops as soon as t is settled.
+     *
+     * @throws std::out_of_range if s or t is < 1 or > |V|.
+     */
+    std::future<Route> path(size_t s, size_t t);
+
+    /**
+     * @brief Get throughput and latency figures for the queries completed
+     * since construction or the last resetStats() call.
+     */
+    QueryStats stats() const;
+
+    /**
+     * @brief Forget recorded latencies and restart the throughput clock.
+     * Queries submitted before the reset are left out of later figures,
+     * even if they finish after it.
+     */
+    void resetStats();
+
+    /**
+     * @brief Get the snapshot the service searches.
+     */
+    const CSRGraph &getSnapshot() const { return snapshot; }
+
+private:
+    /**
+     * @brief Clock used for latency measurements.
+     */
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @brief Per-worker state: a search workspace and the latencies of the
+     * queries the worker has answered.
+     */
+    class Worker {
+    public:
+        /**
+         * @brief Scratch memory for this worker's searches.
+         */
+        SearchWorkspace ws;
+
+        /**
+         * @brief Latency, in seconds, of each query answered.
+         */
+        std::vector<double> latencies;
+
+        /**
+         * @brief Completion time of the most recent query.
+         */
+        Clock::time_point lastDone;
+
+        /**
+         * @brief Start of the current statistics window; queries submitted
+         * before it are not recorded.
+         */
+        Clock::time_point windowStart;
+
+        /**
+         * @brief Lock protecting latencies, lastDone, and windowStart
+         * against stats() and resetStats().
+         */
+        mutable std::mutex lock;
+    };
+
+    /**
+     * @brief Record a completed query's latency.
+     */
+    void record(size_t worker, Clock::time_point submitted);
+
+    /**
+     * @brief Copy a single-source search result out of a workspace.
+     */
+    ShortestPaths collect(const SearchWorkspace &ws) const;
+
+    /**
+     * @brief Throw std::out_of_range if v is not a vertex number.
+     */
+    void check(size_t v, const char *pMsg) const {
+        if(v == 0u || v > snapshot.numVertices()) {
+            throw std::out_of_range(pMsg);
+        }
+    }
+
+    /**
+     * @brief Immutable snapshot of the graph.
+     */
+    const CSRGraph snapshot;
+
+    /**
+     * @brief One Worker per pool thread.
+     */
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    /**
+     * @brief Lock keeping stats() and resetStats() from interleaving, so
+     * every worker has the same windowStart while stats() reads them.
+     */
+    mutable std::mutex statsLock;
+
+    /**
+     * @brief Pool running the queries; declared last so its threads stop
+     * before the state they use is destroyed.
+     */
+    ThreadPool pool;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * constructor implementation.
+ */
+GraphQueryService::GraphQueryService(const Graph &g, size_t numThreads) :
+    snapshot(g), pool(numThreads) {
+
+    Clock::time_point now = Clock::now();
+    for(size_t i = 0; i < pool.numThreads(); i++) {
+        workers.push_back(std::unique_ptr<Worker>(new Worker()));
+        workers.back()->windowStart = now;
+    }
+}
+
+/*
+ * record method implementation.
+ */
+void GraphQueryService::record(size_t worker, Clock::time_point submitted) {
+    Clock::time_point now = Clock::now();
+    Worker &w = *workers[worker];
+    std::lock_guard<std::mutex> guard(w.lock);
+    if(submitted < w.windowStart) {
+        return;
+    }
+    w.latencies.push_back(std::chrono::duration<double>(now - submitted).count());
+    w.lastDone = now;
+}
+
+/*
+ * collect method implementation.
+ */
+ShortestPaths GraphQueryService::collect(const SearchWorkspace &ws) const {
+    size_t n = snapshot.numVertices();
+    ShortestPaths result;
+    result.dist.resize(n + 1);
+    result.pred.resize(n + 1);
+    result.dist[0] = std::numeric_limits<double>::infinity();
+    result.pred[0] = 0u;
+    for(size_t v = 1; v <= n; v++) {
+        result.dist[v] = ws.dist(v);
+        result.pred[v] = ws.pred(v);
+    }
+    return result;
+}
+
+/*
+ * BFS method implementation.
+ */
+std::future<ShortestPaths> GraphQueryService::BFS(size_t s) {
+    check(s, "Illegal vertex in GraphQueryService::BFS()");
+    Clock::time_point submitted = Clock::now();
+    return pool.submit([this, s, submitted](size_t worker) {
+        SearchWorkspace &ws = workers[worker]->ws;
+        ws.BFS(snapshot, s);
+        ShortestPaths result = collect(ws);
+        record(worker, submitted);
+        return result;
+    });
+}
+
+/*
+ * Dijkstra method implementation.
+ */
+std::future<ShortestPaths> GraphQueryService::Dijkstra(size_t s) {
+    check(s, "Illegal vertex in GraphQueryService::Dijkstra()");
+    Clock::time_point submitted = Clock::now();
+    return pool.submit([this, s, submitted](size_t worker) {
+        SearchWorkspace &ws = workers[worker]->ws;
+        ws.Dijkstra(snapshot, s);
+        ShortestPaths result = collect(ws);
+        record(worker, submitted);
+        return result;
+    });
+}
+
+/*
+ * path method implementation.
+ */
+std::future<Route> GraphQueryService::path(size_t s, size_t t) {
+    check(s, "Illegal vertex in GraphQueryService::path()");
+    check(t, "Illegal vertex in GraphQueryService::path()");
+    Clock::time_point submitted = Clock::now();
+    return pool.submit([this, s, t, submitted](size_t worker) {
+        SearchWorkspace &ws = workers[worker]->ws;
+        ws.Dijkstra(snapshot, s, t);
+        Route result;
+        result.vertices = ws.path(t);
+        result.cost = ws.dist(t);
+        record(worker, submitted);
+        return result;
+    });
+}
+
+/*
+ * stats method implementation.
+ */
+QueryStats GraphQueryService::stats() const {
+    std::lock_guard<std::mutex> statsGuard(statsLock);
+    std::vector<double> all;
+    Clock::time_point windowStart, last;
+    for(const std::unique_ptr<Worker> &w : workers) {
+        std::lock_guard<std::mutex> guard(w->lock);
+        windowStart = w->windowStart;
+        last = std::max(last, windowStart);
+        all.insert(all.end(), w->latencies.begin(), w->latencies.end());
+        if(!w->latencies.empty()) {
+            last = std::max(last, w->lastDone);
+        }
+    }
+
+    QueryStats result;
+    result.queries = all.size();
+    if(all.empty()) {
+        return result;
+    }
+
+    double elapsed = std::chrono::duration<double>(last - windowStart).count();
+    result.queriesPerSecond = elapsed > 0 ? all.size() / elapsed : 0;
+
+    // the 50th and 99th percentiles by partial selection
+    size_t i50 = (all.size() - 1) * 50 / 100;
+    size_t i99 = (all.size() - 1) * 99 / 100;
+    std::nth_element(all.begin(), all.begin() + i50, all.end());
+    result.p50 = all[i50];
+    std::nth_element(all.begin(), all.begin() + i99, all.end());
+    result.p99 = all[i99];
+
+    return result;
+}
+
+/*
+ * resetStats method implementation.
+ */
+void GraphQueryService::resetStats() {
+    std::lock_guard<std::mutex> statsGuard(statsLock);
+    Clock::time_point now = Clock::now();
+    for(std::unique_ptr<Worker> &w : workers) {
+        std::lock_guard<std::mutex> guard(w->lock);
+        w->latencies.clear();
+        w->windowStart = now;
+    }
+}
+
+// doctest unit tests for GraphQueryService
+TEST_CASE("testing GraphQueryService") {
+    // random weighted graph
+    const size_t n = 200;
+    std::mt19937_64 prng(time(0));
+    std::uniform_int_distribution<size_t> vDist(1, n);
+    std::uniform_int_distribution<int> wDist(1, 20);
+    Graph g(n);
+    for(size_t i = 0; i < 5 * n; i++) {
+        g.addEdge(vDist(prng), vDist(prng), wDist(prng));
+    }
+
+    GraphQueryService service(g, 4);
+    CHECK(n == service.getSnapshot().numVertices());
+    CHECK(g.numEdges() == service.getSnapshot().numEdges());
+
+    // submit a batch of each kind of query, then check them all against the
+    // single-threaded Graph methods
+    std::vector<size_t> sources, targets;
+    std::vector<std::future<ShortestPaths>> bfs, dijkstra;
+    std::vector<std::future<Route>> routes;
+    for(size_t i = 0; i < 20; i++) {
+        sources.push_back(vDist(prng));
+        targets.push_back(vDist(prng));
+        bfs.push_back(service.BFS(sources[i]));
+        dijkstra.push_back(service.Dijkstra(sources[i]));
+        routes.push_back(service.path(sources[i], targets[i]));
+    }
+
+    double pDist[n + 1];
+    size_t pPred[n + 1];
+    for(size_t i = 0; i < 20; i++) {
+        ShortestPaths b = bfs[i].get();
+        g.BFS(sources[i], pDist, pPred);
+        for(size_t v = 1; v <= n; v++) {
+            CHECK(pDist[v] == b.dist[v]);
+        }
+
+        ShortestPaths d = dijkstra[i].get();
+        g.Dijkstra(sources[i], pDist, pPred);
+        for(size_t v = 1; v <= n; v++) {
+            CHECK(pDist[v] == d.dist[v]);
+        }
+
+        // the route's cost is the Dijkstra distance, and its edges add up
+        Route r = routes[i].get();
+        CHECK(pDist[targets[i]] == r.cost);
+        if(!std::isinf(r.cost)) {
+            CHECK(sources[i] == r.vertices.front());
+            CHECK(targets[i] == r.vertices.back());
+            const CSRGraph &c = service.getSnapshot();
+            double sum = 0;
+            for(size_t k = 1; k < r.vertices.size(); k++) {
+                // cheapest of any parallel edges between the two vertices
+                double w = std::numeric_limits<double>::infinity();
+                size_t u = r.vertices[k - 1];
+                for(size_t e = c.outBegin(u); e < c.outEnd(u); e++) {
+                    if(c.outTarget(e) == r.vertices[k]) {
+                        w = std::min(w, c.outWeight(e));
+                    }
+                }
+                sum += w;
+            }
+            CHECK(sum == r.cost);
+        } else {
+            CHECK(r.vertices.empty());
+        }
+    }
+
+    QueryStats stats = service.stats();
+    CHECK(60 == stats.queries);
+    CHECK(stats.queriesPerSecond > 0);
+    CHECK(stats.p50 <= stats.p99);
+
+    service.resetStats();
+    CHECK(0 == service.stats().queries);
+
+    // queries submitted before a reset are not counted, even the ones
+    // that finish after it
+    for(size_t i = 0; i < 20; i++) {
+        bfs[i] = service.BFS(sources[i]);
+    }
+    service.resetStats();
+    for(size_t i = 0; i < 20; i++) {
+        bfs[i].get();
+    }
+    CHECK(0 == service.stats().queries);
+    service.BFS(1).get();
+    CHECK(1 == service.stats().queries);
+
+    // check exception handling
+    bool flag = true;
+    try {
+        service.BFS(0);
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+    flag = true;
+    try {
+        service.path(1, n + 1);
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+}
@@ -0,0 +1,77 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <vector>
+#include "KShortestPaths.hpp"
+
+/**
+ * @brief Application entry point.
+ * 
+ * Builds a random weighted graph and times finding k alternative routes
+ * between random pairs of vertices, once with a single thread and once
+ * with a full pool.
+ * 
+ * @param argc Number of command-line arguments
+ * 
+ * @param ppszArgs Array of command-line argument strings
+ */
+int main(int argc, char **ppszArgs) {
+    // command-line argument sanity check
+    if(argc < 5) {
+        fprintf(stderr, "Usage: ./KShortestDemo numVertices avgOutDegree k numQueries [numThreads]\n");
+        return EXIT_FAILURE;
+    }
+    size_t n = strtoul(ppszArgs[1], nullptr, 10);
+    size_t degree = strtoul(ppszArgs[2], nullptr, 10);
+    size_t k = strtoul(ppszArgs[3], nullptr, 10);
+    size_t numQueries = strtoul(ppszArgs[4], nullptr, 10);
+    size_t numThreads = argc > 5 ? strtoul(ppszArgs[5], nullptr, 10) : 0;
+    if(n == 0) {
+        fprintf(stderr, "numVertices must be at least 1\n");
+        return EXIT_FAILURE;
+    }
+
+    // random graph with weights in [1, 100]
+    std::mt19937_64 prng(time(0));
+    std::uniform_int_distribution<size_t> vDist(1, n);
+    std::uniform_int_distribution<int> wDist(1, 100);
+    Graph g(n);
+    for(size_t i = 0; i < n * degree; i++) {
+        g.addEdge(vDist(prng), vDist(prng), wDist(prng));
+    }
+    CSRGraph c(g);
+    printf("Graph has %zu vertices and %zu edges\n", n, c.numEdges());
+
+    std::vector<size_t> sources, targets;
+    for(size_t q = 0; q < numQueries; q++) {
+        sources.push_back(vDist(prng));
+        targets.push_back(vDist(prng));
+    }
+
+    printf("%8s,%14s,%14s,%14s\n", "threads", "routes", "sec/query", 
+        "worst/best");
+    size_t pThreads[] = {1, numThreads};
+    for(size_t run = 0; run < 2; run++) {
+        KShortestPaths yen(c, pThreads[run]);
+        size_t routes = 0;
+        double ratio = 0;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for(size_t q = 0; q < numQueries; q++) {
+            std::vector<Route> r = yen.find(sources[q], targets[q], k);
+            routes += r.size();
+            if(r.size() > 1 && r.front().cost > 0) {
+                ratio = std::max(ratio, r.back().cost / r.front().cost);
+            }
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = t2 - t1;
+
+        printf("%8zu, %13zu, %0.5E, %0.5E\n", 
+            pThreads[run], routes, 
+            elapsed.count() / numQueries, ratio);
+    }
+
+    return EXIT_SUCCESS;
+}
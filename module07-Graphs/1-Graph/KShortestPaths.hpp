@@ -0,0 +1,391 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <doctest.h>
+#include <future>
+#include <limits>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include "CSRGraph.hpp"
+#include "GraphQueryService.hpp"
+#include "SearchWorkspace.hpp"
+#include "ThreadPool.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Yen's algorithm for the k cheapest loopless paths between two
+ * vertices.
+ *
+ * The cheapest path comes from a single Dijkstra search. Each following
+ * path is found by taking the path before it and, for every vertex on it
+ * (the "spur" vertex), searching for the cheapest way from the spur vertex
+ * to the target that keeps the part of the path before the spur vertex
+ * (the "root") but does not reuse any root vertex or leave the spur vertex
+ * along an edge an earlier path with the same root already took. The
+ * cheapest of all candidates found so far becomes the next path.
+ *
+ * The searches exclude vertices and edges with SearchWorkspace bans rather
+ * than by editing a copy of the graph, and stop as soon as the target is
+ * settled. The spur searches for one path are independent, so they run in
+ * parallel on a ThreadPool, each worker using its own workspace.
+ *
+ * Paths are sequences of edges, so two paths that differ only in which of
+ * two parallel edges they use count as different paths.
+ *
+ * One KShortestPaths object must not run two find() calls at once; use one
+ * object per client thread. Any number of objects may share a CSRGraph.
+ */
+class KShortestPaths {
+public:
+    /**
+     * @brief Construct a new KShortestPaths object.
+     *
+     * @param g Graph to search; must outlive this object. Edge weights must
+     * not be negative.
+     * @param numThreads Number of worker threads for the spur searches; 0
+     * means one per hardware thread.
+     */
+    KShortestPaths(const CSRGraph &g, size_t numThreads = 0);
+
+    /**
+     * @brief Find the k cheapest loopless paths from s to t.
+     *
+     * @param s Vertex the paths start at.
+     * @param t Vertex the paths end at.
+     * @param k Maximum number of paths to find.
+     * @return std::vector<Route> holding up to k paths in order of
+     * increasing cost; fewer if the graph does not have k loopless paths
+     * from s to t.
+     *
+     * @throws std::out_of_range if s or t is < 1 or > |V|.
+     */
+    std::vector<Route> find(size_t s, size_t t, size_t k);
+
+    /**
+     * @brief Get the graph being searched.
+     */
+    const CSRGraph &getGraph() const { return graph; }
+
+private:
+    /**
+     * @brief A path as both its vertices and the indices of its edges.
+     */
+    class Path {
+    public:
+        /**
+         * @brief Construct a new, empty Path.
+         */
+        Path() : cost(std::numeric_limits<double>::infinity()) { }
+
+        /**
+         * @brief Vertices on the path, source first.
+         */
+        std::vector<size_t> vertices;
+
+        /**
+         * @brief Edge indices into graph; edges[i] joins vertices[i] and
+         * vertices[i + 1].
+         */
+        std::vector<size_t> edges;
+
+        /**
+         * @brief Total edge weight of the path.
+         */
+        double cost;
+    };
+
+    /**
+     * @brief Find the cheapest candidate path that follows the last path in
+     * found up to its vertex j, then branches off.
+     *
+     * @return Path that is empty if there is no such candidate costing at
+     * most bound.
+     */
+    Path spur(SearchWorkspace &ws, const std::vector<Path> &found, size_t j,
+        size_t t, double bound) const;
+
+    /**
+     * @brief Graph being searched.
+     */
+    const CSRGraph &graph;
+
+    /**
+     * @brief One search workspace per pool thread.
+     */
+    std::vector<std::unique_ptr<SearchWorkspace>> workspaces;
+
+    /**
+     * @brief Pool running the spur searches; declared last so its threads
+     * stop before the workspaces are destroyed.
+     */
+    ThreadPool pool;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * constructor implementation.
+ */
+KShortestPaths::KShortestPaths(const CSRGraph &g, size_t numThreads) :
+    graph(g), pool(numThreads) {
+
+    for(size_t i = 0; i < pool.numThreads(); i++) {
+        workspaces.push_back(std::unique_ptr<SearchWorkspace>(
+            new SearchWorkspace()));
+    }
+}
+
+/*
+ * spur method implementation.
+ */
+KShortestPaths::Path KShortestPaths::spur(SearchWorkspace &ws,
+    const std::vector<Path> &found, size_t j, size_t t, double bound) const {
+
+    const Path &last = found.back();
+    ws.clearBans();
+
+    // every path found so far that shares this root has already left the
+    // spur vertex along its next edge
+    for(const Path &p : found) {
+        if(p.edges.size() > j &&
+            std::equal(last.edges.begin(), last.edges.begin() + j,
+                p.edges.begin())) {
+            ws.banEdge(p.edges[j]);
+        }
+    }
+
+    // a loopless path cannot revisit the root
+    for(size_t i = 0; i < j; i++) {
+        ws.banVertex(last.vertices[i]);
+    }
+
+    // a spur path is only worth finding if root plus spur fits the bound
+    double rootCost = 0;
+    for(size_t i = 0; i < j; i++) {
+        rootCost += graph.outWeight(last.edges[i]);
+    }
+    Path result;
+    ws.Dijkstra(graph, last.vertices[j], t, bound - rootCost);
+    if(std::isinf(ws.dist(t)) || rootCost + ws.dist(t) > bound) {
+        return result;
+    }
+
+    // root, then the spur path traced back from t
+    result.vertices.assign(last.vertices.begin(), last.vertices.begin() + j);
+    result.edges.assign(last.edges.begin(), last.edges.begin() + j);
+    std::vector<size_t> tail = ws.path(t);
+    for(size_t i = 0; i < tail.size(); i++) {
+        result.vertices.push_back(tail[i]);
+        if(i > 0) {
+            result.edges.push_back(ws.predEdge(tail[i]));
+        }
+    }
+    result.cost = rootCost + ws.dist(t);
+    return result;
+}
+
+/*
+ * find method implementation.
+ */
+std::vector<Route> KShortestPaths::find(size_t s, size_t t, size_t k) {
+    if(s == 0u || s > graph.numVertices() || t == 0u ||
+        t > graph.numVertices()) {
+        throw std::out_of_range("Illegal vertex in KShortestPaths::find()");
+    }
+
+    std::vector<Path> found;
+    std::vector<Route> result;
+    if(k == 0) {
+        return result;
+    }
+
+    // the cheapest path of all, with no bans
+    SearchWorkspace &ws = *workspaces[0];
+    ws.clearBans();
+    ws.Dijkstra(graph, s, t);
+    if(std::isinf(ws.dist(t))) {
+        return result;
+    }
+    Path first;
+    first.vertices = ws.path(t);
+    for(size_t i = 1; i < first.vertices.size(); i++) {
+        first.edges.push_back(ws.predEdge(first.vertices[i]));
+    }
+    first.cost = ws.dist(t);
+    found.push_back(first);
+
+    // candidates, and the edge sequences of every path seen, so the same
+    // candidate is not queued twice
+    std::vector<Path> candidates;
+    std::set<std::vector<size_t>> seen;
+    seen.insert(first.edges);
+
+    while(found.size() < k) {
+        // once there are enough candidates to fill the remaining places, a
+        // new one has to beat the most expensive of them
+        double bound = std::numeric_limits<double>::infinity();
+        if(candidates.size() == k - found.size()) {
+            bound = candidates.back().cost;
+        }
+
+        // one spur search per vertex of the last path but its target
+        std::vector<std::future<Path>> spurs;
+        size_t numSpurs = found.back().edges.size();
+        for(size_t j = 0; j < numSpurs; j++) {
+            spurs.push_back(pool.submit([this, &found, j, t, bound](
+                size_t worker) {
+                return spur(*workspaces[worker], found, j, t, bound);
+            }));
+        }
+        for(std::future<Path> &f : spurs) {
+            Path p = f.get();
+            if(!p.vertices.empty() && seen.insert(p.edges).second) {
+                candidates.push_back(p);
+            }
+        }
+        if(candidates.empty()) {
+            break;
+        }
+
+        // only the k - |found| cheapest candidates can ever be chosen, so
+        // drop the rest; the cheapest becomes the next path
+        std::stable_sort(candidates.begin(), candidates.end(),
+            [](const Path &a, const Path &b) { return a.cost < b.cost; });
+        found.push_back(candidates.front());
+        candidates.erase(candidates.begin());
+        if(candidates.size() > k - found.size()) {
+            candidates.resize(k - found.size());
+        }
+    }
+
+    for(const Path &p : found) {
+        Route r;
+        r.vertices = p.vertices;
+        r.cost = p.cost;
+        result.push_back(r);
+    }
+    return result;
+}
+
+/**
+ * @brief Add the costs of every loopless path from u to t, continuing a path
+ * of cost c, to costs. Used to check find() by brute force.
+ */
+static void allPathCosts(const CSRGraph &g, size_t u, size_t t, double c,
+    std::vector<bool> &onPath, std::vector<double> &costs) {
+
+    if(u == t) {
+        costs.push_back(c);
+        return;
+    }
+    onPath[u] = true;
+    for(size_t e = g.outBegin(u); e < g.outEnd(u); e++) {
+        size_t v = g.outTarget(e);
+        if(!onPath[v]) {
+            allPathCosts(g, v, t, c + g.outWeight(e), onPath, costs);
+        }
+    }
+    onPath[u] = false;
+}
+
+// doctest unit tests for KShortestPaths
+TEST_CASE("testing KShortestPaths") {
+    // the classic example: C D E F G H are vertices 1 to 6
+    Graph g(6);
+    g.addEdge(1, 2, 3);
+    g.addEdge(1, 3, 2);
+    g.addEdge(2, 4, 4);
+    g.addEdge(3, 2, 1);
+    g.addEdge(3, 4, 2);
+    g.addEdge(3, 5, 3);
+    g.addEdge(4, 5, 2);
+    g.addEdge(4, 6, 1);
+    g.addEdge(5, 6, 2);
+    CSRGraph c(g);
+    KShortestPaths yen(c, 2);
+
+    std::vector<Route> routes = yen.find(1, 6, 3);
+    REQUIRE(3 == routes.size());
+    size_t pFirst[] = {1, 3, 4, 6};
+    size_t pSecond[] = {1, 3, 5, 6};
+    REQUIRE(4 == routes[0].vertices.size());
+    REQUIRE(4 == routes[1].vertices.size());
+    for(size_t i = 0; i < 4; i++) {
+        CHECK(pFirst[i] == routes[0].vertices[i]);
+        CHECK(pSecond[i] == routes[1].vertices[i]);
+    }
+    CHECK(5 == routes[0].cost);
+    CHECK(7 == routes[1].cost);
+    CHECK(8 == routes[2].cost);
+
+    // there are only seven loopless paths from C to H
+    routes = yen.find(1, 6, 100);
+    CHECK(7 == routes.size());
+    CHECK(0 == yen.find(1, 6, 0).size());
+    CHECK(0 == yen.find(6, 1, 5).size());
+
+    // a vertex has one path to itself
+    routes = yen.find(3, 3, 5);
+    REQUIRE(1 == routes.size());
+    CHECK(0 == routes[0].cost);
+    CHECK(1 == routes[0].vertices.size());
+
+    // random graphs with parallel edges, checked against every loopless path
+    std::mt19937_64 prng(time(0));
+    std::uniform_int_distribution<size_t> vDist(1, 8);
+    std::uniform_int_distribution<int> wDist(1, 10);
+    for(int trial = 0; trial < 20; trial++) {
+        Graph r(8);
+        for(size_t i = 0; i < 24; i++) {
+            r.addEdge(vDist(prng), vDist(prng), wDist(prng));
+        }
+        CSRGraph rc(r);
+        KShortestPaths ryen(rc, 3);
+        size_t s = vDist(prng), t = vDist(prng);
+
+        std::vector<bool> onPath(9, false);
+        std::vector<double> costs;
+        allPathCosts(rc, s, t, 0, onPath, costs);
+        std::sort(costs.begin(), costs.end());
+
+        routes = ryen.find(s, t, 10);
+        REQUIRE(std::min<size_t>(10, costs.size()) == routes.size());
+        for(size_t i = 0; i < routes.size(); i++) {
+            CHECK(costs[i] == routes[i].cost);
+            CHECK(s == routes[i].vertices.front());
+            CHECK(t == routes[i].vertices.back());
+
+            // loopless: no vertex appears twice
+            std::vector<size_t> sorted = routes[i].vertices;
+            std::sort(sorted.begin(), sorted.end());
+            CHECK(std::adjacent_find(sorted.begin(), sorted.end()) ==
+                sorted.end());
+        }
+    }
+
+    // check exception handling
+    bool flag = true;
+    try {
+        yen.find(0, 6, 3);
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+    flag = true;
+    try {
+        yen.find(1, 7, 3);
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+}
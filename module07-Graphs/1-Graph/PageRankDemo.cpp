@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include "PageRank.hpp"
+
+/**
+ * @brief Application entry point.
+ * 
+ * Builds a random directed graph, ranks it with pageRank(), and reports the
+ * time taken by each iteration along with the edge throughput.
+ * 
+ * @param argc Number of command-line arguments
+ * 
+ * @param ppszArgs Array of command-line argument strings
+ */
+int main(int argc, char **ppszArgs) {
+    // command-line argument sanity check
+    if(argc < 3) {
+        fprintf(stderr, "Usage: ./PageRankDemo numVertices avgOutDegree [numThreads]\n");
+        return EXIT_FAILURE;
+    }
+    size_t n = strtoul(ppszArgs[1], nullptr, 10);
+    size_t degree = strtoul(ppszArgs[2], nullptr, 10);
+    size_t numThreads = argc > 3 ? strtoul(ppszArgs[3], nullptr, 10) : 0;
+    if(n == 0) {
+        fprintf(stderr, "numVertices must be at least 1\n");
+        return EXIT_FAILURE;
+    }
+
+    // random link graph; roughly e^-degree of the vertices end up dangling
+    std::mt19937_64 prng(time(0));
+    std::uniform_int_distribution<size_t> vDist(1, n);
+    std::poisson_distribution<size_t> dDist(degree);
+    Graph g(n);
+    for(size_t u = 1; u <= n; u++) {
+        size_t k = dDist(prng);
+        for(size_t i = 0; i < k; i++) {
+            g.addEdge(u, vDist(prng), 1);
+        }
+    }
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    CSRGraph c(g);
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("Graph has %zu vertices and %zu edges\n", c.numVertices(), 
+        c.numEdges());
+    printf("CSR snapshot built in %0.5E s\n\n", 
+        std::chrono::duration<double>(end - begin).count());
+
+    double *pRank = new double[n + 1];
+    PageRankStats stats;
+    pageRank(c, pRank, 0.85, 1e-9, 100, numThreads, &stats);
+
+    printf("%6s,%14s,%14s\n", "iter", "seconds", "edges/s");
+    for(size_t i = 0; i < stats.iterations; i++) {
+        double s = stats.iterationSeconds[i];
+        printf("%6zu, %0.5E, %0.5E\n", i + 1, s, 
+            s > 0 ? c.numEdges() / s : 0.0);
+    }
+    printf("\n%s after %zu iterations, residual %0.5E, %0.5E edges/s\n",
+        stats.converged ? "Converged" : "Stopped", stats.iterations, 
+        stats.residual, stats.edgesPerSecond());
+
+    // report the highest-ranked vertex
+    size_t best = 1;
+    for(size_t v = 2; v <= n; v++) {
+        if(pRank[v] > pRank[best]) {
+            best = v;
+        }
+    }
+    printf("Highest rank: vertex %zu, %0.5E\n", best, pRank[best]);
+
+    delete [] pRank;
+
+    return EXIT_SUCCESS;
+}
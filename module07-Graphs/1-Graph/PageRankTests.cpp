@@ -0,0 +1,4 @@
+// phantom C++ file for PageRank unit testing. This file only inlcudes the 
+// PageRank header; doctest generates the testing program based on unit 
+// tests written alongside the code in the header files
+#include "PageRank.hpp"
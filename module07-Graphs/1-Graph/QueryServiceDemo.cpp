@@ -0,0 +1,82 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <thread>
+#include <vector>
+#include "GraphQueryService.hpp"
+
+/**
+ * @brief Application entry point.
+ * 
+ * Builds a random weighted graph, then has several client threads submit
+ * path queries to a GraphQueryService and reports throughput and latency.
+ * 
+ * @param argc Number of command-line arguments
+ * 
+ * @param ppszArgs Array of command-line argument strings
+ */
+int main(int argc, char **ppszArgs) {
+    // command-line argument sanity check
+    if(argc < 4) {
+        fprintf(stderr, "Usage: ./QueryServiceDemo numVertices avgOutDegree numQueries [numThreads]\n");
+        return EXIT_FAILURE;
+    }
+    size_t n = strtoul(ppszArgs[1], nullptr, 10);
+    size_t degree = strtoul(ppszArgs[2], nullptr, 10);
+    size_t numQueries = strtoul(ppszArgs[3], nullptr, 10);
+    size_t numThreads = argc > 4 ? strtoul(ppszArgs[4], nullptr, 10) : 0;
+    if(n == 0) {
+        fprintf(stderr, "numVertices must be at least 1\n");
+        return EXIT_FAILURE;
+    }
+
+    // random graph with weights in [1, 100]
+    std::mt19937_64 prng(time(0));
+    std::uniform_int_distribution<size_t> vDist(1, n);
+    std::uniform_int_distribution<int> wDist(1, 100);
+    Graph g(n);
+    for(size_t i = 0; i < n * degree; i++) {
+        g.addEdge(vDist(prng), vDist(prng), wDist(prng));
+    }
+
+    GraphQueryService service(g, numThreads);
+    printf("Graph has %zu vertices and %zu edges\n", n, g.numEdges());
+
+    // four client threads each submit a share of the queries
+    const size_t numClients = 4;
+    std::vector<std::thread> clients;
+    std::vector<size_t> reachable(numClients, 0);
+    for(size_t c = 0; c < numClients; c++) {
+        clients.push_back(std::thread([&, c]() {
+            std::mt19937_64 local(time(0) + c);
+            std::uniform_int_distribution<size_t> localDist(1, n);
+            std::vector<std::future<Route>> results;
+            for(size_t q = c; q < numQueries; q += numClients) {
+                results.push_back(service.path(localDist(local),
+                    localDist(local)));
+            }
+            for(std::future<Route> &r : results) {
+                if(!r.get().vertices.empty()) {
+                    reachable[c]++;
+                }
+            }
+        }));
+    }
+    for(std::thread &t : clients) {
+        t.join();
+    }
+
+    size_t found = 0;
+    for(size_t r : reachable) {
+        found += r;
+    }
+
+    QueryStats stats = service.stats();
+    printf("%zu path queries, %zu with a path\n", stats.queries, found);
+    printf("%14s,%14s,%14s\n", "queries/s", "p50 (s)", "p99 (s)");
+    printf("%0.5E, %0.5E, %0.5E\n", stats.queriesPerSecond, stats.p50, 
+        stats.p99);
+
+    return EXIT_SUCCESS;
+}
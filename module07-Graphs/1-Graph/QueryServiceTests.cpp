@@ -0,0 +1,4 @@
+// phantom C++ file for GraphQueryService unit testing. This file only 
+// inlcudes the GraphQueryService header; doctest generates the testing 
+// program based on unit tests written alongside the code in the header files
+#include "GraphQueryService.hpp"
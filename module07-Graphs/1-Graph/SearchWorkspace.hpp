@@ -0,0 +1,497 @@
+#pragma once
+
+#include <algorithm>
+#include <doctest.h>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "CSRGraph.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Reusable scratch memory for BFS and Dijkstra searches over a
+ * CSRGraph.
+ *
+ * Graph::BFS() and Graph::Dijkstra() fill caller-provided arrays, which must
+ * be reset in O(|V|) time before every search. A SearchWorkspace instead
+ * stamps each vertex with the number of the search that last touched it;
+ * a vertex with an old stamp reads as "not reached yet", so starting a new
+ * search costs O(1) and a search that stops early only pays for the
+ * vertices it actually visited.
+ *
+ * Vertices and edges can be banned from the following searches, which then
+ * treat them as if they were not in the graph. Bans are stamped the same
+ * way, so lifting them all costs O(1); Yen's k-shortest-paths algorithm uses
+ * this to search many slightly different graphs without copying any.
+ *
+ * A workspace is not safe to share between threads; give each thread its
+ * own. The CSRGraph it searches can be shared freely.
+ */
+class SearchWorkspace {
+public:
+    /**
+     * @brief Construct a new, empty SearchWorkspace. It grows to fit the
+     * first graph it searches.
+     */
+    SearchWorkspace() : search(0), source(0), banned(1) { }
+
+    /**
+     * @brief Perform breadth-first search from vertex s.
+     *
+     * Afterwards dist(v) is the number of edges on the fewest-edge path
+     * from s to v, and pred(v) is the vertex before v on that path. Banned
+     * vertices and edges are skipped.
+     *
+     * @param g Graph to search.
+     * @param s Vertex to search from.
+     *
+     * @throws std::out_of_range if s is < 1 or > |V|.
+     */
+    void BFS(const CSRGraph &g, size_t s);
+
+    /**
+     * @brief Perform Dijkstra's algorithm from vertex s.
+     *
+     * Afterwards dist(v) is the weight of the cheapest path from s to v,
+     * and pred(v) is the vertex before v on that path. Banned vertices and
+     * edges are skipped. If t is not 0, the search stops as soon as t's
+     * distance is final. Whatever t is, the search also gives up once every
+     * remaining vertex is further away than limit. Either way, other
+     * vertices may be left with distances that are too high.
+     *
+     * @param g Graph to search. Edge weights must not be negative.
+     * @param s Vertex to search from.
+     * @param t Vertex to stop at, or 0 to search the whole graph.
+     * @param limit Largest distance worth settling, with or without t.
+     *
+     * @throws std::out_of_range if s or t is > |V|, or s is 0.
+     */
+    void Dijkstra(const CSRGraph &g, size_t s, size_t t = 0,
+        double limit = std::numeric_limits<double>::infinity());
+
+    /**
+     * @brief Distance to v found by the last search, infinity if v was not
+     * reached.
+     */
+    double dist(size_t v) const {
+        return stamp[v] == search ? d[v] : std::numeric_limits<double>::infinity();
+    }
+
+    /**
+     * @brief Predecessor of v found by the last search, 0 if there is none.
+     */
+    size_t pred(size_t v) const { return stamp[v] == search ? p[v] : 0u; }
+
+    /**
+     * @brief Index, in the searched CSRGraph, of the edge from pred(v) to v;
+     * only meaningful if pred(v) is not 0.
+     */
+    size_t predEdge(size_t v) const { return pe[v]; }
+
+    /**
+     * @brief Vertices on the path from the last search's source to t.
+     *
+     * @return std::vector<size_t> holding s, ..., t; empty if t was not
+     * reached.
+     */
+    std::vector<size_t> path(size_t t) const;
+
+    /**
+     * @brief Leave vertex v out of searches until clearBans() is called.
+     * Banning the source of a search has no effect.
+     */
+    void banVertex(size_t v);
+
+    /**
+     * @brief Leave edge e, an index into the searched CSRGraph's out-edges,
+     * out of searches until clearBans() is called.
+     */
+    void banEdge(size_t e);
+
+    /**
+     * @brief Lift every vertex and edge ban.
+     */
+    void clearBans();
+
+private:
+    /**
+     * @brief Start a new search of a graph with n vertices.
+     */
+    void reset(size_t n);
+
+    /**
+     * @brief Record a tentative distance and predecessor for v.
+     */
+    void set(size_t v, double dv, size_t pv, size_t pev) {
+        stamp[v] = search;
+        d[v] = dv;
+        p[v] = pv;
+        pe[v] = pev;
+    }
+
+    /**
+     * @brief Grow the ban stamps to cover n vertices and m edges.
+     */
+    void fitBans(size_t n, size_t m);
+
+    /**
+     * @brief Search number; vertices stamped with it belong to the current
+     * search.
+     */
+    unsigned search;
+
+    /**
+     * @brief Source vertex of the last search.
+     */
+    size_t source;
+
+    /**
+     * @brief Per-vertex search stamps.
+     */
+    std::vector<unsigned> stamp;
+
+    /**
+     * @brief Per-vertex distances, valid where stamped.
+     */
+    std::vector<double> d;
+
+    /**
+     * @brief Per-vertex predecessors, valid where stamped.
+     */
+    std::vector<size_t> p;
+
+    /**
+     * @brief Per-vertex predecessor edges, valid where stamped.
+     */
+    std::vector<size_t> pe;
+
+    /**
+     * @brief Ban number; vertices and edges stamped with it are banned.
+     */
+    unsigned banned;
+
+    /**
+     * @brief Per-vertex and per-edge ban stamps.
+     */
+    std::vector<unsigned> vertexBan;
+    std::vector<unsigned> edgeBan;
+
+    /**
+     * @brief BFS queue storage.
+     */
+    std::vector<size_t> queue;
+
+    /**
+     * @brief Dijkstra binary heap storage of (distance, vertex) pairs.
+     */
+    std::vector<std::pair<double, size_t>> heap;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * reset method implementation.
+ */
+void SearchWorkspace::reset(size_t n) {
+    if(stamp.size() < n + 1) {
+        stamp.resize(n + 1, 0u);
+        d.resize(n + 1);
+        p.resize(n + 1);
+        pe.resize(n + 1);
+    }
+
+    // on wrap-around, old stamps could be mistaken for new ones
+    if(++search == 0u) {
+        std::fill(stamp.begin(), stamp.end(), 0u);
+        search = 1u;
+    }
+}
+
+/*
+ * fitBans method implementation.
+ */
+void SearchWorkspace::fitBans(size_t n, size_t m) {
+    if(vertexBan.size() < n + 1) {
+        vertexBan.resize(n + 1, 0u);
+    }
+    if(edgeBan.size() < m) {
+        edgeBan.resize(m, 0u);
+    }
+}
+
+/*
+ * banVertex method implementation.
+ */
+void SearchWorkspace::banVertex(size_t v) {
+    fitBans(v, 0);
+    vertexBan[v] = banned;
+}
+
+/*
+ * banEdge method implementation.
+ */
+void SearchWorkspace::banEdge(size_t e) {
+    fitBans(0, e + 1);
+    edgeBan[e] = banned;
+}
+
+/*
+ * clearBans method implementation.
+ */
+void SearchWorkspace::clearBans() {
+    if(++banned == 0u) {
+        std::fill(vertexBan.begin(), vertexBan.end(), 0u);
+        std::fill(edgeBan.begin(), edgeBan.end(), 0u);
+        banned = 1u;
+    }
+}
+
+/*
+ * BFS method implementation.
+ */
+void SearchWorkspace::BFS(const CSRGraph &g, size_t s) {
+    if(s == 0u || s > g.numVertices()) {
+        throw std::out_of_range("Illegal vertex in SearchWorkspace::BFS()");
+    }
+    reset(g.numVertices());
+    fitBans(g.numVertices(), g.numEdges());
+    source = s;
+
+    queue.clear();
+    queue.push_back(s);
+    set(s, 0, 0u, 0u);
+
+    // queue doubles as the FIFO; head is the next vertex to dequeue
+    for(size_t head = 0; head < queue.size(); head++) {
+        size_t u = queue[head];
+        for(size_t e = g.outBegin(u); e < g.outEnd(u); e++) {
+            size_t v = g.outTarget(e);
+            if(stamp[v] != search && edgeBan[e] != banned &&
+                vertexBan[v] != banned) {
+                set(v, d[u] + 1, u, e);
+                queue.push_back(v);
+            }
+        }
+    }
+}
+
+/*
+ * Dijkstra method implementation.
+ */
+void SearchWorkspace::Dijkstra(const CSRGraph &g, size_t s, size_t t,
+    double limit) {
+
+    if(s == 0u || s > g.numVertices() || t > g.numVertices()) {
+        throw std::out_of_range("Illegal vertex in SearchWorkspace::Dijkstra()");
+    }
+    reset(g.numVertices());
+    fitBans(g.numVertices(), g.numEdges());
+    source = s;
+
+    typedef std::pair<double, size_t> Entry;
+    std::greater<Entry> later;
+    heap.clear();
+    heap.push_back(Entry(0, s));
+    set(s, 0, 0u, 0u);
+
+    while(!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        Entry top = heap.back();
+        heap.pop_back();
+        size_t u = top.second;
+        if(top.first > d[u]) {
+            continue; // stale heap entry
+        }
+        if(u == t || top.first > limit) {
+            break;
+        }
+
+        for(size_t e = g.outBegin(u); e < g.outEnd(u); e++) {
+            size_t v = g.outTarget(e);
+            if(edgeBan[e] == banned || vertexBan[v] == banned) {
+                continue;
+            }
+            double nd = top.first + g.outWeight(e);
+            if(stamp[v] != search || nd < d[v]) {
+                set(v, nd, u, e);
+                heap.push_back(Entry(nd, v));
+                std::push_heap(heap.begin(), heap.end(), later);
+            }
+        }
+    }
+}
+
+/*
+ * path method implementation.
+ */
+std::vector<size_t> SearchWorkspace::path(size_t t) const {
+    std::vector<size_t> result;
+    if(t >= stamp.size() || stamp[t] != search) {
+        return result;
+    }
+    for(size_t v = t; v != source; v = p[v]) {
+        result.push_back(v);
+    }
+    result.push_back(source);
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+// doctest unit tests for SearchWorkspace::BFS
+TEST_CASE("testing SearchWorkspace::BFS()") {
+    Graph g(8);
+    size_t pEdges[][2] = {{1, 2}, {1, 5}, {2, 1}, {2, 6}, {3, 4}, {3, 6},
+        {3, 7}, {4, 7}, {4, 8}, {5, 1}, {6, 2}, {6, 3}, {6, 7}, {7, 6},
+        {7, 3}, {7, 4}, {7, 8}, {8, 7}, {8, 4}};
+    for(size_t i = 0; i < 19; i++) {
+        g.addEdge(pEdges[i][0], pEdges[i][1], 1);
+    }
+    CSRGraph c(g);
+
+    // same answers as Graph::BFS, search after search
+    SearchWorkspace ws;
+    double pDist[9];
+    size_t pPred[9];
+    for(size_t s = 1; s <= 8; s++) {
+        g.BFS(s, pDist, pPred);
+        ws.BFS(c, s);
+        for(size_t v = 1; v <= 8; v++) {
+            CHECK(pDist[v] == ws.dist(v));
+        }
+    }
+
+    ws.BFS(c, 2);
+    std::vector<size_t> path = ws.path(8);
+    size_t pExpected[] = {2, 6, 7, 8};
+    REQUIRE(4 == path.size());
+    for(size_t i = 0; i < 4; i++) {
+        CHECK(pExpected[i] == path[i]);
+    }
+    CHECK(0u == ws.pred(2));
+
+    // check exception handling
+    bool flag = true;
+    try {
+        ws.BFS(c, 0);
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+    flag = true;
+    try {
+        ws.BFS(c, 9);
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+}
+
+// doctest unit tests for SearchWorkspace::Dijkstra
+TEST_CASE("testing SearchWorkspace::Dijkstra()") {
+    Graph g(6);
+    g.addEdge(1, 2, 10);
+    g.addEdge(1, 4, 5);
+    g.addEdge(2, 3, 1);
+    g.addEdge(2, 4, 2);
+    g.addEdge(3, 5, 4);
+    g.addEdge(4, 2, 3);
+    g.addEdge(4, 3, 9);
+    g.addEdge(4, 5, 1);
+    g.addEdge(5, 1, 7);
+    g.addEdge(5, 3, 6);
+    CSRGraph c(g);
+
+    SearchWorkspace ws;
+    double pDist[7];
+    size_t pPred[7];
+    for(size_t s = 1; s <= 6; s++) {
+        g.Dijkstra(s, pDist, pPred);
+        ws.Dijkstra(c, s);
+        for(size_t v = 1; v <= 6; v++) {
+            CHECK(pDist[v] == ws.dist(v));
+            if(v != s && !std::isinf(pDist[v])) {
+                CHECK(pPred[v] == ws.pred(v));
+            }
+        }
+    }
+
+    // vertex 6 is unreachable
+    ws.Dijkstra(c, 1);
+    CHECK(std::isinf(ws.dist(6)));
+    CHECK(ws.path(6).empty());
+
+    // stopping early still gives the right answer for the target
+    ws.Dijkstra(c, 1, 3);
+    CHECK(9 == ws.dist(3));
+    std::vector<size_t> path = ws.path(3);
+    size_t pExpected[] = {1, 4, 2, 3};
+    REQUIRE(4 == path.size());
+    for(size_t i = 0; i < 4; i++) {
+        CHECK(pExpected[i] == path[i]);
+    }
+
+    // check exception handling
+    bool flag = true;
+    try {
+        ws.Dijkstra(c, 0);
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+    flag = true;
+    try {
+        ws.Dijkstra(c, 1, 7);
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+}
+
+// doctest unit tests for SearchWorkspace bans
+TEST_CASE("testing SearchWorkspace::banVertex() and banEdge()") {
+    Graph g(4);
+    g.addEdge(1, 2, 1);
+    g.addEdge(1, 2, 5);
+    g.addEdge(2, 4, 1);
+    g.addEdge(1, 3, 4);
+    g.addEdge(3, 4, 4);
+    CSRGraph c(g);
+
+    SearchWorkspace ws;
+    ws.Dijkstra(c, 1);
+    CHECK(2 == ws.dist(4));
+    CHECK(c.outWeight(ws.predEdge(2)) == 1);
+
+    // banning the cheap parallel edge leaves the expensive one
+    ws.banEdge(c.outBegin(1));
+    ws.Dijkstra(c, 1);
+    CHECK(6 == ws.dist(4));
+    CHECK(c.outWeight(ws.predEdge(2)) == 5);
+
+    // bans accumulate until cleared
+    ws.banVertex(2);
+    ws.Dijkstra(c, 1);
+    CHECK(8 == ws.dist(4));
+    CHECK(std::isinf(ws.dist(2)));
+    ws.BFS(c, 1);
+    CHECK(std::isinf(ws.dist(2)));
+    CHECK(2 == ws.dist(4));
+
+    ws.clearBans();
+    ws.Dijkstra(c, 1);
+    CHECK(2 == ws.dist(4));
+
+    // the search gives up past the limit
+    ws.banVertex(2);
+    ws.Dijkstra(c, 1, 4, 5);
+    CHECK(8 == ws.dist(4));
+    ws.Dijkstra(c, 1, 4, 3);
+    CHECK(std::isinf(ws.dist(4)));
+}
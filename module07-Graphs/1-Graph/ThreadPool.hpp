@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <doctest.h>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Fixed-size pool of worker threads with work stealing.
+ *
+ * Every worker owns a double-ended queue of tasks. A worker takes tasks from
+ * the back of its own queue, newest first, which keeps recently touched data
+ * in its cache. A worker whose queue is empty steals the oldest task from
+ * the front of another worker's queue instead, so the load evens out without
+ * a single shared queue that every thread fights over.
+ *
+ * Tasks are callables taking the index, in [0, numThreads()), of the worker
+ * that runs them. Tasks can use that index to pick a per-thread scratch area
+ * without any locking. Tasks submitted by a worker go onto that worker's own
+ * queue; tasks submitted from other threads are dealt out round-robin.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Construct a new ThreadPool and start its workers.
+     *
+     * @param numThreads Number of worker threads; 0 means one per hardware
+     * thread.
+     */
+    ThreadPool(size_t numThreads = 0);
+
+    /**
+     * @brief Destroy the ThreadPool object, after every submitted task has
+     * run.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Get the number of worker threads.
+     */
+    size_t numThreads() const { return workers.size(); }
+
+    /**
+     * @brief Queue a task to run on one of the workers.
+     *
+     * @param task Callable taking a size_t worker index.
+     * @return std::future holding the task's return value, or any exception
+     * it throws.
+     */
+    template <class F>
+    std::future<typename std::result_of<F(size_t)>::type> submit(F task);
+
+    /**
+     * @brief Wait for a future and return its value.
+     *
+     * A task that submits subtasks and then blocks on their futures ties up
+     * its worker; if every worker does that, nothing is left to run the
+     * subtasks. Called on a worker thread, this method instead runs queued
+     * tasks, newest first, until the result is ready. Called on any other
+     * thread it simply blocks.
+     *
+     * @param result Future returned by submit().
+     * @return The task's return value; any exception it threw is rethrown.
+     */
+    template <class R>
+    R wait(std::future<R> &result);
+
+private:
+    /**
+     * @brief Type-erased task stored in the queues.
+     */
+    typedef std::function<void(size_t)> Task;
+
+    /**
+     * @brief One worker's task queue and the lock protecting it.
+     */
+    class WorkQueue {
+    public:
+        /**
+         * @brief Queued tasks; the owner uses the back, thieves the front.
+         */
+        std::deque<Task> tasks;
+
+        /**
+         * @brief Lock protecting tasks.
+         */
+        std::mutex lock;
+    };
+
+    /**
+     * @brief Put a task on worker id's queue and wake a sleeping worker.
+     */
+    void push(size_t id, Task task);
+
+    /**
+     * @brief Take a task from worker id's own queue, or steal one.
+     *
+     * @return true if task was filled in.
+     */
+    bool take(size_t id, Task &task);
+
+    /**
+     * @brief Worker thread main loop.
+     */
+    void run(size_t id);
+
+    /**
+     * @brief Index of the worker running on this thread, or numThreads()
+     * if this thread is not one of this pool's workers.
+     */
+    size_t currentWorker() const;
+
+    /**
+     * @brief One queue per worker.
+     */
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+
+    /**
+     * @brief The worker threads.
+     */
+    std::vector<std::thread> workers;
+
+    /**
+     * @brief Number of queued tasks not yet taken by a worker.
+     */
+    std::atomic<size_t> pending;
+
+    /**
+     * @brief Round-robin counter for tasks submitted from outside the pool.
+     */
+    std::atomic<size_t> nextQueue;
+
+    /**
+     * @brief Lock and condition used to put idle workers to sleep.
+     */
+    std::mutex sleepLock;
+    std::condition_variable wake;
+
+    /**
+     * @brief Set by the destructor to stop the workers once queues drain.
+     */
+    bool stopping;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/**
+ * @brief Pool and worker index of the calling thread, if it is a worker.
+ */
+static thread_local const ThreadPool *pCurrentPool = nullptr;
+static thread_local size_t currentWorkerId = 0;
+
+/*
+ * constructor implementation.
+ */
+ThreadPool::ThreadPool(size_t numThreads) : pending(0), nextQueue(0),
+    stopping(false) {
+
+    if(numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for(size_t i = 0; i < numThreads; i++) {
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    for(size_t i = 0; i < numThreads; i++) {
+        workers.push_back(std::thread(&ThreadPool::run, this, i));
+    }
+}
+
+/*
+ * destructor implementation.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(std::thread &w : workers) {
+        w.join();
+    }
+}
+
+/*
+ * currentWorker method implementation.
+ */
+size_t ThreadPool::currentWorker() const {
+    return pCurrentPool == this ? currentWorkerId : workers.size();
+}
+
+/*
+ * submit method implementation.
+ */
+template <class F>
+std::future<typename std::result_of<F(size_t)>::type> ThreadPool::submit(
+    F task) {
+
+    typedef typename std::result_of<F(size_t)>::type R;
+
+    // packaged_task cannot be copied, but std::function needs a copyable
+    // target, so share it instead
+    std::shared_ptr<std::packaged_task<R(size_t)>> pTask(
+        new std::packaged_task<R(size_t)>(task));
+    std::future<R> result = pTask->get_future();
+
+    size_t id = currentWorker();
+    if(id == workers.size()) {
+        id = nextQueue++ % workers.size();
+    }
+    push(id, [pTask](size_t worker) { (*pTask)(worker); });
+
+    return result;
+}
+
+/*
+ * wait method implementation.
+ */
+template <class R>
+R ThreadPool::wait(std::future<R> &result) {
+    size_t id = currentWorker();
+    if(id != workers.size()) {
+        Task task;
+        while(result.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+
+            if(take(id, task)) {
+                task(id);
+                task = nullptr;
+            } else {
+                // the result is being computed by another worker
+                std::this_thread::yield();
+            }
+        }
+    }
+    return result.get();
+}
+
+/*
+ * push method implementation.
+ */
+void ThreadPool::push(size_t id, Task task) {
+    {
+        std::lock_guard<std::mutex> guard(queues[id]->lock);
+        queues[id]->tasks.push_back(std::move(task));
+    }
+    {
+        // taking sleepLock orders this increment with a worker's check of
+        // pending, so the notification cannot be missed
+        std::lock_guard<std::mutex> guard(sleepLock);
+        pending++;
+    }
+    wake.notify_one();
+}
+
+/*
+ * take method implementation.
+ */
+bool ThreadPool::take(size_t id, Task &task) {
+    // newest task from our own queue
+    {
+        std::lock_guard<std::mutex> guard(queues[id]->lock);
+        if(!queues[id]->tasks.empty()) {
+            task = std::move(queues[id]->tasks.back());
+            queues[id]->tasks.pop_back();
+            pending--;
+            return true;
+        }
+    }
+
+    // otherwise the oldest task from someone else's queue
+    for(size_t i = 1; i < queues.size(); i++) {
+        WorkQueue &q = *queues[(id + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if(!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            pending--;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * run method implementation.
+ */
+void ThreadPool::run(size_t id) {
+    pCurrentPool = this;
+    currentWorkerId = id;
+
+    Task task;
+    while(true) {
+        if(take(id, task)) {
+            task(id);
+            task = nullptr;
+            continue;
+        }
+
+        // nothing to do: sleep until a task arrives or the pool shuts down
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this]() { return pending > 0 || stopping; });
+        if(stopping && pending == 0) {
+            return;
+        }
+    }
+}
+
+// doctest unit tests for ThreadPool
+TEST_CASE("testing ThreadPool") {
+    ThreadPool pool(4);
+    CHECK(4 == pool.numThreads());
+
+    // results come back through the futures, and every task learns a valid
+    // worker index
+    std::vector<std::future<size_t>> results;
+    std::atomic<size_t> badIds(0);
+    for(size_t i = 0; i < 1000; i++) {
+        results.push_back(pool.submit([i, &badIds](size_t worker) {
+            if(worker >= 4) {
+                badIds++;
+            }
+            return i * i;
+        }));
+    }
+    for(size_t i = 0; i < 1000; i++) {
+        CHECK(i * i == results[i].get());
+    }
+    CHECK(0 == badIds);
+
+    // tasks can submit more tasks
+    std::future<std::future<int>> outer = pool.submit([&pool](size_t) {
+        return pool.submit([](size_t) { return 42; });
+    });
+    CHECK(42 == outer.get().get());
+
+    // exceptions travel through the future
+    std::future<void> failing = pool.submit([](size_t) {
+        throw std::out_of_range("test");
+    });
+    bool flag = false;
+    try {
+        failing.get();
+    } catch(std::out_of_range oor) {
+        flag = true;
+    }
+    CHECK(flag);
+
+    // recursive tasks that wait for their own subtasks do not deadlock, even
+    // with far more waiting tasks than workers
+    std::function<long(size_t)> fib = [&pool, &fib](size_t k) -> long {
+        if(k < 2) {
+            return k;
+        }
+        std::future<long> left = pool.submit([&fib, k](size_t) {
+            return fib(k - 1);
+        });
+        long right = fib(k - 2);
+        return pool.wait(left) + right;
+    };
+    std::future<long> fib20 = pool.submit([&fib](size_t) { return fib(20); });
+    CHECK(6765 == pool.wait(fib20));
+
+    // the destructor runs every queued task before returning
+    std::atomic<int> count(0);
+    {
+        ThreadPool small(2);
+        for(int i = 0; i < 500; i++) {
+            small.submit([&count](size_t) { count++; });
+        }
+    }
+    CHECK(500 == count);
+}
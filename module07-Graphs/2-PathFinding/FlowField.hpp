@@ -0,0 +1,557 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <doctest.h>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "GridMap.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Direction field leading every cell of a GridMap to one goal cell.
+ *
+ * When many agents head for the same goal, searching from each agent's
+ * start wastes work. Instead, this class runs a single reverse Dijkstra
+ * search from the goal, giving the cost of moving from every cell to the
+ * goal, and then stores for every cell the direction of the neighbor to
+ * step onto next. An agent finds its next move with one array lookup.
+ *
+ * Directions are stored as characters: 'N', 'S', 'E' or 'W' for a step,
+ * '*' at the goal, and '.' for cells that cannot reach the goal.
+ *
+ * The direction pass is split over several threads, since each cell's
+ * direction depends only on the costs of its neighbors. The reverse
+ * Dijkstra search itself is serial: it settles cells one at a time in
+ * order of cost, so it does not split into independent pieces.
+ *
+ * Changing a tile with setTile() repairs only the cells whose cost to the
+ * goal changes: cheaper tiles push improvements outward from the changed
+ * cell, while dearer or blocked tiles reset the cells whose paths ran
+ * through it and re-settle them from their unaffected neighbors.
+ */
+class FlowField {
+public:
+    /**
+     * @brief Construct a new FlowField and compute it.
+     *
+     * @param map Terrain to search; the object keeps its own copy.
+     * @param goalRow Row of the goal cell.
+     * @param goalCol Column of the goal cell.
+     * @param numThreads Number of threads to use for the direction pass; 0
+     * means one per hardware thread.
+     *
+     * @throws std::out_of_range if the goal is outside the map.
+     */
+    FlowField(const GridMap &map, size_t goalRow, size_t goalCol,
+        size_t numThreads = 0);
+
+    /**
+     * @brief Recompute the whole field from scratch.
+     */
+    void recompute();
+
+    /**
+     * @brief Change the tile character at a (row, col) coordinate and
+     * update the field to match.
+     *
+     * @return size_t number of cells whose cost to the goal changed; cells
+     * that are reset by a dearer tile but settle again at their old cost
+     * are not counted.
+     *
+     * @throws std::out_of_range if r or c is outside the map.
+     */
+    size_t setTile(size_t r, size_t c, char tile);
+
+    /**
+     * @brief Direction to move from a cell: 'N', 'S', 'E', 'W', '*' at the
+     * goal, or '.' if the goal cannot be reached.
+     *
+     * @param cell Cell number. Not range checked.
+     */
+    char direction(size_t cell) const { return dir[cell]; }
+
+    /**
+     * @brief Cell to move onto from a cell.
+     *
+     * @param cell Cell number. Not range checked.
+     * @return size_t neighboring cell number, or GridMap::NO_CELL at the
+     * goal or if the goal cannot be reached.
+     */
+    size_t nextCell(size_t cell) const;
+
+    /**
+     * @brief Cost of moving from a cell to the goal.
+     *
+     * @param cell Cell number. Not range checked.
+     * @return double path cost, infinity if the goal cannot be reached.
+     */
+    double cost(size_t cell) const { return dist[cell]; }
+
+    /**
+     * @brief Get the goal cell number.
+     */
+    size_t getGoal() const { return goal; }
+
+    /**
+     * @brief Get the terrain map this field was computed for.
+     */
+    const GridMap &getMap() const { return map; }
+
+    /**
+     * @brief Stream insertion override; prints the direction field one map
+     * row per line.
+     */
+    friend std::ostream &operator<<(std::ostream &out, const FlowField &f) {
+        for(size_t r = 0; r < f.map.numRows(); r++) {
+            for(size_t c = 0; c < f.map.numCols(); c++) {
+                out << f.dir[f.map.cell(r, c)];
+            }
+            out << std::endl;
+        }
+        return out;
+    }
+
+private:
+    /**
+     * @brief Priority queue entry: (cost to goal, cell number).
+     */
+    typedef std::pair<double, size_t> Entry;
+
+    /**
+     * @brief Min-priority queue of Entry objects.
+     */
+    typedef std::priority_queue<Entry, std::vector<Entry>,
+        std::greater<Entry>> MinQueue;
+
+    /**
+     * @brief Fill pN with the in-map neighbors of a cell, in N, S, E, W
+     * order, and return how many there are.
+     */
+    size_t neighbors(size_t cell, size_t *pN) const;
+
+    /**
+     * @brief Choose the direction of one cell from its neighbors' costs.
+     */
+    void pickDirection(size_t cell);
+
+    /**
+     * @brief Choose directions for every cell in cells, split over the
+     * worker threads.
+     */
+    void pickDirections(const std::vector<size_t> &cells);
+
+    /**
+     * @brief Continue a reverse Dijkstra search from the entries in Q,
+     * recording every cell whose cost is lowered in changed.
+     */
+    void propagate(MinQueue &Q, std::vector<size_t> &changed);
+
+    /**
+     * @brief Terrain being searched.
+     */
+    GridMap map;
+
+    /**
+     * @brief Goal cell number.
+     */
+    size_t goal;
+
+    /**
+     * @brief Number of threads used for the direction pass.
+     */
+    size_t numThreads;
+
+    /**
+     * @brief Cost of moving from each cell to the goal.
+     */
+    std::vector<double> dist;
+
+    /**
+     * @brief Direction character for each cell.
+     */
+    std::vector<char> dir;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * constructor implementation.
+ */
+FlowField::FlowField(const GridMap &m, size_t goalRow, size_t goalCol,
+    size_t threads) : map(m), goal(0), numThreads(threads) {
+
+    if(goalRow >= map.numRows() || goalCol >= map.numCols()) {
+        throw std::out_of_range("Illegal goal in FlowField::FlowField()");
+    }
+    goal = map.cell(goalRow, goalCol);
+    if(numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    recompute();
+}
+
+/*
+ * neighbors method implementation.
+ */
+size_t FlowField::neighbors(size_t cell, size_t *pN) const {
+    size_t r = map.row(cell), c = map.col(cell);
+    size_t k = 0;
+    pN[0] = pN[1] = pN[2] = pN[3] = GridMap::NO_CELL;
+    if(r > 0) pN[0] = cell - map.numCols();
+    if(r + 1 < map.numRows()) pN[1] = cell + map.numCols();
+    if(c + 1 < map.numCols()) pN[2] = cell + 1;
+    if(c > 0) pN[3] = cell - 1;
+    for(size_t i = 0; i < 4; i++) {
+        if(pN[i] != GridMap::NO_CELL) {
+            k++;
+        }
+    }
+    return k;
+}
+
+/*
+ * pickDirection method implementation.
+ */
+void FlowField::pickDirection(size_t cell) {
+    if(cell == goal) {
+        dir[cell] = '*';
+        return;
+    }
+
+    const char pNames[4] = {'N', 'S', 'E', 'W'};
+    size_t pN[4];
+    neighbors(cell, pN);
+
+    // step onto the neighbor that gives the cheapest remaining cost; ties
+    // go to the first direction in N, S, E, W order
+    char best = '.';
+    double bestCost = std::numeric_limits<double>::infinity();
+    for(size_t i = 0; i < 4; i++) {
+        if(pN[i] != GridMap::NO_CELL && map.passable(pN[i])) {
+            double c = dist[pN[i]] + map.weight(pN[i]);
+            if(c < bestCost) {
+                bestCost = c;
+                best = pNames[i];
+            }
+        }
+    }
+    dir[cell] = best;
+}
+
+/*
+ * pickDirections method implementation.
+ */
+void FlowField::pickDirections(const std::vector<size_t> &cells) {
+    size_t n = cells.size();
+    size_t t = std::min(numThreads, std::max((size_t)1, n / 4096));
+    size_t blockSize = (n + t - 1) / t;
+
+    auto body = [&](size_t lo, size_t hi) {
+        for(size_t i = lo; i < hi; i++) {
+            pickDirection(cells[i]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for(size_t i = 1; i < t; i++) {
+        size_t lo = i * blockSize, hi = std::min(n, lo + blockSize);
+        if(lo < hi) {
+            workers.push_back(std::thread(body, lo, hi));
+        }
+    }
+    body(0, std::min(n, blockSize));
+    for(std::thread &w : workers) {
+        w.join();
+    }
+}
+
+/*
+ * recompute method implementation.
+ */
+void FlowField::recompute() {
+    gridDijkstra(map, 0, 0, map.numRows(), map.numCols(), goal, true, dist);
+    dir.assign(map.numCells(), '.');
+
+    std::vector<size_t> all(map.numCells());
+    for(size_t i = 0; i < all.size(); i++) {
+        all[i] = i;
+    }
+    pickDirections(all);
+}
+
+/*
+ * nextCell method implementation.
+ */
+size_t FlowField::nextCell(size_t cell) const {
+    switch(dir[cell]) {
+        case 'N': return cell - map.numCols();
+        case 'S': return cell + map.numCols();
+        case 'E': return cell + 1;
+        case 'W': return cell - 1;
+    }
+    return GridMap::NO_CELL;
+}
+
+/*
+ * propagate method implementation.
+ */
+void FlowField::propagate(MinQueue &Q, std::vector<size_t> &changed) {
+    size_t pN[4];
+    while(!Q.empty()) {
+        Entry top = Q.top();
+        Q.pop();
+        size_t v = top.second;
+        if(top.first > dist[v]) {
+            continue; // stale queue entry
+        }
+
+        // neighbors reach v by stepping onto it
+        if(!map.passable(v)) {
+            continue;
+        }
+        neighbors(v, pN);
+        for(size_t i = 0; i < 4; i++) {
+            size_t u = pN[i];
+            if(u != GridMap::NO_CELL && top.first + map.weight(v) < dist[u]) {
+                dist[u] = top.first + map.weight(v);
+                changed.push_back(u);
+                Q.push(Entry(dist[u], u));
+            }
+        }
+    }
+}
+
+/*
+ * setTile method implementation.
+ */
+size_t FlowField::setTile(size_t r, size_t c, char tile) {
+    double oldW = GridMap::charToWeight(map.getTile(r, c));
+    map.setTile(r, c, tile);
+    size_t x = map.cell(r, c);
+    double newW = map.weight(x);
+
+    // treat blocked tiles as infinitely expensive
+    const double INF = std::numeric_limits<double>::infinity();
+    if(oldW <= 0) oldW = INF;
+    if(newW <= 0) newW = INF;
+
+    std::vector<size_t> changed;
+    size_t numChanged = 0;
+    MinQueue Q;
+    size_t pN[4];
+
+    if(newW < oldW) {
+        // cheaper: only paths through x can improve, so push x back onto
+        // the queue and let the improvement spread from it; every cell it
+        // reaches gets strictly cheaper
+        if(dist[x] < INF) {
+            Q.push(Entry(dist[x], x));
+            propagate(Q, changed);
+        }
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()),
+            changed.end());
+        numChanged = changed.size();
+    } else if(newW > oldW) {
+        // dearer: collect every cell whose path runs through x, i.e., the
+        // subtree of the direction field hanging off x
+        std::vector<char> affected(map.numCells(), 0);
+        std::vector<size_t> stack;
+        stack.push_back(x);
+        while(!stack.empty()) {
+            size_t y = stack.back();
+            stack.pop_back();
+            neighbors(y, pN);
+            for(size_t i = 0; i < 4; i++) {
+                size_t u = pN[i];
+                if(u != GridMap::NO_CELL && !affected[u] && nextCell(u) == y) {
+                    affected[u] = 1;
+                    changed.push_back(u);
+                    stack.push_back(u);
+                }
+            }
+        }
+
+        // reset the affected cells, remembering their old costs, then
+        // seed each from its unaffected neighbors, whose costs are still
+        // correct
+        size_t numAffected = changed.size();
+        std::vector<double> oldDist(numAffected);
+        for(size_t i = 0; i < numAffected; i++) {
+            oldDist[i] = dist[changed[i]];
+            dist[changed[i]] = INF;
+        }
+        for(size_t u : changed) {
+            neighbors(u, pN);
+            for(size_t i = 0; i < 4; i++) {
+                size_t v = pN[i];
+                if(v != GridMap::NO_CELL && !affected[v] && map.passable(v) &&
+                    dist[v] + map.weight(v) < dist[u]) {
+                    dist[u] = dist[v] + map.weight(v);
+                }
+            }
+            if(dist[u] < INF) {
+                Q.push(Entry(dist[u], u));
+            }
+        }
+        propagate(Q, changed);
+
+        // propagate() only reaches affected cells, which all need new
+        // directions, but some settle again at their old cost
+        for(size_t i = 0; i < numAffected; i++) {
+            if(dist[changed[i]] != oldDist[i]) {
+                numChanged++;
+            }
+        }
+        changed.resize(numAffected);
+    }
+
+    // choose new directions for every cell whose cost may have changed
+    pickDirections(changed);
+
+    return numChanged;
+}
+
+// doctest unit tests for FlowField
+TEST_CASE("testing FlowField") {
+    std::istringstream iss("4 5\nbcswc\nxxscc\ncwsxc\ncwsce\n");
+    GridMap m(iss);
+    FlowField f(m, 3, 4, 2);
+    CHECK(m.cell(3, 4) == f.getGoal());
+
+    // costs match a reverse Dijkstra search towards the goal
+    std::vector<double> rdist;
+    gridDijkstra(m, 0, 0, 4, 5, f.getGoal(), true, rdist);
+    for(size_t i = 0; i < m.numCells(); i++) {
+        CHECK(rdist[i] == f.cost(i));
+    }
+
+    // following the directions from any cell reaches the goal at the
+    // promised cost
+    for(size_t s = 0; s < m.numCells(); s++) {
+        double sum = 0;
+        size_t p = s;
+        while(p != f.getGoal()) {
+            p = f.nextCell(p);
+            REQUIRE(p != GridMap::NO_CELL);
+            sum += m.weight(p);
+        }
+        CHECK(sum == doctest::Approx(f.cost(s)));
+    }
+
+    CHECK('*' == f.direction(f.getGoal()));
+    CHECK('S' == f.direction(m.cell(2, 4)));
+    CHECK('E' == f.direction(m.cell(3, 3)));
+
+    std::ostringstream oss;
+    oss << f;
+    CHECK(oss.str() == "EESSS\nSEEES\nSESSS\nEEEE*\n");
+
+    // walling off the goal leaves only the goal itself reachable
+    f.setTile(2, 4, 'x');
+    f.setTile(3, 3, 'x');
+    for(size_t i = 0; i < m.numCells(); i++) {
+        if(i != f.getGoal() && i != m.cell(2, 4) && i != m.cell(3, 3)) {
+            CHECK('.' == f.direction(i));
+            CHECK(std::isinf(f.cost(i)));
+        }
+    }
+    f.setTile(3, 3, 'c');
+    CHECK(1 == f.cost(m.cell(3, 3)));
+    CHECK('E' == f.direction(m.cell(3, 2)));
+
+    // check exception handling
+    bool flag = true;
+    try {
+        FlowField bad(m, 4, 0);
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+    flag = true;
+    try {
+        f.setTile(0, 5, 'c');
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+}
+
+// doctest unit tests for incremental FlowField updates
+TEST_CASE("testing FlowField::setTile()") {
+    const size_t R = 30, C = 41;
+    const char pTiles[] = "cccsswx";
+    std::mt19937_64 prng(time(0));
+    std::uniform_int_distribution<size_t> tileDist(0, 6);
+    GridMap m(R, C);
+    for(size_t r = 0; r < R; r++) {
+        for(size_t c = 0; c < C; c++) {
+            m.setTile(r, c, pTiles[tileDist(prng)]);
+        }
+    }
+    m.setTile(R / 2, C / 2, 'e');
+
+    FlowField f(m, R / 2, C / 2, 4);
+    FlowField single(m, R / 2, C / 2, 1);
+    for(size_t i = 0; i < m.numCells(); i++) {
+        CHECK(f.direction(i) == single.direction(i));
+    }
+
+    // after every change, the repaired field must match a field computed
+    // from scratch on the same terrain
+    std::uniform_int_distribution<size_t> rDist(0, R - 1), cDist(0, C - 1);
+    for(int change = 0; change < 60; change++) {
+        size_t r = rDist(prng), c = cDist(prng);
+        f.setTile(r, c, pTiles[tileDist(prng)]);
+
+        FlowField fresh(f.getMap(), R / 2, C / 2, 1);
+        for(size_t i = 0; i < m.numCells(); i++) {
+            if(std::isinf(fresh.cost(i))) {
+                CHECK(std::isinf(f.cost(i)));
+            } else {
+                CHECK(f.cost(i) == doctest::Approx(fresh.cost(i)));
+            }
+
+            // every direction steps onto a neighbor that realizes the cost
+            size_t p = f.nextCell(i);
+            if(p != GridMap::NO_CELL) {
+                CHECK(f.cost(i) == doctest::Approx(f.cost(p) +
+                    f.getMap().weight(p)));
+            } else {
+                CHECK((i == f.getGoal() || std::isinf(f.cost(i))));
+            }
+        }
+    }
+
+    // a change that cannot alter any cost touches no cells
+    size_t far = m.cell(0, 0);
+    char tile = f.getMap().getTile(0, 0);
+    CHECK(0 == f.setTile(m.row(far), m.col(far), tile));
+
+    // on open concrete every cell has another path of the same cost around
+    // a dearer tile, so cells reset through it settle again unchanged
+    GridMap open(5, 5);
+    FlowField g(open, 4, 4, 2);
+    CHECK('S' == g.direction(open.cell(2, 3)));
+    CHECK(0 == g.setTile(3, 3, 's'));
+    CHECK(3 == g.cost(open.cell(2, 3)));
+    CHECK(8 == g.cost(open.cell(0, 0)));
+
+    // blocking the last tile on the only path does change costs
+    GridMap lane(1, 5);
+    FlowField h(lane, 0, 4, 1);
+    CHECK(3 == h.setTile(0, 3, 'x'));
+}
@@ -0,0 +1,115 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "FlowField.hpp"
+
+/**
+ * @brief Seconds elapsed between two time points.
+ */
+double seconds(std::chrono::high_resolution_clock::time_point begin,
+    std::chrono::high_resolution_clock::time_point end) {
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+/**
+ * @brief Application entry point.
+ * 
+ * With no arguments, prints the flow field towards the exit of map.txt.
+ * Given a tile factor and an agent count, tiles map.txt into a large map and
+ * compares moving every agent to the exit with the flow field against
+ * running a separate Dijkstra search per agent.
+ * 
+ * @param argc Number of command-line arguments
+ * 
+ * @param ppszArgs Array of command-line argument strings
+ */
+int main(int argc, char **ppszArgs) {
+    std::ifstream inFile("map.txt");
+    GridMap small(inFile);
+    inFile.close();
+
+    if(argc == 1) {
+        FlowField f(small, small.numRows() - 1, small.numCols() - 1);
+        std::cout << f;
+        return EXIT_SUCCESS;
+    }
+    if(argc != 3) {
+        fprintf(stderr, "Usage: ./FlowFieldDemo [tileFactor numAgents]\n");
+        return EXIT_FAILURE;
+    }
+    size_t factor = strtoul(ppszArgs[1], nullptr, 10);
+    size_t numAgents = strtoul(ppszArgs[2], nullptr, 10);
+    if(factor == 0 || numAgents == 0) {
+        fprintf(stderr, "tileFactor and numAgents must be at least 1\n");
+        return EXIT_FAILURE;
+    }
+
+    // repeat the small map factor times in each direction
+    size_t R = small.numRows() * factor, C = small.numCols() * factor;
+    GridMap m(R, C);
+    for(size_t r = 0; r < R; r++) {
+        for(size_t c = 0; c < C; c++) {
+            m.setTile(r, c, small.getTile(r % small.numRows(), 
+                c % small.numCols()));
+        }
+    }
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    FlowField f(m, R - 1, C - 1);
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("Map is %zu x %zu; flow field built in %0.5E s\n", R, C, 
+        seconds(begin, end));
+
+    // agents start on random passable cells that can reach the exit
+    std::mt19937_64 prng(time(0));
+    std::uniform_int_distribution<size_t> cellDist(0, R * C - 1);
+    std::vector<size_t> agents(numAgents);
+    for(size_t &a : agents) {
+        do {
+            a = cellDist(prng);
+        } while(!m.passable(a) || std::isinf(f.cost(a)));
+    }
+
+    // walk every agent to the exit, one lookup per step
+    size_t steps = 0;
+    begin = std::chrono::high_resolution_clock::now();
+    for(size_t a : agents) {
+        while(a != f.getGoal()) {
+            a = f.nextCell(a);
+            steps++;
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    printf("%zu agents took %zu steps in %0.5E s\n", numAgents, steps, 
+        seconds(begin, end));
+
+    // per-agent searches, timed on a sample and scaled up
+    size_t sample = std::min(numAgents, (size_t)10);
+    std::vector<double> dist;
+    begin = std::chrono::high_resolution_clock::now();
+    for(size_t i = 0; i < sample; i++) {
+        gridDijkstra(m, 0, 0, R, C, agents[i], false, dist);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    printf("One Dijkstra search per agent would take about %0.5E s\n",
+        seconds(begin, end) / sample * numAgents);
+
+    // a terrain change near the exit repairs only the affected cells
+    begin = std::chrono::high_resolution_clock::now();
+    size_t changed = f.setTile(R - 2, C - 1, 'w');
+    end = std::chrono::high_resolution_clock::now();
+    printf("Terrain change updated %zu of %zu cells in %0.5E s\n", changed,
+        R * C, seconds(begin, end));
+
+    begin = std::chrono::high_resolution_clock::now();
+    f.recompute();
+    end = std::chrono::high_resolution_clock::now();
+    printf("Full recomputation takes %0.5E s\n", seconds(begin, end));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,4 @@
+// phantom C++ file for FlowField unit testing. This file only inlcudes the 
+// FlowField header; doctest generates the testing program based on unit 
+// tests written alongside the code in the header files
+#include "FlowField.hpp"
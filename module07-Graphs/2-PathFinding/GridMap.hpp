@@ -0,0 +1,389 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <doctest.h>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Terrain map for the path finding examples.
+ *
+ * The map is a grid of tile characters, read from the same text format as
+ * map.txt: the number of rows and columns, followed by one line of tile
+ * characters per row. Moving onto a tile costs the weight of that tile (see
+ * charToWeight()), and agents move north, south, east or west. 'x' tiles
+ * cannot be entered.
+ *
+ * Cells are numbered row-major from 0, so cell r * numCols() + c holds the
+ * tile at row r, column c.
+ */
+class GridMap {
+public:
+    /**
+     * @brief Construct a new GridMap filled with a single tile type.
+     *
+     * @param numRows Number of rows in the map.
+     * @param numCols Number of columns in the map.
+     * @param fill Tile character for every cell. Defaults to concrete.
+     */
+    GridMap(size_t numRows, size_t numCols, char fill = 'c') :
+        numR(numRows), numC(numCols), tiles(numRows * numCols, fill) { }
+
+    /**
+     * @brief Construct a new GridMap by reading it from a stream.
+     *
+     * @param in Stream holding a map in map.txt format.
+     *
+     * @throws std::runtime_error if the stream does not hold a complete map.
+     */
+    GridMap(std::istream &in);
+
+    /**
+     * @brief Convert a map tile character to a weight.
+     *
+     * @param c Character representing a map tile.
+     * @return double Weight associated with moving to that tile, or -1 if
+     * the tile cannot be entered.
+     */
+    static double charToWeight(char c) {
+        switch(c) {
+            case 'c': return 1;
+            case 's': return 1.5;
+            case 'w': return 3;
+            case 'x': return -1; // flag - tile cannot be entered
+            case 'b': return 1;
+            case 'e': return 1;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Smallest weight of any tile that can be entered. Multiplying
+     * a step count by this gives a lower bound on the cost of a path.
+     */
+    static constexpr double MIN_WEIGHT = 1;
+
+    /**
+     * @brief Value used for "no cell", e.g., as the predecessor of a
+     * search's starting cell.
+     */
+    static const size_t NO_CELL = SIZE_MAX;
+
+    /**
+     * @brief Get the number of rows in the map.
+     */
+    size_t numRows() const { return numR; }
+
+    /**
+     * @brief Get the number of columns in the map.
+     */
+    size_t numCols() const { return numC; }
+
+    /**
+     * @brief Get the number of cells in the map.
+     */
+    size_t numCells() const { return tiles.size(); }
+
+    /**
+     * @brief Convert a (row, col) coordinate to a cell number.
+     */
+    size_t cell(size_t r, size_t c) const { return r * numC + c; }
+
+    /**
+     * @brief Row of a cell number.
+     */
+    size_t row(size_t cell) const { return cell / numC; }
+
+    /**
+     * @brief Column of a cell number.
+     */
+    size_t col(size_t cell) const { return cell % numC; }
+
+    /**
+     * @brief Get the tile character at a (row, col) coordinate.
+     *
+     * @throws std::out_of_range if r or c is outside the map.
+     */
+    char getTile(size_t r, size_t c) const;
+
+    /**
+     * @brief Change the tile character at a (row, col) coordinate.
+     *
+     * @throws std::out_of_range if r or c is outside the map.
+     */
+    void setTile(size_t r, size_t c, char tile);
+
+    /**
+     * @brief Cost of moving onto a cell; negative if it cannot be entered.
+     *
+     * @param cell Cell number. Not range checked.
+     */
+    double weight(size_t cell) const { return charToWeight(tiles[cell]); }
+
+    /**
+     * @brief Determine if a cell can be entered.
+     *
+     * @param cell Cell number. Not range checked.
+     */
+    bool passable(size_t cell) const { return weight(cell) > 0; }
+
+private:
+    /**
+     * @brief Number of rows in the map.
+     */
+    size_t numR;
+
+    /**
+     * @brief Number of columns in the map.
+     */
+    size_t numC;
+
+    /**
+     * @brief Row-major tile characters.
+     */
+    std::vector<char> tiles;
+};
+
+/**
+ * @brief Dijkstra's algorithm on a rectangular window of a GridMap.
+ *
+ * Only cells in rows [r0, r1) and columns [c0, c1) are searched. Results
+ * are indexed by window-local position (r - r0) * (c1 - c0) + (c - c0).
+ *
+ * In a forward search dist holds the cost of moving from src to each cell,
+ * and pred holds the previous cell on that path. In a reverse search dist
+ * holds the cost of moving from each cell to src, and pred holds the next
+ * cell on that path, i.e., the cell to step onto.
+ *
+ * @param map Terrain to search.
+ * @param r0 First row of the window.
+ * @param c0 First column of the window.
+ * @param r1 One past the last row of the window.
+ * @param c1 One past the last column of the window.
+ * @param src Cell number, inside the window, to search from (forward) or
+ * towards (reverse).
+ * @param reverse True for a reverse search.
+ * @param dist Resized to the window size; upon return holds path costs,
+ * infinity for unreachable cells.
+ * @param pPred If not null, resized to the window size; upon return holds
+ * global cell numbers of predecessors (forward) or successors (reverse),
+ * GridMap::NO_CELL if there is none.
+ */
+void gridDijkstra(const GridMap &map, size_t r0, size_t c0, size_t r1,
+    size_t c1, size_t src, bool reverse, std::vector<double> &dist,
+    std::vector<size_t> *pPred = nullptr);
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+constexpr double GridMap::MIN_WEIGHT;
+const size_t GridMap::NO_CELL;
+
+/*
+ * stream constructor implementation.
+ */
+GridMap::GridMap(std::istream &in) : numR(0), numC(0) {
+    if(!(in >> numR >> numC)) {
+        throw std::runtime_error("Missing map size in GridMap::GridMap()");
+    }
+    tiles.resize(numR * numC);
+
+    std::string line;
+    for(size_t r = 0; r < numR; r++) {
+        if(!(in >> line) || line.size() < numC) {
+            throw std::runtime_error("Short map row in GridMap::GridMap()");
+        }
+        for(size_t c = 0; c < numC; c++) {
+            tiles[cell(r, c)] = line[c];
+        }
+    }
+}
+
+/*
+ * getTile method implementation.
+ */
+char GridMap::getTile(size_t r, size_t c) const {
+    if(r >= numR || c >= numC) {
+        throw std::out_of_range("Illegal coordinate in GridMap::getTile()");
+    }
+    return tiles[cell(r, c)];
+}
+
+/*
+ * setTile method implementation.
+ */
+void GridMap::setTile(size_t r, size_t c, char tile) {
+    if(r >= numR || c >= numC) {
+        throw std::out_of_range("Illegal coordinate in GridMap::setTile()");
+    }
+    tiles[cell(r, c)] = tile;
+}
+
+// doctest unit tests for GridMap
+TEST_CASE("testing GridMap") {
+    std::istringstream iss("3 4\nbcsw\nxxsc\ncwse\n");
+    GridMap m(iss);
+
+    CHECK(3 == m.numRows());
+    CHECK(4 == m.numCols());
+    CHECK(12 == m.numCells());
+    CHECK(6 == m.cell(1, 2));
+    CHECK(1 == m.row(6));
+    CHECK(2 == m.col(6));
+    CHECK('w' == m.getTile(0, 3));
+    CHECK(1.5 == m.weight(m.cell(0, 2)));
+    CHECK(3 == m.weight(m.cell(2, 1)));
+    CHECK_FALSE(m.passable(m.cell(1, 0)));
+    CHECK(m.passable(m.cell(2, 3)));
+
+    m.setTile(1, 0, 'c');
+    CHECK(m.passable(m.cell(1, 0)));
+
+    GridMap f(2, 5);
+    CHECK(10 == f.numCells());
+    CHECK('c' == f.getTile(1, 4));
+
+    // check exception handling
+    bool flag = true;
+    try {
+        m.getTile(3, 0);
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+    flag = true;
+    try {
+        m.setTile(0, 4, 'c');
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+    flag = true;
+    try {
+        std::istringstream bad("3 4\nbcsw\nxx\n");
+        GridMap b(bad);
+        flag = false;
+    } catch(std::runtime_error re) {
+    }
+    CHECK(flag);
+}
+
+/*
+ * gridDijkstra implementation.
+ */
+void gridDijkstra(const GridMap &map, size_t r0, size_t c0, size_t r1,
+    size_t c1, size_t src, bool reverse, std::vector<double> &dist,
+    std::vector<size_t> *pPred) {
+
+    const double INF = std::numeric_limits<double>::infinity();
+    size_t w = c1 - c0;
+    dist.assign((r1 - r0) * w, INF);
+    if(pPred != nullptr) {
+        pPred->assign((r1 - r0) * w, GridMap::NO_CELL);
+    }
+
+    // window-local index of a global cell number
+    auto local = [&](size_t cell) {
+        return (map.row(cell) - r0) * w + (map.col(cell) - c0);
+    };
+
+    typedef std::pair<double, size_t> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> Q;
+    dist[local(src)] = 0;
+    Q.push(Entry(0, src));
+
+    while(!Q.empty()) {
+        Entry top = Q.top();
+        Q.pop();
+        size_t u = top.second;
+        if(top.first > dist[local(u)]) {
+            continue; // stale queue entry
+        }
+
+        // in a reverse search, u's neighbors reach u by stepping onto it
+        if(reverse && !map.passable(u)) {
+            continue;
+        }
+
+        size_t r = map.row(u), c = map.col(u);
+        size_t pN[4];
+        size_t k = 0;
+        if(r > r0) pN[k++] = u - map.numCols();
+        if(r + 1 < r1) pN[k++] = u + map.numCols();
+        if(c + 1 < c1) pN[k++] = u + 1;
+        if(c > c0) pN[k++] = u - 1;
+
+        for(size_t i = 0; i < k; i++) {
+            size_t v = pN[i];
+            double step = reverse ? map.weight(u) : map.weight(v);
+            if(step <= 0) {
+                continue;
+            }
+            double nd = top.first + step;
+            if(nd < dist[local(v)]) {
+                dist[local(v)] = nd;
+                if(pPred != nullptr) {
+                    (*pPred)[local(v)] = u;
+                }
+                Q.push(Entry(nd, v));
+            }
+        }
+    }
+}
+
+// doctest unit tests for gridDijkstra
+TEST_CASE("testing gridDijkstra()") {
+    std::istringstream iss("3 4\nbcsw\nxxsc\ncwse\n");
+    GridMap m(iss);
+
+    // forward from the top left corner over the whole map
+    std::vector<double> dist;
+    std::vector<size_t> pred;
+    gridDijkstra(m, 0, 0, 3, 4, 0, false, dist, &pred);
+    CHECK(0 == dist[0]);
+    CHECK(1 == dist[1]);
+    CHECK(2.5 == dist[2]);
+    CHECK(4.0 == dist[6]);
+    CHECK(5.0 == dist[7]);
+    CHECK(5.5 == dist[10]);
+    CHECK(6.0 == dist[11]);
+    CHECK(8.5 == dist[9]);
+    CHECK(9.5 == dist[8]);
+    CHECK(std::isinf(dist[4]));
+    CHECK(GridMap::NO_CELL == pred[0]);
+    CHECK(6 == pred[10]);
+
+    // reverse towards the bottom right corner gives the same cost from 0
+    std::vector<double> rdist;
+    std::vector<size_t> succ;
+    gridDijkstra(m, 0, 0, 3, 4, 11, true, rdist, &succ);
+    CHECK(dist[11] == rdist[0]);
+    CHECK(1 == succ[0]);
+    CHECK(GridMap::NO_CELL == succ[11]);
+
+    // restricting the window to the top two rows cuts off row 2
+    gridDijkstra(m, 0, 0, 2, 4, 0, false, dist);
+    CHECK(8 == dist.size());
+    CHECK(5.0 == dist[7]);
+    CHECK(std::isinf(dist[4]));
+
+    // window offset from the origin uses window-local indices
+    gridDijkstra(m, 1, 2, 3, 4, m.cell(2, 3), true, dist);
+    CHECK(4 == dist.size());
+    CHECK(0 == dist[3]);
+    CHECK(1 == dist[1]);
+    CHECK(2 == dist[0]);
+}
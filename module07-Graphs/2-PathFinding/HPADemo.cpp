@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <random>
+#include <vector>
+#include "HPAStar.hpp"
+
+/**
+ * @brief Seconds elapsed between two time points.
+ */
+double seconds(std::chrono::high_resolution_clock::time_point begin,
+    std::chrono::high_resolution_clock::time_point end) {
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+/**
+ * @brief Application entry point.
+ * 
+ * Builds a large map by tiling map.txt, then compares HPA* queries against
+ * a Dijkstra search over the whole grid for random start and goal cells.
+ * 
+ * @param argc Number of command-line arguments
+ * 
+ * @param ppszArgs Array of command-line argument strings
+ */
+int main(int argc, char **ppszArgs) {
+    // command-line argument sanity check
+    if(argc != 4) {
+        fprintf(stderr, "Usage: ./HPADemo tileFactor clusterSize numQueries\n");
+        return EXIT_FAILURE;
+    }
+    size_t factor = strtoul(ppszArgs[1], nullptr, 10);
+    size_t clusterSize = strtoul(ppszArgs[2], nullptr, 10);
+    int numQueries = atoi(ppszArgs[3]);
+
+    // read the small map, and repeat it factor times in each direction
+    std::ifstream inFile("map.txt");
+    GridMap small(inFile);
+    inFile.close();
+    size_t R = small.numRows() * factor, C = small.numCols() * factor;
+    GridMap m(R, C);
+    for(size_t r = 0; r < R; r++) {
+        for(size_t c = 0; c < C; c++) {
+            m.setTile(r, c, small.getTile(r % small.numRows(), 
+                c % small.numCols()));
+        }
+    }
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    HPAStar hpa(m, clusterSize);
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("Map is %zu x %zu; %zu clusters, %zu abstract nodes, built in %0.5E s\n",
+        R, C, hpa.numClusters(), hpa.numAbstractNodes(), seconds(begin, end));
+
+    // random queries between passable cells
+    std::mt19937_64 prng(time(0));
+    std::uniform_int_distribution<size_t> cellDist(0, R * C - 1);
+    double hpaTime = 0, fullTime = 0, ratio = 0;
+    int found = 0;
+    std::vector<size_t> path;
+    std::vector<double> dist;
+    for(int q = 0; q < numQueries; q++) {
+        size_t s, t;
+        do { s = cellDist(prng); } while(!m.passable(s));
+        do { t = cellDist(prng); } while(!m.passable(t));
+
+        begin = std::chrono::high_resolution_clock::now();
+        double cost = hpa.findPath(m.row(s), m.col(s), m.row(t), m.col(t), path);
+        end = std::chrono::high_resolution_clock::now();
+        hpaTime += seconds(begin, end);
+
+        begin = std::chrono::high_resolution_clock::now();
+        gridDijkstra(m, 0, 0, R, C, s, false, dist);
+        end = std::chrono::high_resolution_clock::now();
+        fullTime += seconds(begin, end);
+
+        if(!std::isinf(cost) && dist[t] > 0) {
+            ratio += cost / dist[t];
+            found++;
+        }
+    }
+
+    printf("%12s,%14s\n", "search", "s/query");
+    printf("%12s, %0.5E\n", "HPA*", hpaTime / numQueries);
+    printf("%12s, %0.5E\n", "Dijkstra", fullTime / numQueries);
+    if(found > 0) {
+        printf("HPA* path cost averages %0.4f x optimal\n", ratio / found);
+    }
+
+    // one terrain change only rebuilds the clusters it touches
+    size_t buildsBefore = hpa.numClusterBuilds();
+    hpa.setTile(R / 2, C / 2, 'w');
+    begin = std::chrono::high_resolution_clock::now();
+    hpa.findPath(0, 0, R - 1, C - 1, path);
+    end = std::chrono::high_resolution_clock::now();
+    printf("Terrain change rebuilt %zu cluster(s); next query took %0.5E s\n",
+        hpa.numClusterBuilds() - buildsBefore, seconds(begin, end));
+
+    return EXIT_SUCCESS;
+}
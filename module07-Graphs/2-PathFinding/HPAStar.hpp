@@ -0,0 +1,717 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <doctest.h>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "GridMap.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Hierarchical path-finding A* (HPA*) over a GridMap.
+ *
+ * The map is cut into square clusters of clusterSize x clusterSize cells.
+ * Wherever two neighboring clusters share a run of passable cells along
+ * their common border, one or two entrance cells are chosen on each side of
+ * the run. These entrance cells are the nodes of a small abstract graph:
+ *
+ * - an inter-cluster edge joins the two cells of each entrance, with the
+ *   cost of stepping across the border
+ *
+ * - intra-cluster edges join every pair of entrance cells in one cluster,
+ *   with the cost of the cheapest path that stays inside the cluster; these
+ *   costs are precomputed with a Dijkstra search per entrance cell
+ *
+ * A query first connects its start and goal cells to the entrance cells of
+ * their clusters, runs A* over the abstract graph, and finally refines each
+ * abstract edge into grid cells with a search that only looks inside one
+ * cluster. The result is not always the cheapest path, since it must pass
+ * through entrance cells, but it is usually within a few percent of it and
+ * is found far faster on large maps. A path is found whenever one exists.
+ *
+ * Changing a tile only marks the cluster holding it, plus any neighbor
+ * sharing the border it lies on, as out of date; those clusters alone are
+ * rebuilt before the next query.
+ *
+ * This is the algorithm from Botea, A., Müller, M., & Schaeffer, J. (2004).
+ * Near optimal hierarchical path-finding. Journal of Game Development, 1(1).
+ */
+class HPAStar {
+public:
+    /**
+     * @brief Construct a new HPAStar object and build its abstract graph.
+     *
+     * @param map Terrain to search; the object keeps its own copy.
+     * @param clusterSize Width and height of each cluster, in cells.
+     * Defaults to 10.
+     *
+     * @throws std::invalid_argument if clusterSize is 0.
+     */
+    HPAStar(const GridMap &map, size_t clusterSize = 10);
+
+    /**
+     * @brief Find a path between two cells.
+     *
+     * @param sr Row of the start cell.
+     * @param sc Column of the start cell.
+     * @param tr Row of the goal cell.
+     * @param tc Column of the goal cell.
+     * @param path Upon return, holds the cell numbers on the path from the
+     * start to the goal, inclusive; empty if there is no path.
+     * @return double Cost of the path (the start cell is free, every other
+     * cell costs its weight), or infinity if there is no path.
+     *
+     * @throws std::out_of_range if either coordinate is outside the map.
+     */
+    double findPath(size_t sr, size_t sc, size_t tr, size_t tc,
+        std::vector<size_t> &path);
+
+    /**
+     * @brief Change the tile character at a (row, col) coordinate.
+     *
+     * The affected clusters are rebuilt lazily, by the next findPath() call.
+     *
+     * @throws std::out_of_range if r or c is outside the map.
+     */
+    void setTile(size_t r, size_t c, char tile);
+
+    /**
+     * @brief Get the terrain map this object searches.
+     */
+    const GridMap &getMap() const { return map; }
+
+    /**
+     * @brief Get the number of clusters the map is divided into.
+     */
+    size_t numClusters() const { return clusters.size(); }
+
+    /**
+     * @brief Get the number of entrance cells in the abstract graph.
+     */
+    size_t numAbstractNodes() const;
+
+    /**
+     * @brief Get the number of times a cluster's intra-cluster edges have
+     * been built, including the initial build.
+     */
+    size_t numClusterBuilds() const { return builds; }
+
+private:
+    /**
+     * @brief Entrance cells of one cluster and the edges between them.
+     */
+    class Cluster {
+    public:
+        /**
+         * @brief Cell numbers of the entrance cells in this cluster.
+         */
+        std::vector<size_t> nodes;
+
+        /**
+         * @brief partners[i] holds the cells across the border that
+         * nodes[i] has inter-cluster edges to.
+         */
+        std::vector<std::vector<size_t>> partners;
+
+        /**
+         * @brief cost[i * nodes.size() + j] is the cost of the cheapest
+         * path from nodes[i] to nodes[j] inside the cluster.
+         */
+        std::vector<double> cost;
+    };
+
+    /**
+     * @brief Runs of passable cells shorter than this get a single entrance
+     * in the middle; longer runs get one at each end.
+     */
+    static const size_t LONG_ENTRANCE = 6;
+
+    /**
+     * @brief Cluster number holding a cell.
+     */
+    size_t clusterOf(size_t cell) const {
+        return (map.row(cell) / K) * clC + map.col(cell) / K;
+    }
+
+    /**
+     * @brief Cell window [r0, r1) x [c0, c1) covered by cluster k.
+     */
+    void bounds(size_t k, size_t &r0, size_t &c0, size_t &r1,
+        size_t &c1) const;
+
+    /**
+     * @brief Recompute the entrances on the east (or south) border of
+     * cluster k.
+     */
+    void buildBorder(size_t k, bool east);
+
+    /**
+     * @brief Recompute the entrance cells and intra-cluster edges of
+     * cluster k from the entrances on its four borders.
+     */
+    void buildCluster(size_t k);
+
+    /**
+     * @brief Rebuild every border and cluster marked out of date.
+     */
+    void rebuild();
+
+    /**
+     * @brief Append the grid cells of the cheapest in-cluster path from a
+     * to b, excluding a, to path.
+     */
+    void refine(size_t a, size_t b, std::vector<size_t> &path) const;
+
+    /**
+     * @brief Terrain being searched.
+     */
+    GridMap map;
+
+    /**
+     * @brief Cluster width and height in cells.
+     */
+    size_t K;
+
+    /**
+     * @brief Number of rows of clusters.
+     */
+    size_t clR;
+
+    /**
+     * @brief Number of columns of clusters.
+     */
+    size_t clC;
+
+    /**
+     * @brief eastT[k] holds (cell in k, cell in east neighbor) entrance
+     * pairs on the east border of cluster k.
+     */
+    std::vector<std::vector<std::pair<size_t, size_t>>> eastT;
+
+    /**
+     * @brief southT[k] holds (cell in k, cell in south neighbor) entrance
+     * pairs on the south border of cluster k.
+     */
+    std::vector<std::vector<std::pair<size_t, size_t>>> southT;
+
+    /**
+     * @brief Out-of-date flags for east borders, south borders and
+     * clusters.
+     */
+    std::vector<char> eastDirty, southDirty, clusterDirty;
+
+    /**
+     * @brief Per-cluster abstract graph data.
+     */
+    std::vector<Cluster> clusters;
+
+    /**
+     * @brief Number of cluster builds so far.
+     */
+    size_t builds;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+const size_t HPAStar::LONG_ENTRANCE;
+
+/*
+ * constructor implementation.
+ */
+HPAStar::HPAStar(const GridMap &m, size_t clusterSize) : map(m),
+    K(clusterSize), clR(0), clC(0), builds(0) {
+
+    if(K == 0) {
+        throw std::invalid_argument("Illegal cluster size in HPAStar::HPAStar()");
+    }
+    clR = (map.numRows() + K - 1) / K;
+    clC = (map.numCols() + K - 1) / K;
+
+    size_t n = clR * clC;
+    eastT.resize(n);
+    southT.resize(n);
+    eastDirty.assign(n, 1);
+    southDirty.assign(n, 1);
+    clusterDirty.assign(n, 1);
+    clusters.resize(n);
+    rebuild();
+}
+
+/*
+ * bounds method implementation.
+ */
+void HPAStar::bounds(size_t k, size_t &r0, size_t &c0, size_t &r1,
+    size_t &c1) const {
+
+    r0 = (k / clC) * K;
+    c0 = (k % clC) * K;
+    r1 = std::min(map.numRows(), r0 + K);
+    c1 = std::min(map.numCols(), c0 + K);
+}
+
+/*
+ * buildBorder method implementation.
+ */
+void HPAStar::buildBorder(size_t k, bool east) {
+    std::vector<std::pair<size_t, size_t>> &T = east ? eastT[k] : southT[k];
+    T.clear();
+
+    // no neighbor means no border
+    if((east && k % clC + 1 >= clC) || (!east && k / clC + 1 >= clR)) {
+        return;
+    }
+
+    size_t r0, c0, r1, c1;
+    bounds(k, r0, c0, r1, c1);
+
+    // walk along the border; a is the cell on our side at step i, b is the
+    // cell across the border
+    size_t len = east ? r1 - r0 : c1 - c0;
+    auto sideA = [&](size_t i) {
+        return east ? map.cell(r0 + i, c1 - 1) : map.cell(r1 - 1, c0 + i);
+    };
+    auto sideB = [&](size_t i) {
+        return east ? map.cell(r0 + i, c1) : map.cell(r1, c0 + i);
+    };
+
+    size_t i = 0;
+    while(i < len) {
+        if(!map.passable(sideA(i)) || !map.passable(sideB(i))) {
+            i++;
+            continue;
+        }
+
+        // [start, i) is a maximal run of cells passable on both sides
+        size_t start = i;
+        while(i < len && map.passable(sideA(i)) && map.passable(sideB(i))) {
+            i++;
+        }
+
+        if(i - start < LONG_ENTRANCE) {
+            size_t mid = start + (i - start) / 2;
+            T.push_back(std::make_pair(sideA(mid), sideB(mid)));
+        } else {
+            T.push_back(std::make_pair(sideA(start), sideB(start)));
+            T.push_back(std::make_pair(sideA(i - 1), sideB(i - 1)));
+        }
+    }
+}
+
+/*
+ * buildCluster method implementation.
+ */
+void HPAStar::buildCluster(size_t k) {
+    Cluster &cl = clusters[k];
+    cl.nodes.clear();
+    cl.partners.clear();
+
+    // record an entrance cell of this cluster and the cell across from it
+    auto addNode = [&](size_t cell, size_t partner) {
+        size_t i = 0;
+        while(i < cl.nodes.size() && cl.nodes[i] != cell) {
+            i++;
+        }
+        if(i == cl.nodes.size()) {
+            cl.nodes.push_back(cell);
+            cl.partners.push_back(std::vector<size_t>());
+        }
+        cl.partners[i].push_back(partner);
+    };
+
+    for(const std::pair<size_t, size_t> &p : eastT[k]) {
+        addNode(p.first, p.second);
+    }
+    for(const std::pair<size_t, size_t> &p : southT[k]) {
+        addNode(p.first, p.second);
+    }
+    if(k % clC > 0) {
+        for(const std::pair<size_t, size_t> &p : eastT[k - 1]) {
+            addNode(p.second, p.first);
+        }
+    }
+    if(k >= clC) {
+        for(const std::pair<size_t, size_t> &p : southT[k - clC]) {
+            addNode(p.second, p.first);
+        }
+    }
+
+    // one in-cluster Dijkstra search per entrance cell
+    size_t r0, c0, r1, c1;
+    bounds(k, r0, c0, r1, c1);
+    size_t m = cl.nodes.size();
+    cl.cost.assign(m * m, std::numeric_limits<double>::infinity());
+    std::vector<double> dist;
+    for(size_t i = 0; i < m; i++) {
+        gridDijkstra(map, r0, c0, r1, c1, cl.nodes[i], false, dist);
+        for(size_t j = 0; j < m; j++) {
+            size_t cell = cl.nodes[j];
+            cl.cost[i * m + j] =
+                dist[(map.row(cell) - r0) * (c1 - c0) + map.col(cell) - c0];
+        }
+    }
+
+    builds++;
+}
+
+/*
+ * rebuild method implementation.
+ */
+void HPAStar::rebuild() {
+    // borders first, since clusters collect their entrances from them
+    for(size_t k = 0; k < clusters.size(); k++) {
+        if(eastDirty[k]) {
+            buildBorder(k, true);
+            eastDirty[k] = 0;
+        }
+        if(southDirty[k]) {
+            buildBorder(k, false);
+            southDirty[k] = 0;
+        }
+    }
+    for(size_t k = 0; k < clusters.size(); k++) {
+        if(clusterDirty[k]) {
+            buildCluster(k);
+            clusterDirty[k] = 0;
+        }
+    }
+}
+
+/*
+ * setTile method implementation.
+ */
+void HPAStar::setTile(size_t r, size_t c, char tile) {
+    map.setTile(r, c, tile);
+
+    size_t k = clusterOf(map.cell(r, c));
+    size_t r0, c0, r1, c1;
+    bounds(k, r0, c0, r1, c1);
+    clusterDirty[k] = 1;
+
+    // a cell on the edge of a cluster also changes the shared border
+    if(c == c0 && c0 > 0) {
+        eastDirty[k - 1] = clusterDirty[k - 1] = 1;
+    }
+    if(c + 1 == c1 && k % clC + 1 < clC) {
+        eastDirty[k] = clusterDirty[k + 1] = 1;
+    }
+    if(r == r0 && r0 > 0) {
+        southDirty[k - clC] = clusterDirty[k - clC] = 1;
+    }
+    if(r + 1 == r1 && k / clC + 1 < clR) {
+        southDirty[k] = clusterDirty[k + clC] = 1;
+    }
+}
+
+/*
+ * numAbstractNodes method implementation.
+ */
+size_t HPAStar::numAbstractNodes() const {
+    size_t sum = 0;
+    for(const Cluster &cl : clusters) {
+        sum += cl.nodes.size();
+    }
+    return sum;
+}
+
+/*
+ * refine method implementation.
+ */
+void HPAStar::refine(size_t a, size_t b, std::vector<size_t> &path) const {
+    // cells in different clusters are joined by a single step
+    if(clusterOf(a) != clusterOf(b)) {
+        path.push_back(b);
+        return;
+    }
+
+    size_t r0, c0, r1, c1;
+    bounds(clusterOf(a), r0, c0, r1, c1);
+    std::vector<double> dist;
+    std::vector<size_t> pred;
+    gridDijkstra(map, r0, c0, r1, c1, a, false, dist, &pred);
+
+    // walk the predecessors back from b, then append them in order
+    std::vector<size_t> steps;
+    for(size_t p = b; p != a;
+        p = pred[(map.row(p) - r0) * (c1 - c0) + map.col(p) - c0]) {
+        steps.push_back(p);
+    }
+    path.insert(path.end(), steps.rbegin(), steps.rend());
+}
+
+/*
+ * findPath method implementation.
+ */
+double HPAStar::findPath(size_t sr, size_t sc, size_t tr, size_t tc,
+    std::vector<size_t> &path) {
+
+    if(sr >= map.numRows() || sc >= map.numCols() ||
+        tr >= map.numRows() || tc >= map.numCols()) {
+        throw std::out_of_range("Illegal coordinate in HPAStar::findPath()");
+    }
+
+    const double INF = std::numeric_limits<double>::infinity();
+    rebuild();
+    path.clear();
+
+    size_t s = map.cell(sr, sc), t = map.cell(tr, tc);
+    if(s == t) {
+        path.push_back(s);
+        return 0;
+    }
+    if(!map.passable(t)) {
+        return INF;
+    }
+
+    // connect the start to its cluster's entrances, and the goal's cluster
+    // entrances to the goal
+    size_t ks = clusterOf(s), kt = clusterOf(t);
+    size_t sr0, sc0, sr1, sc1, tr0, tc0, tr1, tc1;
+    bounds(ks, sr0, sc0, sr1, sc1);
+    bounds(kt, tr0, tc0, tr1, tc1);
+    std::vector<double> sDist, tDist;
+    gridDijkstra(map, sr0, sc0, sr1, sc1, s, false, sDist);
+    gridDijkstra(map, tr0, tc0, tr1, tc1, t, true, tDist);
+    auto sLocal = [&](size_t cell) {
+        return (map.row(cell) - sr0) * (sc1 - sc0) + map.col(cell) - sc0;
+    };
+    auto tLocal = [&](size_t cell) {
+        return (map.row(cell) - tr0) * (tc1 - tc0) + map.col(cell) - tc0;
+    };
+
+    // A* over the abstract graph; Manhattan distance times the cheapest
+    // tile weight never overestimates the remaining cost
+    auto h = [&](size_t cell) {
+        size_t dr = map.row(cell) > tr ? map.row(cell) - tr : tr - map.row(cell);
+        size_t dc = map.col(cell) > tc ? map.col(cell) - tc : tc - map.col(cell);
+        return (dr + dc) * GridMap::MIN_WEIGHT;
+    };
+
+    std::unordered_map<size_t, double> g;
+    std::unordered_map<size_t, size_t> pred;
+    typedef std::pair<double, size_t> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> Q;
+
+    auto relax = [&](size_t x, size_t y, double w) {
+        if(w == INF) {
+            return;
+        }
+        double ng = g[x] + w;
+        auto itr = g.find(y);
+        if(itr == g.end() || ng < itr->second) {
+            g[y] = ng;
+            pred[y] = x;
+            Q.push(Entry(ng + h(y), y));
+        }
+    };
+
+    g[s] = 0;
+    Q.push(Entry(h(s), s));
+    while(!Q.empty()) {
+        Entry top = Q.top();
+        Q.pop();
+        size_t x = top.second;
+        if(top.first > g[x] + h(x)) {
+            continue; // stale queue entry
+        }
+        if(x == t) {
+            break;
+        }
+
+        if(x == s) {
+            for(size_t n : clusters[ks].nodes) {
+                if(n != s) {
+                    relax(s, n, sDist[sLocal(n)]);
+                }
+            }
+            if(ks == kt) {
+                relax(s, t, sDist[sLocal(t)]);
+            }
+        }
+
+        size_t kx = clusterOf(x);
+        const Cluster &cl = clusters[kx];
+        size_t m = cl.nodes.size();
+        for(size_t i = 0; i < m; i++) {
+            if(cl.nodes[i] == x) {
+                for(size_t j = 0; j < m; j++) {
+                    if(j != i) {
+                        relax(x, cl.nodes[j], cl.cost[i * m + j]);
+                    }
+                }
+                for(size_t p : cl.partners[i]) {
+                    relax(x, p, map.weight(p));
+                }
+                break;
+            }
+        }
+
+        if(kx == kt && x != s) {
+            relax(x, t, tDist[tLocal(x)]);
+        }
+    }
+
+    if(g.find(t) == g.end()) {
+        return INF;
+    }
+
+    // walk the abstract path back from the goal, then refine each edge
+    std::vector<size_t> abstractPath;
+    for(size_t p = t; p != s; p = pred[p]) {
+        abstractPath.push_back(p);
+    }
+    abstractPath.push_back(s);
+
+    path.push_back(s);
+    for(size_t i = abstractPath.size() - 1; i > 0; i--) {
+        refine(abstractPath[i], abstractPath[i - 1], path);
+    }
+
+    return g[t];
+}
+
+// doctest unit tests for HPAStar::findPath
+TEST_CASE("testing HPAStar::findPath()") {
+    // random terrain, sized so the last row and column of clusters are
+    // partial
+    const size_t R = 43, C = 37;
+    const char pTiles[] = "cccsswx";
+    std::mt19937_64 prng(time(0));
+    std::uniform_int_distribution<size_t> tileDist(0, 6);
+    GridMap m(R, C);
+    for(size_t r = 0; r < R; r++) {
+        for(size_t c = 0; c < C; c++) {
+            m.setTile(r, c, pTiles[tileDist(prng)]);
+        }
+    }
+    HPAStar hpa(m, 8);
+    CHECK(30 == hpa.numClusters());
+    CHECK(30 == hpa.numClusterBuilds());
+    CHECK(hpa.numAbstractNodes() > 0);
+
+    std::uniform_int_distribution<size_t> rDist(0, R - 1), cDist(0, C - 1);
+    std::vector<double> exact;
+    std::vector<size_t> path;
+    for(int q = 0; q < 100; q++) {
+        size_t sr = rDist(prng), sc = cDist(prng);
+        size_t tr = rDist(prng), tc = cDist(prng);
+        size_t s = m.cell(sr, sc), t = m.cell(tr, tc);
+        gridDijkstra(m, 0, 0, R, C, s, false, exact);
+
+        double cost = hpa.findPath(sr, sc, tr, tc, path);
+
+        // a path is found exactly when one exists, and is never cheaper
+        // than the optimal one
+        CHECK(std::isinf(cost) == std::isinf(exact[t]));
+        if(std::isinf(cost)) {
+            CHECK(path.empty());
+            continue;
+        }
+        CHECK(cost >= exact[t] - 1e-9);
+
+        // the path is a connected walk over passable cells with the
+        // reported cost
+        CHECK(s == path.front());
+        CHECK(t == path.back());
+        double sum = 0;
+        for(size_t i = 1; i < path.size(); i++) {
+            size_t a = path[i - 1], b = path[i];
+            size_t dr = m.row(a) > m.row(b) ? m.row(a) - m.row(b) : m.row(b) - m.row(a);
+            size_t dc = m.col(a) > m.col(b) ? m.col(a) - m.col(b) : m.col(b) - m.col(a);
+            CHECK(1 == dr + dc);
+            CHECK(m.passable(b));
+            sum += m.weight(b);
+        }
+        CHECK(sum == doctest::Approx(cost));
+    }
+
+    // a start and goal in the same place
+    CHECK(0 == hpa.findPath(3, 4, 3, 4, path));
+    CHECK(1 == path.size());
+
+    // check exception handling
+    bool flag = true;
+    try {
+        hpa.findPath(R, 0, 0, 0, path);
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+    flag = true;
+    try {
+        HPAStar bad(m, 0);
+        flag = false;
+    } catch(std::invalid_argument ia) {
+    }
+    CHECK(flag);
+}
+
+// doctest unit tests for HPAStar::setTile
+TEST_CASE("testing HPAStar::setTile()") {
+    // a 40 x 40 map of concrete, split in two by a wall with one gap
+    GridMap m(40, 40);
+    for(size_t r = 0; r < 40; r++) {
+        m.setTile(r, 25, 'x');
+    }
+    m.setTile(33, 25, 's');
+
+    HPAStar hpa(m, 10);
+    CHECK(16 == hpa.numClusterBuilds());
+
+    std::vector<size_t> path;
+    double cost = hpa.findPath(0, 0, 0, 39, path);
+    CHECK_FALSE(std::isinf(cost));
+    CHECK(std::find(path.begin(), path.end(), m.cell(33, 25)) != path.end());
+
+    // closing the gap (inside cluster 14) disconnects the two halves; only
+    // that cluster is rebuilt
+    hpa.setTile(33, 25, 'x');
+    cost = hpa.findPath(0, 0, 0, 39, path);
+    CHECK(std::isinf(cost));
+    CHECK(path.empty());
+    CHECK(17 == hpa.numClusterBuilds());
+
+    // opening a gap on the south border of cluster 2 rebuilds cluster 2
+    // and cluster 6 below it
+    hpa.setTile(9, 25, 'w');
+    cost = hpa.findPath(0, 0, 0, 39, path);
+    CHECK_FALSE(std::isinf(cost));
+    CHECK(19 == hpa.numClusterBuilds());
+
+    std::vector<double> exact;
+    gridDijkstra(hpa.getMap(), 0, 0, 40, 40, 0, false, exact);
+    CHECK(cost >= exact[39] - 1e-9);
+
+    // a corner cell touches both the east and south neighbors
+    hpa.setTile(19, 19, 's');
+    hpa.findPath(0, 0, 0, 39, path);
+    CHECK(22 == hpa.numClusterBuilds());
+
+    // several changes in one cluster are rebuilt together
+    hpa.setTile(14, 14, 'w');
+    hpa.setTile(15, 15, 'w');
+    hpa.setTile(16, 16, 'w');
+    hpa.findPath(0, 0, 0, 39, path);
+    CHECK(23 == hpa.numClusterBuilds());
+
+    // check exception handling
+    bool flag = true;
+    try {
+        hpa.setTile(40, 0, 'c');
+        flag = false;
+    } catch(std::out_of_range oor) {
+    }
+    CHECK(flag);
+}
@@ -0,0 +1,4 @@
+// phantom C++ file for HPAStar unit testing. This file only inlcudes the 
+// HPAStar header; doctest generates the testing program based on unit 
+// tests written alongside the code in the header files
+#include "HPAStar.hpp"
@@ -0,0 +1,4 @@
+// phantom C++ file for EytzingerIndex unit testing. This file only inlcudes 
+// the EytzingerIndex header; doctest generates the testing program based on 
+// unit tests written alongside the code in the header file
+#include "EytzingerIndex.hpp"
\ No newline at end of file
@@ -0,0 +1,4 @@
+// phantom C++ file for ExternalSort unit testing. This file only inlcudes the 
+// ExternalSort header; doctest generates the testing program based on unit 
+// tests written alongside the code in the header file
+#include "ExternalSort.hpp"
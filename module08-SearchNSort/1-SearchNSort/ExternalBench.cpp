@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <vector>
+#include "ExternalSort.hpp"
+
+/**
+ * @brief Application entry point.
+ *
+ * Writes a file of random 64-bit records, sorts it with ExternalSort under
+ * memory budgets from the whole file down to 1/64 of it, and reports the
+ * number of runs and merge passes, the time taken, and the throughput in
+ * MB/s. Each sort is checked by reading the output back. The file and the
+ * temporary runs go in the current directory, unless a path prefix is
+ * given.
+ *
+ * @param argc Number of command-line arguments
+ *
+ * @param ppszArgs Array of command-line argument strings
+ */
+int main(int argc, char **ppszArgs) {
+    // command-line argument sanity check
+    if(argc < 2) {
+        fprintf(stderr, "Usage: ./ExternalBench megabytes [prefix]\n");
+        return EXIT_FAILURE;
+    }
+    size_t bytes = size_t(atol(ppszArgs[1])) << 20;
+    std::string prefix = argc > 2 ? ppszArgs[2] : "ExternalBench";
+    std::string inPath = prefix + ".in", outPath = prefix + ".out";
+
+    // write the input a block at a time
+    std::mt19937_64 prng(time(0));
+    size_t n = bytes / sizeof(uint64_t);
+    FILE *pIn = fopen(inPath.c_str(), "wb");
+    if(pIn == nullptr) {
+        fprintf(stderr, "Cannot create %s\n", inPath.c_str());
+        return EXIT_FAILURE;
+    }
+    std::vector<uint64_t> block(1 << 16);
+    for(size_t i = 0; i < n; i += block.size()) {
+        size_t len = std::min(block.size(), n - i);
+        for(size_t j = 0; j < len; j++) {
+            block[j] = prng();
+        }
+        fwrite(block.data(), sizeof(uint64_t), len, pIn);
+    }
+    fclose(pIn);
+
+    printf("%12s,%12s,%12s,%12s,%12s\n", "budgetMB", "runs", "passes",
+        "seconds", "MB/s");
+    for(size_t budget = bytes; budget >= bytes / 64 && budget > 0;
+        budget /= 4) {
+        ExternalSort<uint64_t> sorter(budget, prefix);
+        auto begin = std::chrono::high_resolution_clock::now();
+        sorter.sort(inPath, outPath);
+        auto end = std::chrono::high_resolution_clock::now();
+        double secs = std::chrono::duration_cast<std::chrono::microseconds>(
+            end - begin).count() / 1e6;
+
+        // the output must hold n records in order
+        FILE *pOut = fopen(outPath.c_str(), "rb");
+        size_t count = 0, len;
+        uint64_t last = 0;
+        bool sorted = true;
+        while((len = fread(block.data(), sizeof(uint64_t), block.size(),
+            pOut)) > 0) {
+            for(size_t j = 0; j < len; j++) {
+                sorted = sorted && last <= block[j];
+                last = block[j];
+            }
+            count += len;
+        }
+        fclose(pOut);
+        if(!sorted || count != n) {
+            fprintf(stderr, "\nSORT FAILURE!\n");
+            return EXIT_FAILURE;
+        }
+
+        printf("%12.3f, %11zu, %11zu, %0.5E, %0.5E\n", budget / 1048576.0,
+            sorter.numRuns(), sorter.numPasses(), secs, bytes / 1048576.0 /
+            secs);
+    }
+
+    remove(inPath.c_str());
+    remove(outPath.c_str());
+    return EXIT_SUCCESS;
+}
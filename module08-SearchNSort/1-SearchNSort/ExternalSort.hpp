@@ -0,0 +1,654 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <doctest.h>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "LoserTree.hpp"
+#include "SearchNSort.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief External merge sort, for binary files of records too large to sort
+ * in memory.
+ *
+ * SearchNSort::mergeSort() needs scratch space as large as the array, so it
+ * cannot sort more than half of RAM. ExternalSort works within a fixed
+ * memory budget, in two phases.
+ *
+ * Run formation reads the input a budget's worth at a time, sorts each
+ * chunk with SearchNSort::introSort(), and writes it to a temporary run
+ * file. Half of the budget holds the chunk being sorted while the other
+ * half is filled with the next chunk by an asynchronous read, so the disk
+ * and the processor work at the same time.
+ *
+ * Merging reads every run a block at a time and merges them with a
+ * KWayMerge, which reads the result straight into the blocks of the output
+ * file. Each run, and the output, has two blocks: one in use, and one being
+ * read or written in the background. If the runs are too many to give each
+ * a block of at least BLOCK_BYTES within the budget, groups of runs are
+ * merged into longer runs first, in as many passes as needed; each pass
+ * reads and writes all of the data once more.
+ *
+ * Records are copied as raw bytes, so T must be trivially copyable. The
+ * sort is not stable. Temporary files are named after a prefix given to the
+ * constructor, and are removed once merged, or as soon as the sort fails.
+ *
+ * @tparam T Type of record in the files.
+ */
+template <class T> class ExternalSort {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "ExternalSort records must be trivially copyable");
+
+public:
+  /**
+   * @brief Smallest block, in bytes, that each run gets while merging.
+   * Smaller blocks make for more, slower, reads.
+   */
+  static const size_t BLOCK_BYTES = 1u << 16;
+
+  /**
+   * @brief Construct a new ExternalSort.
+   *
+   * @param memoryBudget Number of bytes of record buffers the sort may use.
+   * @param tempPrefix Path prefix of the temporary run files, which can
+   * point into a directory on a different disk than the input.
+   */
+  ExternalSort(size_t memoryBudget,
+               const std::string &tempPrefix = "ExternalSort");
+
+  /**
+   * @brief Sort a binary file of records into another file, which may be
+   * the same one.
+   *
+   * @param inPath Path of the input file, a packed array of T.
+   * @param outPath Path of the output file, which is replaced.
+   * @param compare Comparator used to compare two records; see SearchNSort.
+   * @throws std::runtime_error if a file cannot be opened, read, or
+   * written, or if the input size is not a whole number of records.
+   */
+  template <class Compare>
+  void sort(const std::string &inPath, const std::string &outPath,
+            Compare compare);
+
+  /**
+   * @brief sort() using operator<.
+   */
+  void sort(const std::string &inPath, const std::string &outPath) {
+    sort(inPath, outPath, std::less<T>());
+  }
+
+  /**
+   * @brief Get the number of runs the last sort() formed.
+   *
+   * @return size_t Number of initial runs.
+   */
+  size_t numRuns() const { return runs; }
+
+  /**
+   * @brief Get the number of merge passes the last sort() made, including
+   * the final one.
+   *
+   * @return size_t Number of merge passes.
+   */
+  size_t numPasses() const { return passes; }
+
+  /**
+   * @brief Get the largest number of runs merged at once.
+   *
+   * @return size_t Merge fan-in, at least 2.
+   */
+  size_t maxFanIn() const { return fanIn; }
+
+private:
+  /**
+   * @brief Sequential reader of a run file, handing out one record at a
+   * time from one block while the next block is read in the background.
+   */
+  class BlockReader {
+  public:
+    /**
+     * @brief Open a run and start reading its first block.
+     */
+    BlockReader(const std::string &path, size_t blockRecords);
+
+    /**
+     * @brief Wait for the read in progress, then close the file.
+     */
+    ~BlockReader();
+
+    /**
+     * @brief Get the next record.
+     *
+     * @return const T* Pointer to the record, valid until the next call,
+     * or nullptr at the end of the run.
+     */
+    const T *next();
+
+  private:
+    FILE *pFile;
+    std::vector<T> pBufs[2];
+    size_t cur, pos, len;
+    std::future<size_t> pending;
+  };
+
+  /**
+   * @brief Input iterator over the records of a BlockReader, so a run can
+   * be a KWayMerge range. Iterators are equal when both are at the end.
+   */
+  class RunIterator {
+  public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T *pointer;
+    typedef const T &reference;
+
+    /**
+     * @brief Iterator at the first record of a run, or, by default, the
+     * end of any run.
+     */
+    explicit RunIterator(BlockReader *pReader = nullptr)
+        : pReader(pReader), pCur(pReader ? pReader->next() : nullptr) {}
+
+    const T &operator*() const { return *pCur; }
+
+    RunIterator &operator++() {
+      pCur = pReader->next();
+      return *this;
+    }
+
+    bool operator==(const RunIterator &other) const {
+      return pCur == other.pCur;
+    }
+
+    bool operator!=(const RunIterator &other) const {
+      return pCur != other.pCur;
+    }
+
+  private:
+    BlockReader *pReader;
+    const T *pCur;
+  };
+
+  /**
+   * @brief Sequential writer of a file, filling one block while the
+   * previous one is written in the background.
+   */
+  class BlockWriter {
+  public:
+    /**
+     * @brief Create, or replace, the file at path.
+     */
+    BlockWriter(const std::string &path, size_t blockRecords);
+
+    /**
+     * @brief Wait for the write in progress, then close the file, ignoring
+     * errors; call close() to check for them.
+     */
+    ~BlockWriter();
+
+    /**
+     * @brief Append everything left in a merge, reading it straight into
+     * the blocks.
+     */
+    template <class Merge> void pushAll(Merge &merge) {
+      while (!merge.empty()) {
+        len += merge.read(pBufs[cur].data() + len, pBufs[cur].size() - len);
+        if (len == pBufs[cur].size()) {
+          flush();
+        }
+      }
+    }
+
+    /**
+     * @brief Write out the records still buffered and close the file.
+     */
+    void close();
+
+  private:
+    /**
+     * @brief Wait for the previous block, and start writing the current
+     * one.
+     */
+    void flush();
+
+    FILE *pFile;
+    std::vector<T> pBufs[2];
+    size_t cur, len;
+    std::future<bool> pending;
+  };
+
+  /**
+   * @brief Guard that removes every temporary file it was told about when
+   * it goes out of scope, so a failed sort leaves none behind.
+   */
+  class TempFiles {
+  public:
+    /**
+     * @brief Remove every file added, ignoring any already gone.
+     */
+    ~TempFiles() {
+      for (const std::string &path : paths) {
+        std::remove(path.c_str());
+      }
+    }
+
+    /**
+     * @brief Note a file that is about to be created.
+     *
+     * @return const std::string& The path, for convenience.
+     */
+    const std::string &add(const std::string &path) {
+      paths.push_back(path);
+      return paths.back();
+    }
+
+  private:
+    std::vector<std::string> paths;
+  };
+
+  /**
+   * @brief Merge the run files paths[0, k) into outPath with a KWayMerge,
+   * then remove them.
+   */
+  template <class Compare>
+  void merge(const std::string *paths, size_t k, const std::string &outPath,
+             Compare &compare);
+
+  /**
+   * @brief Name of temporary run i of a merge pass; pass 0 holds the
+   * initial runs.
+   */
+  std::string runName(size_t pass, size_t i) const {
+    return tempPrefix + "." + std::to_string(pass) + "." +
+           std::to_string(i) + ".run";
+  }
+
+  /**
+   * @brief Open a file, throwing std::runtime_error if that fails.
+   */
+  static FILE *open(const std::string &path, const char *mode);
+
+  /**
+   * @brief Read up to n records from pFile into pBuf.
+   *
+   * @return size_t Number of records read, 0 at the end of the file.
+   * @throws std::runtime_error on a read error.
+   */
+  static size_t read(FILE *pFile, T *pBuf, size_t n);
+
+  /**
+   * @brief Memory budget, in bytes.
+   */
+  size_t budget;
+
+  /**
+   * @brief Path prefix of the temporary run files.
+   */
+  std::string tempPrefix;
+
+  /**
+   * @brief Largest number of runs merged at once.
+   */
+  size_t fanIn;
+
+  /**
+   * @brief Statistics of the last sort.
+   */
+  size_t runs, passes;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Implementation of ExternalSort constructor.
+ */
+template <class T>
+ExternalSort<T>::ExternalSort(size_t memoryBudget,
+                              const std::string &tempPrefix)
+    : budget(std::max(memoryBudget, 2 * sizeof(T))), tempPrefix(tempPrefix),
+      runs(0), passes(0) {
+  // each run being merged, and the output, gets two blocks
+  size_t blocks = budget / (2 * BLOCK_BYTES);
+  fanIn = blocks > 3u ? blocks - 1 : 2;
+}
+
+/*
+ * Implementation of sort() function.
+ */
+template <class T>
+template <class Compare>
+void ExternalSort<T>::sort(const std::string &inPath,
+                           const std::string &outPath, Compare compare) {
+  FILE *pIn = open(inPath, "rb");
+  if (std::fseek(pIn, 0, SEEK_END) != 0 ||
+      std::ftell(pIn) % static_cast<long>(sizeof(T)) != 0) {
+    std::fclose(pIn);
+    throw std::runtime_error("Partial record in " + inPath +
+                             " in ExternalSort::sort()");
+  }
+  std::rewind(pIn);
+
+  // run formation: sort one half of the budget while the next chunk is
+  // read into the other half
+  size_t chunk = budget / (2 * sizeof(T));
+  std::vector<T> pBufs[2] = {std::vector<T>(chunk), std::vector<T>(chunk)};
+  std::vector<std::string> paths;
+  TempFiles temps;
+  std::future<size_t> pending =
+      std::async(std::launch::async, read, pIn, pBufs[0].data(), chunk);
+  try {
+    for (size_t cur = 0u;; cur ^= 1u) {
+      size_t len = pending.get();
+      if (len == 0u) {
+        break;
+      }
+      pending = std::async(std::launch::async, read, pIn,
+                           pBufs[cur ^ 1u].data(), chunk);
+      SearchNSort<T>::introSort(pBufs[cur].data(), len, compare);
+
+      paths.push_back(temps.add(runName(0, paths.size())));
+      FILE *pRun = open(paths.back(), "wb");
+      bool ok = std::fwrite(pBufs[cur].data(), sizeof(T), len, pRun) == len;
+      if (std::fclose(pRun) != 0 || !ok) {
+        throw std::runtime_error("Write error in ExternalSort::sort()");
+      }
+    }
+  } catch (...) {
+    if (pending.valid()) {
+      pending.wait();
+    }
+    std::fclose(pIn);
+    throw;
+  }
+  std::fclose(pIn);
+  std::vector<T>().swap(pBufs[0]);
+  std::vector<T>().swap(pBufs[1]);
+  runs = paths.size();
+
+  // merge fanIn runs at a time until one last merge can finish the job
+  passes = 1;
+  while (paths.size() > fanIn) {
+    std::vector<std::string> next;
+    for (size_t i = 0u; i < paths.size(); i += fanIn) {
+      next.push_back(temps.add(runName(passes, next.size())));
+      merge(&paths[i], std::min(fanIn, paths.size() - i), next.back(),
+            compare);
+    }
+    paths.swap(next);
+    passes++;
+  }
+  merge(paths.data(), paths.size(), outPath, compare);
+}
+
+/*
+ * Implementation of private merge() helper function.
+ */
+template <class T>
+template <class Compare>
+void ExternalSort<T>::merge(const std::string *paths, size_t k,
+                            const std::string &outPath, Compare &compare) {
+  {
+    // two blocks for each run and two for the output
+    size_t blockRecords = std::max(budget / (2 * (k + 1) * sizeof(T)),
+                                   static_cast<size_t>(1));
+    std::vector<std::unique_ptr<BlockReader>> readers;
+    std::vector<std::pair<RunIterator, RunIterator>> ranges;
+    for (size_t i = 0u; i < k; i++) {
+      readers.emplace_back(new BlockReader(paths[i], blockRecords));
+      ranges.push_back(std::make_pair(RunIterator(readers[i].get()),
+                                      RunIterator()));
+    }
+    KWayMerge<RunIterator, Compare> merger(ranges.data(), k, compare);
+
+    BlockWriter out(outPath, blockRecords);
+    out.pushAll(merger);
+    out.close();
+  }
+
+  for (size_t i = 0u; i < k; i++) {
+    std::remove(paths[i].c_str());
+  }
+}
+
+/*
+ * Implementation of private open() helper function.
+ */
+template <class T>
+FILE *ExternalSort<T>::open(const std::string &path, const char *mode) {
+  FILE *pFile = std::fopen(path.c_str(), mode);
+  if (pFile == nullptr) {
+    throw std::runtime_error("Cannot open " + path +
+                             " in ExternalSort::sort()");
+  }
+  return pFile;
+}
+
+/*
+ * Implementation of private read() helper function.
+ */
+template <class T>
+size_t ExternalSort<T>::read(FILE *pFile, T *pBuf, size_t n) {
+  size_t len = std::fread(pBuf, sizeof(T), n, pFile);
+  if (len < n && std::ferror(pFile)) {
+    throw std::runtime_error("Read error in ExternalSort::sort()");
+  }
+  return len;
+}
+
+/*
+ * Implementation of BlockReader constructor.
+ */
+template <class T>
+ExternalSort<T>::BlockReader::BlockReader(const std::string &path,
+                                          size_t blockRecords)
+    : pFile(open(path, "rb")), cur(0), pos(0), len(0) {
+  pBufs[0].resize(blockRecords);
+  pBufs[1].resize(blockRecords);
+  pending = std::async(std::launch::async, read, pFile, pBufs[1].data(),
+                       blockRecords);
+}
+
+/*
+ * Implementation of BlockReader destructor.
+ */
+template <class T> ExternalSort<T>::BlockReader::~BlockReader() {
+  if (pending.valid()) {
+    pending.wait();
+  }
+  std::fclose(pFile);
+}
+
+/*
+ * Implementation of BlockReader::next() function.
+ */
+template <class T> const T *ExternalSort<T>::BlockReader::next() {
+  if (pos == len) {
+    // switch to the block read in the background, and start on the next
+    if (!pending.valid()) {
+      return nullptr;
+    }
+    len = pending.get();
+    cur ^= 1u;
+    pos = 0;
+    if (len == 0u) {
+      return nullptr;
+    }
+    pending = std::async(std::launch::async, read, pFile,
+                         pBufs[cur ^ 1u].data(), pBufs[cur].size());
+  }
+  return &pBufs[cur][pos++];
+}
+
+/*
+ * Implementation of BlockWriter constructor.
+ */
+template <class T>
+ExternalSort<T>::BlockWriter::BlockWriter(const std::string &path,
+                                          size_t blockRecords)
+    : pFile(open(path, "wb")), cur(0), len(0) {
+  pBufs[0].resize(blockRecords);
+  pBufs[1].resize(blockRecords);
+}
+
+/*
+ * Implementation of BlockWriter destructor.
+ */
+template <class T> ExternalSort<T>::BlockWriter::~BlockWriter() {
+  if (pending.valid()) {
+    pending.wait();
+  }
+  if (pFile != nullptr) {
+    std::fclose(pFile);
+  }
+}
+
+/*
+ * Implementation of private BlockWriter::flush() helper function.
+ */
+template <class T> void ExternalSort<T>::BlockWriter::flush() {
+  if (pending.valid() && !pending.get()) {
+    throw std::runtime_error("Write error in ExternalSort::sort()");
+  }
+  FILE *pOut = pFile;
+  const T *pBuf = pBufs[cur].data();
+  size_t n = len;
+  pending = std::async(std::launch::async, [pOut, pBuf, n]() {
+    return std::fwrite(pBuf, sizeof(T), n, pOut) == n;
+  });
+  cur ^= 1u;
+  len = 0;
+}
+
+/*
+ * Implementation of BlockWriter::close() function.
+ */
+template <class T> void ExternalSort<T>::BlockWriter::close() {
+  flush();
+  bool ok = pending.get();
+  ok = std::fclose(pFile) == 0 && ok;
+  pFile = nullptr;
+  if (!ok) {
+    throw std::runtime_error("Write error in ExternalSort::sort()");
+  }
+}
+
+// doctest unit test for ExternalSort
+TEST_CASE("testing ExternalSort") {
+  // write random records to a file, sort them with a budget far smaller
+  // than the file, and compare to sorting in memory
+  auto writeFile = [](const std::string &path, const std::vector<int> &v) {
+    FILE *pFile = std::fopen(path.c_str(), "wb");
+    REQUIRE(pFile != nullptr);
+    std::fwrite(v.data(), sizeof(int), v.size(), pFile);
+    std::fclose(pFile);
+  };
+  auto readFile = [](const std::string &path) {
+    std::vector<int> v;
+    FILE *pFile = std::fopen(path.c_str(), "rb");
+    REQUIRE(pFile != nullptr);
+    int x;
+    while (std::fread(&x, sizeof(int), 1, pFile) == 1u) {
+      v.push_back(x);
+    }
+    std::fclose(pFile);
+    return v;
+  };
+
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-1000, 1000);
+  std::vector<int> data(100000);
+  for (int &x : data) {
+    x = dist(prng);
+  }
+  writeFile("ExternalSortTest.in", data);
+  std::vector<int> expected = data;
+  std::sort(expected.begin(), expected.end());
+
+  // 64 KB: 8192 ints a run, merged two at a time, in several passes
+  ExternalSort<int> small(1u << 16, "ExternalSortTest");
+  small.sort("ExternalSortTest.in", "ExternalSortTest.out");
+  CHECK(expected == readFile("ExternalSortTest.out"));
+  CHECK(13 == small.numRuns());
+  CHECK(2 == small.maxFanIn());
+  CHECK(4 == small.numPasses());
+
+  // the temporary runs are gone
+  FILE *pRun = std::fopen("ExternalSortTest.0.0.run", "rb");
+  CHECK(pRun == nullptr);
+
+  // so they are when the sort fails: here the output cannot be created,
+  // which is found only at the last merge, after every earlier pass
+  bool flag = false;
+  try {
+    small.sort("ExternalSortTest.in", "ExternalSortTest.missing/out");
+  } catch (const std::runtime_error &) {
+    flag = true;
+  }
+  CHECK(flag);
+  for (int pass = 0; pass < 4; pass++) {
+    for (int i = 0; i < 13; i++) {
+      std::string path = "ExternalSortTest." + std::to_string(pass) + "." +
+                         std::to_string(i) + ".run";
+      pRun = std::fopen(path.c_str(), "rb");
+      CHECK(pRun == nullptr);
+      if (pRun != nullptr) {
+        std::fclose(pRun);
+      }
+    }
+  }
+
+  // 4 MB: a single run, and sorting a file in place with a three-way
+  // comparator for descending order
+  ExternalSort<int> large(1u << 22, "ExternalSortTest");
+  large.sort("ExternalSortTest.in", "ExternalSortTest.in",
+             [](const int &a, const int &b) { return b - a; });
+  std::reverse(expected.begin(), expected.end());
+  CHECK(expected == readFile("ExternalSortTest.in"));
+  CHECK(1 == large.numRuns());
+  CHECK(1 == large.numPasses());
+
+  // an empty file
+  writeFile("ExternalSortTest.in", std::vector<int>());
+  large.sort("ExternalSortTest.in", "ExternalSortTest.out");
+  CHECK(readFile("ExternalSortTest.out").empty());
+  CHECK(0 == large.numRuns());
+
+  // missing files and partial records
+  flag = false;
+  try {
+    large.sort("ExternalSortTest.missing", "ExternalSortTest.out");
+  } catch (const std::runtime_error &) {
+    flag = true;
+  }
+  CHECK(flag);
+
+  FILE *pFile = std::fopen("ExternalSortTest.in", "wb");
+  std::fputc('x', pFile);
+  std::fclose(pFile);
+  flag = false;
+  try {
+    large.sort("ExternalSortTest.in", "ExternalSortTest.out");
+  } catch (const std::runtime_error &) {
+    flag = true;
+  }
+  CHECK(flag);
+
+  std::remove("ExternalSortTest.in");
+  std::remove("ExternalSortTest.out");
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <doctest.h>
+#include <functional>
+#include <random>
+#include <vector>
+#include "SearchNSort.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief A sorted array copied into Eytzinger order, for fast searching.
+ *
+ * The Eytzinger layout stores the binary search tree of a sorted array
+ * level by level, like a binary heap: the root at index 1, and the children
+ * of node k at 2k and 2k + 1. Binary search on a plain sorted array touches
+ * a new cache line at almost every step once the array is bigger than the
+ * cache. In this layout the first levels, which every search visits, share
+ * a few cache lines, and the 2^d descendants d levels below node k sit
+ * together at index 2^d k. Each search step prefetches the cache line
+ * holding the node's descendants a cache line's worth of levels down, so
+ * several memory reads are in flight at once. Together with a branchless
+ * loop, that makes lookups in arrays of millions of keys several times
+ * faster than SearchNSort::binarySearch().
+ *
+ * The tree is padded to a perfect binary tree, of 2^h - 1 nodes, with
+ * copies of the largest element. Every search then takes exactly h steps,
+ * and the path it takes spells out the number of elements less than the
+ * key, so results come back as positions in the original sorted array
+ * without a lookup table. The cost is up to twice the memory of the array.
+ */
+template <class T> class EytzingerIndex {
+public:
+  /**
+   * @brief Construct a new EytzingerIndex from a sorted array.
+   *
+   * @param pArr Pointer to the first element of the array, which must be
+   * sorted in ascending order according to the comparator later searches
+   * will use. The array is copied.
+   * @param n Number of elements in the array.
+   */
+  EytzingerIndex(const T *pArr, size_t n);
+
+  /**
+   * @brief The index refers to its own storage, so it cannot be copied.
+   */
+  EytzingerIndex(const EytzingerIndex &) = delete;
+
+  /**
+   * @brief The index refers to its own storage, so it cannot be assigned.
+   */
+  EytzingerIndex &operator=(const EytzingerIndex &) = delete;
+
+  /**
+   * @brief Find where a key is, or belongs, in the original sorted array.
+   *
+   * @param key Key value to search for
+   * @param compare Comparator used to compare two elements; see
+   * SearchNSort. Must order elements the same way as the array was sorted.
+   * @return SearchResult Index in the original array of the first element
+   * not less than key, and whether that element equals key.
+   */
+  template <class Compare>
+  SearchResult lowerBound(const T &key, Compare compare) const;
+
+  /**
+   * @brief lowerBound() using operator<.
+   */
+  SearchResult lowerBound(const T &key) const {
+    return lowerBound(key, std::less<T>());
+  }
+
+  /**
+   * @brief Get the number of elements in the original array.
+   *
+   * @return size_t Number of elements indexed.
+   */
+  size_t size() const { return n; }
+
+private:
+  /**
+   * @brief Assumed size of a cache line, in bytes.
+   */
+  static const size_t CACHE_LINE = 64;
+
+  /**
+   * @brief Number of nodes prefetched per step: about a cache line's worth,
+   * and a power of two, so they are exactly the descendants of one node
+   * lg(BLOCK) levels down.
+   */
+  static const size_t BLOCK = sizeof(T) <= CACHE_LINE / 16 ? 16
+                              : sizeof(T) <= CACHE_LINE / 8 ? 8
+                              : sizeof(T) <= CACHE_LINE / 4 ? 4
+                              : 1;
+
+  /**
+   * @brief Fill the subtree rooted at node k with the elements of pArr in
+   * order, starting at element i, and padding past element n - 1 with
+   * pArr[n - 1].
+   *
+   * @return size_t Index of the next element to place.
+   */
+  size_t build(const T *pArr, size_t i, size_t k);
+
+  /**
+   * @brief Number of trailing one bits in k.
+   */
+  static size_t trailingOnes(size_t k) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(~static_cast<unsigned long long>(k));
+#else
+    size_t ones = 0;
+    for (; k & 1u; k >>= 1) {
+      ones++;
+    }
+    return ones;
+#endif
+  }
+
+  /**
+   * @brief Number of elements in the original array.
+   */
+  size_t n;
+
+  /**
+   * @brief Number of levels in the padded tree.
+   */
+  size_t height;
+
+  /**
+   * @brief Memory for the tree, with room to align it.
+   */
+  std::vector<T> storage;
+
+  /**
+   * @brief The tree, node k at pTree[k] for k in [1, 2^height); points
+   * into storage, so that pTree[BLOCK * k] starts a cache line.
+   */
+  T *pTree;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Implementation of EytzingerIndex constructor.
+ */
+template <class T>
+EytzingerIndex<T>::EytzingerIndex(const T *pArr, size_t n) : n(n), height(0) {
+  size_t treeSize = 0;
+  while (treeSize < n) {
+    treeSize = 2 * treeSize + 1;
+    height++;
+  }
+
+  // room for node 0, which is never used, and for shifting pTree up to a
+  // cache-line boundary
+  size_t slack = CACHE_LINE / sizeof(T) + 1;
+  storage.resize(treeSize + 1 + slack);
+  pTree = storage.data();
+  while (reinterpret_cast<uintptr_t>(pTree) % CACHE_LINE != 0 &&
+         pTree < storage.data() + slack) {
+    pTree++;
+  }
+
+  if (n > 0u) {
+    build(pArr, 0, 1);
+  }
+}
+
+/*
+ * Implementation of private build() helper function.
+ */
+template <class T>
+size_t EytzingerIndex<T>::build(const T *pArr, size_t i, size_t k) {
+  if (k >= (static_cast<size_t>(1) << height)) {
+    return i;
+  }
+  i = build(pArr, i, 2 * k);
+  pTree[k] = pArr[std::min(i, n - 1)];
+  return build(pArr, i + 1, 2 * k + 1);
+}
+
+/*
+ * Implementation of lowerBound() function.
+ */
+template <class T>
+template <class Compare>
+SearchResult EytzingerIndex<T>::lowerBound(const T &key,
+                                           Compare compare) const {
+  // step right past every node less than the key; prefetching the node's
+  // descendants BLOCK levels down may point past the end of the tree, which
+  // is harmless, as prefetches never fault
+  size_t k = 1;
+  for (size_t level = 0; level < height; level++) {
+    SearchNSort<T>::prefetch(pTree + BLOCK * k);
+    k = 2 * k + SearchNSort<T>::before(compare, pTree[k], key);
+  }
+
+  // k is now 2^height plus the number of elements less than the key; the
+  // last node where the search went left is the first element not less
+  size_t less = k - (static_cast<size_t>(1) << height);
+  SearchResult res = {std::min(less, n), false};
+  size_t node = k >> (trailingOnes(k) + 1);
+  res.found = res.index < n && !SearchNSort<T>::before(compare, key,
+                                                      pTree[node]);
+  return res;
+}
+
+// doctest unit test for EytzingerIndex
+TEST_CASE("testing EytzingerIndex") {
+  // every key from below the smallest element to above the largest, on
+  // arrays with duplicates, of every size up to 100
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-50, 50);
+  for (size_t n = 0; n <= 100; n++) {
+    std::vector<int> pA(n);
+    for (size_t i = 0; i < n; i++) {
+      pA[i] = dist(prng);
+    }
+    std::sort(pA.begin(), pA.end());
+    EytzingerIndex<int> index(pA.data(), n);
+    CHECK(n == index.size());
+
+    for (int key = -52; key <= 52; key++) {
+      size_t expected = std::lower_bound(pA.begin(), pA.end(), key) -
+                        pA.begin();
+      bool found = std::binary_search(pA.begin(), pA.end(), key);
+      SearchResult res = index.lowerBound(key);
+      CHECK(expected == res.index);
+      CHECK(found == res.found);
+    }
+  }
+
+  // large array of doubles, and a three-way comparator on a descending
+  // array
+  const size_t n = 100000;
+  std::vector<double> pB(n);
+  std::uniform_real_distribution<double> real;
+  for (size_t i = 0; i < n; i++) {
+    pB[i] = real(prng);
+  }
+  std::sort(pB.begin(), pB.end());
+  EytzingerIndex<double> bIndex(pB.data(), n);
+  for (size_t i = 0; i < 1000; i++) {
+    double key = i % 2 == 0 ? pB[prng() % n] : real(prng);
+    SearchResult res = bIndex.lowerBound(key);
+    CHECK(res.index == size_t(std::lower_bound(pB.begin(), pB.end(), key) -
+                              pB.begin()));
+    CHECK(res.found == (i % 2 == 0));
+  }
+
+  std::vector<int> pC = {9, 7, 7, 4, 1};
+  EytzingerIndex<int> cIndex(pC.data(), pC.size());
+  auto descending = [](const int &a, const int &b) { return b - a; };
+  CHECK(1 == cIndex.lowerBound(7, descending).index);
+  CHECK(cIndex.lowerBound(7, descending).found);
+  CHECK(3 == cIndex.lowerBound(5, descending).index);
+  CHECK(!cIndex.lowerBound(5, descending).found);
+  CHECK(5 == cIndex.lowerBound(0, descending).index);
+}
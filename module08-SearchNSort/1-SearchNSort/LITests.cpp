@@ -0,0 +1,4 @@
+// phantom C++ file for LearnedIndex unit testing. This file only inlcudes 
+// the LearnedIndex header; doctest generates the testing program based on 
+// unit tests written alongside the code in the header file
+#include "LearnedIndex.hpp"
\ No newline at end of file
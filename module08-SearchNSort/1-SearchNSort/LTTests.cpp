@@ -0,0 +1,4 @@
+// phantom C++ file for LoserTree unit testing. This file only inlcudes the 
+// LoserTree header; doctest generates the testing program based on unit 
+// tests written alongside the code in the header file
+#include "LoserTree.hpp"
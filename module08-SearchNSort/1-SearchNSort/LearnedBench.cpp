@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <vector>
+#include "LearnedIndex.hpp"
+#include "SearchNSort.hpp"
+
+/**
+ * @brief Time a search method over a batch of keys.
+ *
+ * @param keys Keys to look up
+ *
+ * @param search Callable taking a key and returning the index where it
+ * was found or belongs
+ *
+ * @param checksum Incremented by every index returned, so the searches
+ * cannot be optimized away and different methods can be cross-checked
+ *
+ * @return Mean time per lookup in nanoseconds
+ */
+template <class Search>
+double timeSearch(const std::vector<double> &keys, Search search,
+    size_t &checksum) {
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    for(double key : keys) {
+        checksum += search(key);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end -
+        begin).count() / double(keys.size());
+}
+
+/**
+ * @brief Application entry point.
+ *
+ * Compares a LearnedIndex to binary search on sorted arrays of doubles from
+ * 2^16 to 2^maxPower elements, drawn either uniformly from [0, 1), or from
+ * a lognormal distribution, whose long tail is harder to learn. For the
+ * learned index it reports the build time per key, the memory overhead in
+ * bytes per key, and the largest search window; then the mean lookup time
+ * of binarySearch, the branchless lowerBound, and the learned index, over
+ * random keys, half of them present. Binary search needs no build time and
+ * no memory beyond the array.
+ *
+ * @param argc Number of command-line arguments
+ *
+ * @param ppszArgs Array of command-line argument strings
+ */
+int main(int argc, char **ppszArgs) {
+    // command-line argument sanity check
+    if(argc < 2) {
+        fprintf(stderr, "Usage: ./LearnedBench maxPower [lognormal "
+            "[numLookups]]\n");
+        return EXIT_FAILURE;
+    }
+    int powerCap = atoi(ppszArgs[1]);
+    bool lognormal = argc > 2 && strcmp(ppszArgs[2], "lognormal") == 0;
+    size_t numLookups = argc > 3 ? atol(ppszArgs[3]) : 1000000;
+
+    std::mt19937_64 prng(time(0));
+    std::uniform_real_distribution<double> uniform;
+    std::lognormal_distribution<double> skewed(0.0, 2.0);
+    auto draw = [&]() { return lognormal ? skewed(prng) : uniform(prng); };
+    auto less = [](const double &x, const double &y) { return x < y; };
+
+    printf("%10s,%12s,%12s,%12s,%12s,%12s,%12s\n", "n", "buildNs/key",
+        "bytes/key", "maxWindow", "binary", "lowerBound", "learned");
+    for(int power = 16; power <= powerCap; power++) {
+        size_t n = size_t(1) << power;
+        std::vector<double> arr(n);
+        for(double &x : arr) {
+            x = draw();
+        }
+        std::sort(arr.begin(), arr.end());
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        LearnedIndex<double> index(arr.data(), n);
+        auto end = std::chrono::high_resolution_clock::now();
+        double buildNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            end - begin).count() / double(n);
+
+        std::vector<double> keys(numLookups);
+        for(size_t i = 0; i < numLookups; i++) {
+            keys[i] = i % 2 == 0 ? arr[prng() % n] : draw();
+        }
+
+        // binarySearch reports only hits, so its checksum counts those
+        size_t hits = 0, sums[2] = {0, 0};
+        double pDur[] = {
+            timeSearch(keys, [&](double key) {
+                return size_t(SearchNSort<double>::binarySearch(arr.data(),
+                    n, key, less) >= 0);
+            }, hits),
+            timeSearch(keys, [&](double key) {
+                return SearchNSort<double>::lowerBound(arr.data(), n, key,
+                    less).index;
+            }, sums[0]),
+            timeSearch(keys, [&](double key) {
+                return index.lowerBound(key).index;
+            }, sums[1])
+        };
+
+        if(sums[0] != sums[1] || hits < numLookups / 2) {
+            fprintf(stderr, "\nSEARCH FAILURE!\n");
+            return EXIT_FAILURE;
+        }
+        printf("%10zu, %0.5E, %0.5E, %11zu", n, buildNs,
+            index.memoryUsed() / double(n), index.maxWindow());
+        for(double dur : pDur) {
+            printf(", %0.5E", dur);
+        }
+        printf("\n");
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,382 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <ctime>
+#include <doctest.h>
+#include <functional>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include "SearchNSort.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief A learned index over a sorted array of numbers: a two-stage
+ * recursive model index (RMI).
+ *
+ * A sorted array is a function from keys to positions, and its cumulative
+ * distribution can be approximated by a model. The root model picks one of
+ * many leaf models. It is a piecewise-linear curve through up to
+ * ROOT_KNOTS + 1 evenly spaced quantiles of the keys, so skewed keys, which
+ * a single line would send almost all to a few leaves, are spread over all
+ * of them. Each leaf is a least-squares line fitted to the keys the root
+ * sends to it, and predicts the key's position. While training, each leaf
+ * also records how far its predictions were from the true positions, so a
+ * lookup only has to search a small window around the prediction. A lookup
+ * costs a search of the root's knots, which stay in cache, a leaf model,
+ * and a binary search of a few dozen elements, instead of lg n dependent
+ * cache misses.
+ *
+ * The index keeps a pointer to the array rather than a copy, and adds only
+ * the models: about 48 bytes per KEYS_PER_MODEL keys, plus the root's
+ * knots. The array must not be changed or freed while the index is in use.
+ */
+template <class T> class LearnedIndex {
+  static_assert(std::is_arithmetic<T>::value,
+                "LearnedIndex indexes arithmetic types only");
+
+public:
+  /**
+   * @brief Default number of keys per leaf model.
+   */
+  static const size_t KEYS_PER_MODEL = 256;
+
+  /**
+   * @brief Number of linear pieces in the root model, or of leaf models if
+   * there are fewer.
+   */
+  static const size_t ROOT_KNOTS = 1024;
+
+  /**
+   * @brief Construct a new LearnedIndex by training on a sorted array.
+   *
+   * @param pArr Pointer to the first element of the array, which must be
+   * sorted in ascending order.
+   * @param n Number of elements in the array.
+   * @param numModels Number of leaf models; 0 means n / KEYS_PER_MODEL.
+   * More models predict better, but take more memory.
+   */
+  LearnedIndex(const T *pArr, size_t n, size_t numModels = 0);
+
+  /**
+   * @brief Find where a key is, or belongs, in the array.
+   *
+   * @param key Key value to search for
+   * @return SearchResult Index of the first element not less than key, and
+   * whether that element equals key.
+   */
+  SearchResult lowerBound(const T &key) const;
+
+  /**
+   * @brief Get the number of elements in the array.
+   *
+   * @return size_t Number of elements indexed.
+   */
+  size_t size() const { return n; }
+
+  /**
+   * @brief Get the number of leaf models.
+   *
+   * @return size_t Number of leaf models.
+   */
+  size_t numModels() const { return models.size(); }
+
+  /**
+   * @brief Get the memory taken by the index, not counting the array.
+   *
+   * @return size_t Size of the index in bytes.
+   */
+  size_t memoryUsed() const {
+    return sizeof(*this) + models.capacity() * sizeof(Model) +
+           knots.capacity() * sizeof(double);
+  }
+
+  /**
+   * @brief Get the size of the largest search window of any leaf.
+   *
+   * @return size_t Largest number of elements a lookup has to search.
+   */
+  size_t maxWindow() const;
+
+private:
+  /**
+   * @brief A leaf model: a line predicting positions from keys, the range
+   * of positions of the keys the root sends to it, and the range of its
+   * prediction errors on them.
+   */
+  struct Model {
+    double slope, intercept;
+    size_t start, end;
+    long long minErr, maxErr;
+  };
+
+  /**
+   * @brief Fit a least-squares line to (pArr[i], i) for i in [lo, hi),
+   * returning its slope and intercept.
+   */
+  static void fit(const T *pArr, size_t lo, size_t hi, double &slope,
+                  double &intercept);
+
+  /**
+   * @brief Index of the leaf model for a key: the root model's estimate of
+   * the key's quantile, scaled to the number of leaves. Never decreases as
+   * the key increases.
+   */
+  size_t leafOf(double key) const;
+
+  /**
+   * @brief Position a leaf model predicts for a key, clamped to [0, n] so
+   * that keys far outside the array cannot overflow it.
+   */
+  long long predict(const Model &model, double key) const {
+    double pos = std::floor(model.slope * key + model.intercept);
+    if (!(pos > 0)) {
+      return 0;
+    }
+    return pos < n ? static_cast<long long>(pos) : (long long)n;
+  }
+
+  /**
+   * @brief The indexed array.
+   */
+  const T *pArr;
+
+  /**
+   * @brief Number of elements in the array.
+   */
+  size_t n;
+
+  /**
+   * @brief The root model: with R + 1 knots, knots[r] is the key at
+   * quantile r / R.
+   */
+  std::vector<double> knots;
+
+  /**
+   * @brief The leaf models.
+   */
+  std::vector<Model> models;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Implementation of private fit() helper function.
+ */
+template <class T>
+void LearnedIndex<T>::fit(const T *pArr, size_t lo, size_t hi,
+                          double &slope, double &intercept) {
+  // centered sums, for accuracy on keys far from 0
+  size_t count = hi - lo;
+  double meanX = 0, meanY = 0;
+  for (size_t i = lo; i < hi; i++) {
+    meanX += static_cast<double>(pArr[i]);
+    meanY += i;
+  }
+  meanX /= count;
+  meanY /= count;
+
+  double sxx = 0, sxy = 0;
+  for (size_t i = lo; i < hi; i++) {
+    double dx = static_cast<double>(pArr[i]) - meanX;
+    sxx += dx * dx;
+    sxy += dx * (i - meanY);
+  }
+
+  // sorted keys make sxy >= 0, so the line never slopes down; a range of
+  // equal keys gets a flat line through the middle
+  slope = sxx > 0 ? sxy / sxx : 0;
+  intercept = meanY - slope * meanX;
+}
+
+/*
+ * Implementation of LearnedIndex constructor.
+ */
+template <class T>
+LearnedIndex<T>::LearnedIndex(const T *pArr, size_t n, size_t numModels)
+    : pArr(pArr), n(n) {
+
+  if (numModels == 0u) {
+    numModels = n / KEYS_PER_MODEL;
+  }
+  models.resize(std::max<size_t>(numModels, 1));
+  if (n == 0u) {
+    models[0] = Model{0, 0, 0, 0, 0, 0};
+    return;
+  }
+
+  // the root never decreases, so each leaf gets a contiguous range of the
+  // array
+  size_t numPieces = models.size() < ROOT_KNOTS ? models.size() : ROOT_KNOTS;
+  knots.resize(numPieces + 1);
+  for (size_t r = 0; r <= numPieces; r++) {
+    knots[r] = static_cast<double>(pArr[r * (n - 1) / numPieces]);
+  }
+
+  size_t i = 0;
+  for (size_t m = 0; m < models.size(); m++) {
+    Model &model = models[m];
+    model.start = i;
+    while (i < n && leafOf(static_cast<double>(pArr[i])) == m) {
+      i++;
+    }
+    model.end = i;
+
+    model.slope = 0;
+    model.intercept = model.start;
+    model.minErr = model.maxErr = 0;
+    if (model.end > model.start) {
+      fit(pArr, model.start, model.end, model.slope, model.intercept);
+      model.minErr = model.maxErr =
+          (long long)model.start - predict(model, pArr[model.start]);
+      for (size_t j = model.start; j < model.end; j++) {
+        long long err = (long long)j - predict(model, pArr[j]);
+        model.minErr = std::min(model.minErr, err);
+        model.maxErr = std::max(model.maxErr, err);
+      }
+    }
+  }
+}
+
+/*
+ * Implementation of private leafOf() helper function.
+ */
+template <class T> size_t LearnedIndex<T>::leafOf(double key) const {
+  size_t numPieces = knots.size() - 1;
+  if (!(key > knots[0])) {
+    return 0;
+  }
+  if (!(key < knots[numPieces])) {
+    return models.size() - 1;
+  }
+
+  // knots[r - 1] < key <= knots[r]; interpolate along that piece
+  std::less<double> less;
+  size_t r = SearchNSort<double>::lowerBound(knots.data(), numPieces + 1,
+                                             key, less).index;
+  double frac = (key - knots[r - 1]) / (knots[r] - knots[r - 1]);
+  double pos = (r - 1 + frac) * models.size() / numPieces;
+  return std::min(static_cast<size_t>(pos), models.size() - 1);
+}
+
+/*
+ * Implementation of maxWindow() function.
+ */
+template <class T> size_t LearnedIndex<T>::maxWindow() const {
+  size_t window = 0;
+  for (const Model &model : models) {
+    window = std::max<size_t>(window, model.maxErr - model.minErr + 1);
+  }
+  return window;
+}
+
+/*
+ * Implementation of lowerBound() function.
+ */
+template <class T>
+SearchResult LearnedIndex<T>::lowerBound(const T &key) const {
+  if (n == 0u) {
+    SearchResult res = {0, false};
+    return res;
+  }
+
+  // the answer lies within the leaf's error bounds of its prediction, and
+  // within the leaf's range of positions
+  double x = static_cast<double>(key);
+  const Model &model = models[leafOf(x)];
+  long long pos = predict(model, x);
+  long long lo = std::max<long long>(pos + model.minErr, model.start);
+  long long hi = std::min<long long>(pos + model.maxErr + 1, model.end);
+  lo = std::min<long long>(lo, model.end);
+  hi = std::max(hi, lo);
+
+  std::less<T> less;
+  SearchResult res = SearchNSort<T>::lowerBound(pArr + lo, hi - lo, key,
+                                                less);
+  res.index += lo;
+
+  // the bounds hold for every key in exact arithmetic; if rounding ever
+  // leaves the answer outside the window, the result is off, and galloping
+  // out from it finds the right one
+  res.found = res.index < n && !less(key, pArr[res.index]);
+  if ((res.index > 0 && !less(pArr[res.index - 1], key)) ||
+      (res.index < n && less(pArr[res.index], key))) {
+    res = SearchNSort<T>::exponentialSearch(pArr, n, key, less, res.index);
+  }
+  return res;
+}
+
+// doctest unit test for LearnedIndex
+TEST_CASE("testing LearnedIndex") {
+  std::mt19937_64 prng(time(0));
+
+  // uniform and heavily skewed doubles, with present and absent keys, and
+  // numbers of models from one to more than there are keys
+  const size_t n = 100000;
+  std::uniform_real_distribution<double> real;
+  std::lognormal_distribution<double> lognormal(0.0, 2.0);
+  for (int skewed = 0; skewed < 2; skewed++) {
+    std::vector<double> pA(n);
+    for (size_t i = 0; i < n; i++) {
+      pA[i] = skewed ? lognormal(prng) : real(prng);
+    }
+    std::sort(pA.begin(), pA.end());
+
+    size_t modelCounts[] = {0, 1, 100, 2 * n};
+    for (size_t numModels : modelCounts) {
+      LearnedIndex<double> index(pA.data(), n, numModels);
+      CHECK(n == index.size());
+      CHECK((numModels == 0 ? n / 256 : numModels) == index.numModels());
+      for (size_t i = 0; i < 2000; i++) {
+        double key = i % 2 == 0 ? pA[prng() % n]
+                                : (skewed ? lognormal(prng) : real(prng));
+        SearchResult res = index.lowerBound(key);
+        CHECK(res.index == size_t(std::lower_bound(pA.begin(), pA.end(),
+                                                   key) - pA.begin()));
+        CHECK(res.found == (i % 2 == 0));
+      }
+      CHECK(0 == index.lowerBound(-1.0).index);
+      CHECK(n == index.lowerBound(1e300).index);
+    }
+  }
+
+  // training on uniform keys gives small windows and little memory
+  std::vector<double> pB(n);
+  for (size_t i = 0; i < n; i++) {
+    pB[i] = real(prng);
+  }
+  std::sort(pB.begin(), pB.end());
+  LearnedIndex<double> bIndex(pB.data(), n);
+  CHECK(bIndex.maxWindow() < 256);
+  CHECK(bIndex.memoryUsed() < n);
+
+  // ints with long runs of duplicates, every key from below to above
+  std::vector<int> pC;
+  for (int i = 0; i < 1000; i++) {
+    pC.push_back(i < 500 ? 7 : i / 10);
+  }
+  LearnedIndex<int> cIndex(pC.data(), pC.size(), 20);
+  for (int key = -1; key <= 101; key++) {
+    SearchResult res = cIndex.lowerBound(key);
+    CHECK(res.index == size_t(std::lower_bound(pC.begin(), pC.end(), key) -
+                              pC.begin()));
+    CHECK(res.found == std::binary_search(pC.begin(), pC.end(), key));
+  }
+
+  // tiny and empty arrays
+  int pD[] = {5};
+  LearnedIndex<int> dIndex(pD, 1);
+  CHECK(0 == dIndex.lowerBound(5).index);
+  CHECK(dIndex.lowerBound(5).found);
+  CHECK(1 == dIndex.lowerBound(6).index);
+  LearnedIndex<int> eIndex(pD, 0);
+  CHECK(0 == eIndex.lowerBound(5).index);
+  CHECK(!eIndex.lowerBound(5).found);
+}
@@ -0,0 +1,501 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <ctime>
+#include <doctest.h>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include "SearchNSort.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief A tournament tree of losers, for merging k sorted sources.
+ *
+ * Each of the k sources offers its current head element, or nothing once
+ * it is exhausted. The leaves of a complete binary tree are the sources;
+ * every internal node remembers the loser of the match played there, and
+ * the overall winner, the smallest head, is kept at the top. When the
+ * winner's source moves on to its next element, only the matches on the
+ * path from that source's leaf to the root are replayed, each against the
+ * loser stored at the node, so finding the next smallest head takes
+ * exactly ceil(lg k) comparisons. A binary heap needs about twice as many.
+ *
+ * Ties go to the source with the smaller index, so merging runs of one
+ * array in order is stable. Heads are held by pointer, so the tree never
+ * copies an element; the pointers must stay valid until they are replaced.
+ *
+ * @tparam T Type of element being merged.
+ * @tparam Compare Comparator type; see SearchNSort.
+ */
+template <class T, class Compare> class LoserTree {
+public:
+  /**
+   * @brief Construct a new LoserTree for k sources, all exhausted until
+   * set() and build() are called.
+   *
+   * @param k Number of sources.
+   * @param compare Comparator used to compare two elements.
+   */
+  LoserTree(size_t k, Compare compare);
+
+  /**
+   * @brief Set the head of a source, before calling build().
+   *
+   * @param source Index of the source, in [0, k).
+   * @param pHead Pointer to the source's first element, or nullptr if the
+   * source is empty.
+   */
+  void set(size_t source, const T *pHead) { heads[source] = pHead; }
+
+  /**
+   * @brief Play the whole tournament, after the heads have been set.
+   */
+  void build();
+
+  /**
+   * @brief Check whether every source is exhausted.
+   *
+   * @return bool true if there is no winner.
+   */
+  bool empty() const { return heads.empty() || heads[losers[0]] == nullptr; }
+
+  /**
+   * @brief Get the index of the source holding the smallest head. Only
+   * meaningful if the tree is not empty.
+   *
+   * @return size_t Index of the winning source.
+   */
+  size_t winner() const { return losers[0]; }
+
+  /**
+   * @brief Get the smallest head. The tree must not be empty.
+   *
+   * @return const T& Reference to the winning element.
+   */
+  const T &top() const { return *heads[losers[0]]; }
+
+  /**
+   * @brief Replace the winner's head with its source's next element, and
+   * replay its matches to find the new winner.
+   *
+   * @param pHead Pointer to the next element of the winning source, or
+   * nullptr if that source is exhausted.
+   */
+  void replace(const T *pHead);
+
+private:
+  /**
+   * @brief Play the matches of the subtree rooted at node, storing the
+   * losers in it.
+   *
+   * @return size_t Index of the subtree's winning source.
+   */
+  size_t play(size_t node);
+
+  /**
+   * @brief Check whether source a beats source b: a has a head and b does
+   * not, or a's head is smaller, or the heads tie and a < b. Takes one
+   * comparison.
+   */
+  bool beats(size_t a, size_t b) {
+    if (heads[a] == nullptr || heads[b] == nullptr) {
+      return heads[b] == nullptr && heads[a] != nullptr;
+    }
+    return a < b ? !SearchNSort<T>::before(compare, *heads[b], *heads[a])
+                 : SearchNSort<T>::before(compare, *heads[a], *heads[b]);
+  }
+
+  /**
+   * @brief Comparator used to compare two elements.
+   */
+  Compare compare;
+
+  /**
+   * @brief Current head of each source, nullptr if exhausted.
+   */
+  std::vector<const T *> heads;
+
+  /**
+   * @brief Source that lost the match at each internal node, which are
+   * numbered 1 to k - 1 like a binary heap; the leaf of source i is node
+   * k + i. losers[0] holds the overall winner.
+   */
+  std::vector<size_t> losers;
+};
+
+/**
+ * @brief A k-way merge of sorted ranges, driven by a LoserTree.
+ *
+ * SearchNSort::merge() merges two halves of one array. KWayMerge merges any
+ * number of sorted ranges, each given by a pair of iterators, such as the
+ * outputs of separate shards or the runs of a parallel sort. Each output
+ * element costs ceil(lg k) comparisons.
+ *
+ * Output is pulled in batches with read(), so a merge can be streamed: the
+ * ranges may be input iterators that read sorted files as they go, like
+ * std::istream_iterator, and the output may go to a file a buffer at a
+ * time. Only the current element of each range is held. merge() runs a
+ * whole merge into an output iterator, copying it out BATCH elements at a
+ * time.
+ *
+ * Dereferencing an iterator must give a reference that stays valid until
+ * the iterator is incremented. Ties go to the earlier range, so the merge
+ * is stable.
+ *
+ * @tparam Iter Iterator type of the input ranges.
+ * @tparam Compare Comparator type; see SearchNSort.
+ */
+template <class Iter, class Compare> class KWayMerge {
+public:
+  /**
+   * @brief Type of element being merged.
+   */
+  typedef typename std::iterator_traits<Iter>::value_type T;
+
+  /**
+   * @brief Number of elements merge() gathers before copying them out.
+   */
+  static const size_t BATCH = 256;
+
+  /**
+   * @brief Construct a new KWayMerge, ready to read the smallest elements.
+   *
+   * @param pRanges Pointer to the first of k [begin, end) iterator pairs,
+   * each a range sorted according to compare. The pairs are copied.
+   * @param k Number of ranges.
+   * @param compare Comparator used to compare two elements.
+   */
+  KWayMerge(const std::pair<Iter, Iter> *pRanges, size_t k, Compare compare);
+
+  /**
+   * @brief The merge refers to its own iterators, so it cannot be copied.
+   */
+  KWayMerge(const KWayMerge &) = delete;
+
+  /**
+   * @brief The merge refers to its own iterators, so it cannot be assigned.
+   */
+  KWayMerge &operator=(const KWayMerge &) = delete;
+
+  /**
+   * @brief Move the next elements of the merge into a buffer.
+   *
+   * @param pOut Pointer to the first element of the buffer.
+   * @param max Number of elements the buffer holds.
+   * @return size_t Number of elements read, less than max only once the
+   * merge is done.
+   */
+  size_t read(T *pOut, size_t max);
+
+  /**
+   * @brief Check whether every range has been merged.
+   *
+   * @return bool true if there are no elements left.
+   */
+  bool empty() const { return tree.empty(); }
+
+  /**
+   * @brief Merge sorted ranges into an output iterator.
+   *
+   * @param pRanges Pointer to the first of k [begin, end) iterator pairs.
+   * @param k Number of ranges.
+   * @param out Where the merged elements go.
+   * @param compare Comparator used to compare two elements.
+   * @return OutputIt out, advanced past the last element written.
+   */
+  template <class OutputIt>
+  static OutputIt merge(const std::pair<Iter, Iter> *pRanges, size_t k,
+                        OutputIt out, Compare compare);
+
+private:
+  /**
+   * @brief Remaining part of each range.
+   */
+  std::vector<std::pair<Iter, Iter>> ranges;
+
+  /**
+   * @brief Tournament over the current element of each range.
+   */
+  LoserTree<T, Compare> tree;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Implementation of LoserTree constructor.
+ */
+template <class T, class Compare>
+LoserTree<T, Compare>::LoserTree(size_t k, Compare compare)
+    : compare(compare), heads(k, nullptr), losers(std::max(k, size_t(1)), 0u) {
+}
+
+/*
+ * Implementation of build() function.
+ */
+template <class T, class Compare> void LoserTree<T, Compare>::build() {
+  if (!heads.empty()) {
+    losers[0] = play(1);
+  }
+}
+
+/*
+ * Implementation of private play() helper function.
+ */
+template <class T, class Compare>
+size_t LoserTree<T, Compare>::play(size_t node) {
+  size_t k = heads.size();
+  if (node >= k) {
+    return node - k;
+  }
+  size_t a = play(2 * node), b = play(2 * node + 1);
+  if (beats(a, b)) {
+    losers[node] = b;
+    return a;
+  }
+  losers[node] = a;
+  return b;
+}
+
+/*
+ * Implementation of replace() function.
+ */
+template <class T, class Compare>
+void LoserTree<T, Compare>::replace(const T *pHead) {
+  size_t w = losers[0];
+  heads[w] = pHead;
+
+  // the new head only has to play the losers on the path up to the root
+  for (size_t node = (heads.size() + w) / 2; node > 0u; node /= 2) {
+    if (beats(losers[node], w)) {
+      std::swap(losers[node], w);
+    }
+  }
+  losers[0] = w;
+}
+
+// doctest unit test for LoserTree
+TEST_CASE("testing LoserTree") {
+  // merge every number of random sorted sources up to 20, some of them
+  // empty, and compare to sorting everything at once
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(0, 50);
+  for (size_t k = 1; k <= 20; k++) {
+    std::vector<std::vector<int>> sources(k);
+    std::vector<int> expected;
+    for (std::vector<int> &source : sources) {
+      source.resize(prng() % 30);
+      for (int &x : source) {
+        x = dist(prng);
+      }
+      std::sort(source.begin(), source.end());
+      expected.insert(expected.end(), source.begin(), source.end());
+    }
+    std::sort(expected.begin(), expected.end());
+
+    LoserTree<int, std::less<int>> tree(k, std::less<int>());
+    std::vector<size_t> next(k, 0u);
+    for (size_t i = 0; i < k; i++) {
+      tree.set(i, sources[i].empty() ? nullptr : sources[i].data());
+    }
+    tree.build();
+    std::vector<int> merged;
+    while (!tree.empty()) {
+      size_t w = tree.winner();
+      merged.push_back(tree.top());
+      next[w]++;
+      tree.replace(next[w] < sources[w].size() ? &sources[w][next[w]]
+                                               : nullptr);
+    }
+    CHECK(merged == expected);
+  }
+
+  // ties go to the lower source, so the merge is stable; a three-way
+  // comparator on the first member orders the pairs
+  typedef std::pair<int, size_t> Item;
+  std::vector<std::vector<Item>> items(5);
+  for (size_t i = 0; i < 5; i++) {
+    for (int key = 0; key < 4; key++) {
+      items[i].push_back(Item(key, i));
+    }
+  }
+  auto byKey = [](const Item &a, const Item &b) { return a.first - b.first; };
+  LoserTree<Item, decltype(byKey)> tree(5, byKey);
+  std::vector<size_t> next(5, 0u);
+  for (size_t i = 0; i < 5; i++) {
+    tree.set(i, items[i].data());
+  }
+  tree.build();
+  for (int key = 0; key < 4; key++) {
+    for (size_t i = 0; i < 5; i++) {
+      REQUIRE(!tree.empty());
+      CHECK(key == tree.top().first);
+      CHECK(i == tree.top().second);
+      size_t w = tree.winner();
+      next[w]++;
+      tree.replace(next[w] < 4u ? &items[w][next[w]] : nullptr);
+    }
+  }
+  CHECK(tree.empty());
+
+  // no sources at all
+  LoserTree<int, std::less<int>> none(0, std::less<int>());
+  none.build();
+  CHECK(none.empty());
+}
+
+/*
+ * Implementation of KWayMerge constructor.
+ */
+template <class Iter, class Compare>
+KWayMerge<Iter, Compare>::KWayMerge(const std::pair<Iter, Iter> *pRanges,
+                                    size_t k, Compare compare)
+    : ranges(pRanges, pRanges + k), tree(k, compare) {
+  // the tree points at the iterators' current elements, so the iterators
+  // must stay put from here on
+  for (size_t i = 0u; i < k; i++) {
+    tree.set(i, ranges[i].first == ranges[i].second ? nullptr
+                                                    : &*ranges[i].first);
+  }
+  tree.build();
+}
+
+/*
+ * Implementation of read() function.
+ */
+template <class Iter, class Compare>
+size_t KWayMerge<Iter, Compare>::read(T *pOut, size_t max) {
+  size_t len = 0u;
+  for (; len < max && !tree.empty(); len++) {
+    std::pair<Iter, Iter> &range = ranges[tree.winner()];
+    pOut[len] = tree.top();
+    ++range.first;
+    tree.replace(range.first == range.second ? nullptr : &*range.first);
+  }
+  return len;
+}
+
+/*
+ * Implementation of merge() function.
+ */
+template <class Iter, class Compare>
+template <class OutputIt>
+OutputIt KWayMerge<Iter, Compare>::merge(const std::pair<Iter, Iter> *pRanges,
+                                         size_t k, OutputIt out,
+                                         Compare compare) {
+  KWayMerge merger(pRanges, k, compare);
+  std::vector<T> batch(BATCH);
+  size_t len;
+  while ((len = merger.read(batch.data(), batch.size())) > 0u) {
+    out = std::copy(batch.begin(), batch.begin() + len, out);
+  }
+  return out;
+}
+
+// doctest unit test for KWayMerge
+TEST_CASE("testing KWayMerge") {
+  // random sorted vectors, some empty, merged into one; count the
+  // comparisons, which should be at most ceil(lg k) per element, plus the
+  // k - 1 matches of the first tournament
+  typedef std::vector<int>::const_iterator Iter;
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-1000, 1000);
+  size_t count = 0;
+  auto counting = [&count](const int &a, const int &b) {
+    count++;
+    return a < b;
+  };
+  for (size_t k : {1u, 2u, 3u, 7u, 8u, 33u, 100u}) {
+    std::vector<std::vector<int>> sources(k);
+    std::vector<int> expected;
+    for (std::vector<int> &source : sources) {
+      source.resize(prng() % 1000);
+      for (int &x : source) {
+        x = dist(prng);
+      }
+      std::sort(source.begin(), source.end());
+      expected.insert(expected.end(), source.begin(), source.end());
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<std::pair<Iter, Iter>> ranges;
+    for (const std::vector<int> &source : sources) {
+      ranges.push_back(std::make_pair(source.begin(), source.end()));
+    }
+    std::vector<int> merged;
+    count = 0;
+    KWayMerge<Iter, decltype(counting)>::merge(
+        ranges.data(), k, std::back_inserter(merged), counting);
+    CHECK(merged == expected);
+    size_t levels = 0;
+    while ((size_t(1) << levels) < k) {
+      levels++;
+    }
+    CHECK(count <= expected.size() * levels + k);
+  }
+
+  // streaming: ranges read from streams as the merge goes, output pulled a
+  // few elements at a time, with a three-way comparator for descending
+  // order
+  typedef std::istream_iterator<int> StreamIter;
+  std::istringstream a("9 7 7 3"), b(""), c("8 7 1 0");
+  std::pair<StreamIter, StreamIter> streams[] = {
+      std::make_pair(StreamIter(a), StreamIter()),
+      std::make_pair(StreamIter(b), StreamIter()),
+      std::make_pair(StreamIter(c), StreamIter())};
+  auto descending = [](const int &x, const int &y) { return y - x; };
+  KWayMerge<StreamIter, decltype(descending)> stream(streams, 3, descending);
+  int pOut[3];
+  CHECK(3 == stream.read(pOut, 3));
+  CHECK(9 == pOut[0]);
+  CHECK(8 == pOut[1]);
+  CHECK(7 == pOut[2]);
+  CHECK(3 == stream.read(pOut, 3));
+  CHECK(7 == pOut[0]);
+  CHECK(7 == pOut[1]);
+  CHECK(3 == pOut[2]);
+  CHECK(!stream.empty());
+  CHECK(2 == stream.read(pOut, 3));
+  CHECK(1 == pOut[0]);
+  CHECK(0 == pOut[1]);
+  CHECK(stream.empty());
+  CHECK(0 == stream.read(pOut, 3));
+
+  // stability across batches: equal keys come out in range order
+  typedef std::pair<int, size_t> Item;
+  typedef std::vector<Item>::const_iterator ItemIter;
+  std::vector<std::vector<Item>> items(4);
+  for (size_t i = 0; i < 4; i++) {
+    for (int key = 0; key < 300; key++) {
+      items[i].push_back(Item(key / 100, i));
+    }
+  }
+  std::vector<std::pair<ItemIter, ItemIter>> itemRanges;
+  for (const std::vector<Item> &v : items) {
+    itemRanges.push_back(std::make_pair(v.begin(), v.end()));
+  }
+  auto byKey = [](const Item &x, const Item &y) { return x.first < y.first; };
+  std::vector<Item> out(1200);
+  auto end = KWayMerge<ItemIter, decltype(byKey)>::merge(
+      itemRanges.data(), 4, out.begin(), byKey);
+  CHECK(end == out.end());
+  for (size_t i = 0; i < out.size(); i++) {
+    CHECK(int(i / 400) == out[i].first);
+    CHECK(i % 400 / 100 == out[i].second);
+  }
+
+  // no ranges at all
+  std::vector<int> none;
+  KWayMerge<Iter, std::less<int>>::merge(nullptr, 0,
+                                         std::back_inserter(none),
+                                         std::less<int>());
+  CHECK(none.empty());
+}
@@ -0,0 +1,4 @@
+// phantom C++ file for ParallelSort unit testing. This file only inlcudes the 
+// ParallelSort header; doctest generates the testing program based on unit 
+// tests written alongside the code in the header file
+#include "ParallelSort.hpp"
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <algorithm>
+#include <ctime>
+#include <doctest.h>
+#include <functional>
+#include <future>
+#include <random>
+#include <vector>
+#include "SearchNSort.hpp"
+#include "ThreadPool.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Parallel versions of the SearchNSort merge sort and quicksort.
+ *
+ * Both sorts split their work recursively. Above a grain size, one half of
+ * each split is submitted to a work-stealing ThreadPool while the current
+ * thread carries on with the other half; idle workers steal the oldest, and
+ * so largest, pending halves. Below the grain size the sequential
+ * SearchNSort code takes over. A task waiting for its other half runs
+ * queued tasks in the meantime (ThreadPool::wait()), so deep recursion
+ * never leaves the pool without free workers.
+ *
+ * Merge sort also merges in parallel. To merge two sorted runs, the middle
+ * element of the longer run is located in the shorter run by binary search,
+ * which splits the merge into two independent merges of about half the
+ * size. Merge sort therefore scales with the number of cores all the way
+ * up. Quicksort's partitioning passes are sequential, so its first few
+ * levels limit how far it scales.
+ *
+ * Comparators are the same as for SearchNSort. The pool may be shared with
+ * other work, but a sort must not be started from one of the pool's own
+ * tasks unless that task waits with ThreadPool::wait().
+ */
+template <class T> class ParallelSort {
+public:
+  /**
+   * @brief Ranges this small are sorted, or merged, by a single task.
+   */
+  static const size_t GRAIN = 1u << 14;
+
+  /**
+   * @brief Sort an array using parallel merge sort. The sort is stable.
+   *
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
+   * @param compare Comparator used to compare two elements; see
+   * SearchNSort.
+   * @param pool Pool whose workers do the sorting.
+   */
+  template <class Compare>
+  static void mergeSort(T *pArr, size_t n, Compare compare, ThreadPool &pool);
+
+  /**
+   * @brief Sort an array using parallel quicksort. Partitioning is done as
+   * in SearchNSort::introSort(), so the sort takes O(n lg n) time on every
+   * input.
+   *
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
+   * @param compare Comparator used to compare two elements; see
+   * SearchNSort.
+   * @param pool Pool whose workers do the sorting.
+   */
+  template <class Compare>
+  static void quickSort(T *pArr, size_t n, Compare compare, ThreadPool &pool);
+
+private:
+  /**
+   * @brief Merge sort pSrc[0, n), leaving the result in pDst if toDst is
+   * true and in pSrc otherwise. The other array is used as scratch.
+   */
+  template <class Compare>
+  static void mergeSort(T *pSrc, T *pDst, size_t n, bool toDst,
+                        Compare &compare, ThreadPool &pool);
+
+  /**
+   * @brief Stably merge sorted runs pA[0, na) and pB[0, nb) into pOut,
+   * splitting large merges in two.
+   */
+  template <class Compare>
+  static void merge(const T *pA, size_t na, const T *pB, size_t nb, T *pOut,
+                    Compare &compare, ThreadPool &pool);
+
+  /**
+   * @brief Quicksort pArr[lo, hi), handing one side of each large
+   * partition to the pool.
+   */
+  template <class Compare>
+  static void quickSort(T *pArr, size_t lo, size_t hi, size_t depth,
+                        Compare &compare, ThreadPool &pool);
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Implementation of private merge() helper function.
+ */
+template <class T>
+template <class Compare>
+void ParallelSort<T>::merge(const T *pA, size_t na, const T *pB, size_t nb,
+                            T *pOut, Compare &compare, ThreadPool &pool) {
+
+  auto less = [&compare](const T &x, const T &y) {
+    return SearchNSort<T>::before(compare, x, y);
+  };
+
+  // small merges run sequentially; ties go to pA, which keeps them stable
+  if (na + nb <= GRAIN) {
+    size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+      pOut[k++] = less(pB[j], pA[i]) ? pB[j++] : pA[i++];
+    }
+    std::copy(pA + i, pA + na, pOut + k);
+    std::copy(pB + j, pB + nb, pOut + k + (na - i));
+    return;
+  }
+
+  // split at the middle of the longer run, and find where that element
+  // falls in the other; elements of pA equal to the split element must end
+  // up left of equal elements of pB
+  size_t ma, mb;
+  if (na >= nb) {
+    ma = na / 2;
+    mb = std::lower_bound(pB, pB + nb, pA[ma], less) - pB;
+  } else {
+    mb = nb / 2;
+    ma = std::upper_bound(pA, pA + na, pB[mb], less) - pA;
+  }
+
+  std::future<void> left = pool.submit([=, &compare, &pool](size_t) {
+    merge(pA, ma, pB, mb, pOut, compare, pool);
+  });
+  merge(pA + ma, na - ma, pB + mb, nb - mb, pOut + ma + mb, compare, pool);
+  pool.wait(left);
+}
+
+/*
+ * Implementation of public mergeSort() function.
+ */
+template <class T>
+template <class Compare>
+void ParallelSort<T>::mergeSort(T *pArr, size_t n, Compare compare,
+                                ThreadPool &pool) {
+  // create temporary array
+  T *pB = new T[n];
+
+  // run the sort on the pool, so all of the waiting happens on workers
+  std::future<void> done = pool.submit([=, &compare, &pool](size_t) {
+    mergeSort(pArr, pB, n, false, compare, pool);
+  });
+  pool.wait(done);
+
+  // free temporary array
+  delete[] pB;
+}
+
+/*
+ * Implementation of private mergeSort() helper function.
+ */
+template <class T>
+template <class Compare>
+void ParallelSort<T>::mergeSort(T *pSrc, T *pDst, size_t n, bool toDst,
+                                Compare &compare, ThreadPool &pool) {
+
+  if (n <= GRAIN) {
+    SearchNSort<T>::mergeSort(pSrc, pDst, 0, n, compare);
+    if (toDst) {
+      std::copy(pSrc, pSrc + n, pDst);
+    }
+    return;
+  }
+
+  // sort each half into the array the merge reads from, so the merge can
+  // write straight into the one the result belongs in
+  size_t half = n / 2;
+  std::future<void> left = pool.submit([=, &compare, &pool](size_t) {
+    mergeSort(pSrc, pDst, half, !toDst, compare, pool);
+  });
+  mergeSort(pSrc + half, pDst + half, n - half, !toDst, compare, pool);
+  pool.wait(left);
+
+  const T *pIn = toDst ? pSrc : pDst;
+  T *pOut = toDst ? pDst : pSrc;
+  merge(pIn, half, pIn + half, n - half, pOut, compare, pool);
+}
+
+// doctest unit test for ParallelSort::mergeSort
+TEST_CASE("testing ParallelSort::mergeSort") {
+  ThreadPool pool(4);
+
+  // big enough to split several times
+  const size_t n = 20 * ParallelSort<int>::GRAIN + 123;
+  std::vector<int> pA(n), pB;
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100000, 100000);
+  for(size_t i = 0; i < n; i++) {
+    pA[i] = dist(prng);
+  }
+  pB = pA;
+
+  ParallelSort<int>::mergeSort(pA.data(), n, std::less<int>(), pool);
+  std::sort(pB.begin(), pB.end());
+  CHECK(pA == pB);
+
+  // stability: sort (key, original index) pairs by key alone, with few keys
+  // so the parallel merges split inside runs of equal keys
+  std::vector<std::pair<int, size_t>> pairs(n), expected;
+  std::uniform_int_distribution<int> few(0, 9);
+  for(size_t i = 0; i < n; i++) {
+    pairs[i] = std::make_pair(few(prng), i);
+  }
+  expected = pairs;
+  std::stable_sort(expected.begin(), expected.end(),
+                   [](const std::pair<int, size_t> &a,
+                      const std::pair<int, size_t> &b) {
+                     return a.first < b.first;
+                   });
+  ParallelSort<std::pair<int, size_t>>::mergeSort(pairs.data(), n,
+      [](const std::pair<int, size_t> &a, const std::pair<int, size_t> &b) {
+        return a.first - b.first;
+      }, pool);
+  CHECK(pairs == expected);
+
+  // small arrays are sorted by one task
+  int pC[] = {3, 1, 2};
+  ParallelSort<int>::mergeSort(pC, 3, std::less<int>(), pool);
+  CHECK((1 == pC[0] && 2 == pC[1] && 3 == pC[2]));
+  ParallelSort<int>::mergeSort(pC, 0, std::less<int>(), pool);
+}
+
+/*
+ * Implementation of public quickSort() function.
+ */
+template <class T>
+template <class Compare>
+void ParallelSort<T>::quickSort(T *pArr, size_t n, Compare compare,
+                                ThreadPool &pool) {
+  std::future<void> done = pool.submit([=, &compare, &pool](size_t) {
+    quickSort(pArr, 0, n, SearchNSort<T>::depthLimit(n), compare, pool);
+  });
+  pool.wait(done);
+}
+
+/*
+ * Implementation of private quickSort() helper function.
+ */
+template <class T>
+template <class Compare>
+void ParallelSort<T>::quickSort(T *pArr, size_t lo, size_t hi, size_t depth,
+                                Compare &compare, ThreadPool &pool) {
+
+  std::vector<std::future<void>> parts;
+  while (hi - lo > GRAIN) {
+    if (depth == 0u) {
+      SearchNSort<T>::heapSort(pArr + lo, hi - lo, compare);
+      break;
+    }
+    depth--;
+
+    std::swap(pArr[lo],
+              pArr[SearchNSort<T>::choosePivot(pArr, lo, hi, compare)]);
+    size_t p = SearchNSort<T>::partition(pArr, lo, hi - 1, compare) + 1;
+
+    // hand the smaller side to the pool and keep partitioning the larger
+    size_t subLo = lo, subHi = p;
+    if (p - lo < hi - p) {
+      lo = p;
+    } else {
+      subLo = p;
+      subHi = hi;
+      hi = p;
+    }
+    parts.push_back(pool.submit([=, &compare, &pool](size_t) {
+      quickSort(pArr, subLo, subHi, depth, compare, pool);
+    }));
+  }
+  if (hi - lo <= GRAIN) {
+    SearchNSort<T>::introSort(pArr, lo, hi, depth, compare);
+  }
+
+  for (std::future<void> &f : parts) {
+    pool.wait(f);
+  }
+}
+
+// doctest unit test for ParallelSort::quickSort
+TEST_CASE("testing ParallelSort::quickSort") {
+  ThreadPool pool(4);
+
+  const size_t n = 20 * ParallelSort<int>::GRAIN + 123;
+  std::vector<int> pA(n), pB;
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100000, 100000);
+  for(size_t i = 0; i < n; i++) {
+    pA[i] = dist(prng);
+  }
+  pB = pA;
+
+  ParallelSort<int>::quickSort(pA.data(), n, std::less<int>(), pool);
+  std::sort(pB.begin(), pB.end());
+  CHECK(pA == pB);
+
+  // sorted, reversed, and all-equal input
+  for(size_t i = 0; i < n; i++) {
+    pA[i] = n - i;
+  }
+  ParallelSort<int>::quickSort(pA.data(), n, std::less<int>(), pool);
+  CHECK(std::is_sorted(pA.begin(), pA.end()));
+  ParallelSort<int>::quickSort(pA.data(), n, std::greater<int>(), pool);
+  CHECK(std::is_sorted(pA.rbegin(), pA.rend()));
+  std::fill(pA.begin(), pA.end(), 7);
+  ParallelSort<int>::quickSort(pA.data(), n, std::less<int>(), pool);
+  CHECK(std::count(pA.begin(), pA.end(), 7) == (long)n);
+
+  // the function-pointer comparators work too
+  SearchNSort<int>::CompareFn fn = [](const int &a, const int &b) {
+    return a - b;
+  };
+  for(size_t i = 0; i < n; i++) {
+    pA[i] = pB[i] = dist(prng);
+  }
+  ParallelSort<int>::quickSort(pA.data(), n, fn, pool);
+  std::sort(pB.begin(), pB.end());
+  CHECK(pA == pB);
+}
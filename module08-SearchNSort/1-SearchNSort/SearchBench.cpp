@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <vector>
+#include "EytzingerIndex.hpp"
+#include "SearchNSort.hpp"
+
+/**
+ * @brief Time a search method over a batch of keys.
+ *
+ * @param keys Keys to look up
+ *
+ * @param search Callable taking a key and returning the index where it
+ * was found or belongs
+ *
+ * @param checksum Incremented by every index returned, so the searches
+ * cannot be optimized away and different methods can be cross-checked
+ *
+ * @return Mean time per lookup in nanoseconds
+ */
+template <class Search>
+double timeSearch(const std::vector<int> &keys, Search search,
+    size_t &checksum) {
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    for(int key : keys) {
+        checksum += search(key);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end -
+        begin).count() / double(keys.size());
+}
+
+/**
+ * @brief Time a batch search method over a batch of keys.
+ *
+ * @param keys Keys to look up
+ *
+ * @param batch Callable taking the keys and an array to fill with the index
+ * where each was found or belongs
+ *
+ * @param checksum Incremented by every index returned
+ *
+ * @return Mean time per lookup in nanoseconds
+ */
+template <class Batch>
+double timeBatch(const std::vector<int> &keys, Batch batch,
+    size_t &checksum) {
+
+    std::vector<size_t> out(keys.size());
+    auto begin = std::chrono::high_resolution_clock::now();
+    batch(keys, out.data());
+    auto end = std::chrono::high_resolution_clock::now();
+
+    for(size_t i : out) {
+        checksum += i;
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end -
+        begin).count() / double(keys.size());
+}
+
+/**
+ * @brief Application entry point.
+ *
+ * Times lookups of random keys, about half of them present, in sorted
+ * arrays of ints from 2^10 to 2^maxPower elements: the original
+ * binarySearch, the branchless lowerBound, batchLowerBound, an
+ * EytzingerIndex, interpolationSearch, and std::lower_bound for reference.
+ * The keys are evenly spread, the best case for interpolation search.
+ *
+ * A second table times linear searches of unsorted arrays from 2^4 to
+ * 2^12 elements: linearSearch with a comparator, the SIMD operator==
+ * linearSearch, std::find, and the SIMD countMatches, which always scans
+ * the whole array.
+ *
+ * @param argc Number of command-line arguments
+ *
+ * @param ppszArgs Array of command-line argument strings
+ */
+int main(int argc, char **ppszArgs) {
+    // command-line argument sanity check
+    if(argc < 2) {
+        fprintf(stderr, "Usage: ./SearchBench maxPower [numLookups]\n");
+        return EXIT_FAILURE;
+    }
+    int powerCap = atoi(ppszArgs[1]);
+    size_t numLookups = argc > 2 ? atol(ppszArgs[2]) : 1000000;
+
+    std::mt19937_64 prng(time(0));
+    auto less = [](const int &x, const int &y) { return x < y; };
+
+    printf("%10s,%12s,%12s,%12s,%12s,%12s,%12s\n", "n", "binary", 
+        "lowerBound", "batch", "eytzinger", "interp", "std");
+    for(int power = 10; power <= powerCap; power++) {
+        // even keys, so odd lookups miss
+        size_t n = size_t(1) << power;
+        std::vector<int> arr(n);
+        for(size_t i = 0; i < n; i++) {
+            arr[i] = 2 * int(i);
+        }
+        EytzingerIndex<int> index(arr.data(), n);
+
+        std::uniform_int_distribution<int> dist(0, int(2 * n));
+        std::vector<int> keys(numLookups);
+        for(int &key : keys) {
+            key = dist(prng);
+        }
+
+        size_t sums[6] = {0, 0, 0, 0, 0, 0};
+        double pDur[] = {
+            timeSearch(keys, [&](int key) {
+                int i = SearchNSort<int>::binarySearch(arr.data(), n, key,
+                    less);
+                return i < 0 ? (key + 1) / 2 : i;
+            }, sums[0]),
+            timeSearch(keys, [&](int key) {
+                return SearchNSort<int>::lowerBound(arr.data(), n, key,
+                    less).index;
+            }, sums[1]),
+            timeBatch(keys, [&](const std::vector<int> &k, size_t *pOut) {
+                SearchNSort<int>::batchLowerBound(arr.data(), n, k.data(),
+                    k.size(), pOut, less);
+            }, sums[2]),
+            timeSearch(keys, [&](int key) {
+                return index.lowerBound(key, less).index;
+            }, sums[3]),
+            timeSearch(keys, [&](int key) {
+                return SearchNSort<int>::interpolationSearch(arr.data(), n,
+                    key).index;
+            }, sums[4]),
+            timeSearch(keys, [&](int key) {
+                return size_t(std::lower_bound(arr.begin(), arr.end(), key) -
+                    arr.begin());
+            }, sums[5])
+        };
+
+        if(!std::all_of(sums, sums + 5, [&](size_t s) {
+            return s == sums[5];
+        })) {
+            fprintf(stderr, "\nSEARCH FAILURE!\n");
+            return EXIT_FAILURE;
+        }
+        printf("%10zu", n);
+        for(double dur : pDur) {
+            printf(", %0.5E", dur);
+        }
+        printf("\n");
+    }
+
+    printf("\n%10s,%12s,%12s,%12s,%12s\n", "n", "linear", "linearEq",
+        "find", "count");
+    for(int power = 4; power <= 12; power++) {
+        size_t n = size_t(1) << power;
+        std::uniform_int_distribution<int> dist(0, int(2 * n));
+        std::vector<int> arr(n);
+        for(int &x : arr) {
+            x = dist(prng);
+        }
+        std::vector<int> keys(numLookups / n + 1000);
+        for(int &key : keys) {
+            key = dist(prng);
+        }
+
+        auto eq = [](const int &x, const int &y) { return x - y; };
+        auto index = [&](int i) { return size_t(i < 0 ? n : i); };
+        size_t sums[4] = {0, 0, 0, 0};
+        double pDur[] = {
+            timeSearch(keys, [&](int key) {
+                return index(SearchNSort<int>::linearSearch(arr.data(), n,
+                    key, eq));
+            }, sums[0]),
+            timeSearch(keys, [&](int key) {
+                return index(SearchNSort<int>::linearSearch(arr.data(), n,
+                    key));
+            }, sums[1]),
+            timeSearch(keys, [&](int key) {
+                return size_t(std::find(arr.begin(), arr.end(), key) -
+                    arr.begin());
+            }, sums[2]),
+            timeSearch(keys, [&](int key) {
+                return SearchNSort<int>::countMatches(arr.data(), n, key);
+            }, sums[3])
+        };
+
+        if(sums[0] != sums[2] || sums[1] != sums[2]) {
+            fprintf(stderr, "\nSEARCH FAILURE!\n");
+            return EXIT_FAILURE;
+        }
+        printf("%10zu", n);
+        for(double dur : pDur) {
+            printf(", %0.5E", dur);
+        }
+        printf("\n");
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,28 +1,158 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <ctime>
 #include <doctest.h>
+#include <functional>
+#include <limits>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
+#include "SortingNetwork.hpp"
 
 /*-----------------------------------------------------------------------------
- * class definition
+ * class definitions
  *---------------------------------------------------------------------------*/
 
+/**
+ * @brief Result of a search that reports where a key belongs as well as
+ * whether it is there.
+ */
+struct SearchResult {
+  /**
+   * @brief Index of the first element not less than the key: where the key
+   * is if found, and where it would be inserted otherwise. Equals the
+   * number of elements if every element is less than the key.
+   */
+  size_t index;
+
+  /**
+   * @brief True if the element at index is equal to the key.
+   */
+  bool found;
+};
+
 /**
  * @brief CMP 246 Module 8 templated class with searching and sorting methods.
  * 
  * This class provides a series of static methods for the following operations:
  * 
- * - searches: linearSearch and binarySearch
+ * - searches: linearSearch, countMatches, binarySearch, the branchless
+ *   lowerBound, batchLowerBound for many keys at once, exponentialSearch,
+ *   and interpolationSearch for numeric keys
  * 
  * - quadratic sorts: bubbleSort, insertionSort, selectionSort
  * 
- * - n lg n sorts: mergeSort, quickSort
+ * - n lg n sorts: bottomUpMergeSort, heapSort, introSort, mergeSort, 
+ *   quickSort, threeWayQuickSort, and timSort, which is linear on input
+ *   that is already mostly in order
+ * 
+ * - linear-time sorts for numeric keys: radixSort
+ * 
+ * - string sorts, which skip prefixes already known to be equal:
+ *   msdRadixSort, multikeyQuickSort
+ * 
+ * - selection: nthElement, and partialSort for the k smallest elements in
+ *   order; TopK does the same for a stream
+ * 
+ * - indirect sorting of large records: argSort, permute, and sortByKey
+ * 
+ * Every method takes the comparator as a template parameter, so a lambda or
+ * function object is called directly and can be inlined into the algorithm.
+ * A comparator may work like a C qsort() comparator, returning a negative
+ * value if x < y, zero if x == y, or positive if x > y; or it may work like
+ * std::less, returning the bool x < y. Overloads taking a plain function
+ * pointer are kept for existing callers.
+ * 
+ * When T is a number type and the comparator is std::less<T>, the
+ * recursive sorts finish small ranges with a SortingNetwork instead of
+ * insertion sort, or instead of recursing down to single elements.
  */
 template <class T> class SearchNSort {
 public:
+  /**
+   * @brief Type of the function-pointer comparators taken by the original 
+   * overloads.
+   */
+  typedef int (*CompareFn)(const T &x, const T &y);
+
+  /**
+   * @brief Number of searches batchLowerBound() advances in lock-step.
+   */
+  static const size_t BATCH_SIZE = 16;
+
+  /**
+   * @brief Find the order that sorts an array, without moving its elements.
+   * 
+   * The key of each element is copied, with its index, into a compact
+   * array of (key, index) pairs, and only that array is sorted, with
+   * introSort(). Elements with equal keys keep their original order, so
+   * the result is a stable sort. Pass the result to permute() to rearrange
+   * the array itself.
+   * 
+   * @param pArr Pointer to the first element of the array.
+   * @param n Size of the array.
+   * @param pOrder Pointer to an array of n indices, filled so that
+   * pArr[pOrder[0]], pArr[pOrder[1]], ... is sorted.
+   * @param keyOf Function object taking an element and returning its key,
+   * which should be small and cheap to copy.
+   * @param compare Comparator used to compare two keys; see the class 
+   * description.
+   */
+  template <class KeyOf, class Compare>
+  static void argSort(const T *pArr, size_t n, size_t *pOrder, KeyOf keyOf,
+                      Compare compare);
+
+  /**
+   * @brief argSort() comparing keys with operator<.
+   */
+  template <class KeyOf>
+  static void argSort(const T *pArr, size_t n, size_t *pOrder, KeyOf keyOf) {
+    argSort(pArr, n, pOrder, keyOf,
+            std::less<typename std::decay<decltype(keyOf(*pArr))>::type>());
+  }
+
+  /**
+   * @brief Find where each of many keys is, or belongs, in a sorted array.
+   * 
+   * Looking keys up one at a time in a large array waits on a cache miss at
+   * almost every step. This method runs the branchless search of
+   * lowerBound() on BATCH_SIZE keys at once: every search takes one step,
+   * then prefetches the element it will probe next, and by the time all
+   * the others have taken their step, that element is on its way from
+   * memory. The misses of the batch overlap instead of following one
+   * another.
+   * 
+   * @param pArr Pointer to the first element of the array to search. The array
+   * must be sorted in ascending order.
+   * @param n Number of elements in the array.
+   * @param pKeys Pointer to the first of the keys to search for.
+   * @param numKeys Number of keys.
+   * @param pOut Pointer to an array of numKeys indices; pOut[i] is set to
+   * the index of the first element not less than pKeys[i], or n if there
+   * is none.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void batchLowerBound(const T *pArr, size_t n, const T *pKeys,
+                              size_t numKeys, size_t *pOut, Compare compare);
+
+  /**
+   * @brief Function-pointer version of batchLowerBound().
+   */
+  static void batchLowerBound(const T *pArr, size_t n, const T *pKeys,
+                              size_t numKeys, size_t *pOut,
+                              CompareFn compare) {
+    batchLowerBound<CompareFn>(pArr, n, pKeys, numKeys, pOut, compare);
+  }
+
   /**
    * @brief Perform a binary search on an array.
    * 
@@ -30,38 +160,216 @@ public:
    * must be sorted in ascending order.
    * @param n Number of elements in the array.
    * @param key Key value to search for
-   * @param compare Pointer to a function used to compare two elements. This 
-   * must return a negative value if x < y, zero if x == y, or positive if 
-   * x > y.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
    * @return int Index of an occurrence of key in pArr, or -1 if the key 
    * was not found in the array.
    */
+  template <class Compare>
+  static int binarySearch(const T *pArr, size_t n, const T &key,
+                          Compare compare);
+
+  /**
+   * @brief Function-pointer version of binarySearch().
+   */
   static int binarySearch(const T *pArr, size_t n, const T &key,
-                          int (*compare)(const T &x, const T &y));
+                          CompareFn compare) {
+    return binarySearch<CompareFn>(pArr, n, key, compare);
+  }
+
+  /**
+   * @brief Sort an array using a non-recursive merge sort.
+   * 
+   * mergeSort() merges into a scratch array and copies the result back at
+   * every level of recursion, moving each element twice per level. This
+   * version first insertion sorts runs of RUN_SIZE elements, then merges
+   * runs of doubling width in passes over the whole array, each pass 
+   * reading from one of the two arrays and writing to the other. Each 
+   * element moves once per pass, and at most one final copy is needed if 
+   * the last pass ends in the scratch array. The sort is stable.
+   * 
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void bottomUpMergeSort(T *pArr, size_t n, Compare compare);
+
+  /**
+   * @brief Function-pointer version of bottomUpMergeSort().
+   */
+  static void bottomUpMergeSort(T *pArr, size_t n, CompareFn compare) {
+    bottomUpMergeSort<CompareFn>(pArr, n, compare);
+  }
 
   /**
    * @brief Sort an array using the bubble sort algorithm.
    * 
    * @param pArr Pointer to the first element of the array to search.
    * @param n Size of the array.
-   * @param compare Pointer to a function used to compare two elements. This 
-   * must return a negative value if x < y, zero if x == y, or positive if 
-   * x > y.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void bubbleSort(T *pArr, size_t n, Compare compare);
+
+  /**
+   * @brief Function-pointer version of bubbleSort().
+   */
+  static void bubbleSort(T *pArr, size_t n, CompareFn compare) {
+    bubbleSort<CompareFn>(pArr, n, compare);
+  }
+
+  /**
+   * @brief Find where a key is, or belongs, in a sorted array by galloping
+   * out from a known position.
+   * 
+   * Starting at hint, the search probes 1, 2, 4, 8, ... elements away, in
+   * whichever direction the key lies, until it passes the key, and then
+   * binary searches the last gap. A key d elements from the hint takes
+   * O(lg d) comparisons, however large the array, so this is the search to
+   * use when the answer is probably near a known position, such as just
+   * after the previous answer when looking up keys in increasing order, or
+   * near the front of a very large array.
+   * 
+   * @param pArr Pointer to the first element of the array to search. The array
+   * must be sorted in ascending order.
+   * @param n Number of elements in the array.
+   * @param key Key value to search for
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   * @param hint Index to start from; values past the end of the array
+   * start from the end.
+   * @return SearchResult Index of the first element not less than key, and
+   * whether that element equals key.
+   */
+  template <class Compare>
+  static SearchResult exponentialSearch(const T *pArr, size_t n,
+                                        const T &key, Compare compare,
+                                        size_t hint = 0);
+
+  /**
+   * @brief Function-pointer version of exponentialSearch().
+   */
+  static SearchResult exponentialSearch(const T *pArr, size_t n,
+                                        const T &key, CompareFn compare,
+                                        size_t hint = 0) {
+    return exponentialSearch<CompareFn>(pArr, n, key, compare, hint);
+  }
+
+  /**
+   * @brief Sort an array using the heapsort algorithm.
+   * 
+   * Heapsort takes O(n lg n) time on every input and needs no extra memory,
+   * though on random data it is slower than quicksort.
+   * 
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void heapSort(T *pArr, size_t n, Compare compare);
+
+  /**
+   * @brief Function-pointer version of heapSort().
    */
-  static void bubbleSort(T *pArr, size_t n,
-                         int (*compare)(const T &x, const T &y));
+  static void heapSort(T *pArr, size_t n, CompareFn compare) {
+    heapSort<CompareFn>(pArr, n, compare);
+  }
 
   /**
    * @brief Sort an array using the insertion sort algorithm.
    * 
    * @param pArr Pointer to the first element of the array to search.
    * @param n Size of the array.
-   * @param compare Pointer to a function used to compare two elements. This 
-   * must return a negative value if x < y, zero if x == y, or positive if 
-   * x > y.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void insertionSort(T *pArr, size_t n, Compare compare);
+
+  /**
+   * @brief Function-pointer version of insertionSort().
+   */
+  static void insertionSort(T *pArr, size_t n, CompareFn compare) {
+    insertionSort<CompareFn>(pArr, n, compare);
+  }
+
+  /**
+   * @brief Find where a number is, or belongs, in a sorted array of numbers
+   * using interpolation search.
+   * 
+   * T must be a number type. See the key-extractor version for details.
+   * 
+   * @param pArr Pointer to the first element of the array to search. The array
+   * must be sorted in ascending order.
+   * @param n Number of elements in the array.
+   * @param key Key value to search for
+   * @return SearchResult Index of the first element not less than key, and
+   * whether that element equals key.
+   */
+  static SearchResult interpolationSearch(const T *pArr, size_t n,
+                                          const T &key) {
+    return interpolationSearch(pArr, n, key, [](const T &x) { return x; });
+  }
+
+  /**
+   * @brief Find where a key is, or belongs, in an array sorted by numeric
+   * keys using interpolation search.
+   * 
+   * Rather than probing the middle of the range, each step probes where the
+   * key would be if the keys were spread evenly between the first and last
+   * elements of the range, the way one looks up a name in a phone book. On
+   * keys that are close to uniformly distributed, such as timestamps, hash
+   * values, or the PA08 doubles, that takes O(lg lg n) probes instead of
+   * O(lg n). On skewed keys interpolation can crawl, so any probe that
+   * fails to at least halve the range is followed by a binary search step;
+   * that keeps the worst case at O(lg n) probes. Small ranges are finished
+   * by lowerBound(). Probe positions are estimated in double, but keys are
+   * only ever compared in their own type, so 64-bit integer keys too large
+   * to be exact as doubles are still found correctly.
+   * 
+   * @param pArr Pointer to the first element of the array to search. The
+   * array must be sorted in ascending order of key.
+   * @param n Number of elements in the array.
+   * @param key Key value to search for
+   * @param keyOf Function object taking an element and returning its key,
+   * of any number type.
+   * @return SearchResult Index of the first element whose key is not less
+   * than key's, and whether that element's key equals key's.
+   */
+  template <class KeyOf>
+  static SearchResult interpolationSearch(const T *pArr, size_t n,
+                                          const T &key, KeyOf keyOf);
+
+  /**
+   * @brief Sort an array using the introsort algorithm.
+   * 
+   * Introsort is quicksort with three safeguards. The pivot is the median of
+   * three elements, or of three such medians on large ranges, so sorted and
+   * reverse-sorted input split evenly. Ranges of INSERTION_CUTOFF or fewer 
+   * elements are left to insertion sort, or NETWORK_CUTOFF or fewer to a
+   * sorting network when one applies. Recursion goes into the smaller
+   * side of each partition only, and if the partitions keep coming out
+   * lopsided anyway the range is finished with heapsort. The result is
+   * O(n lg n) time and O(lg n) stack depth on every input.
+   * 
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
    */
-  static void insertionSort(T *pArr, size_t n,
-                            int (*compare)(const T &x, const T &y));
+  template <class Compare>
+  static void introSort(T *pArr, size_t n, Compare compare);
+
+  /**
+   * @brief Function-pointer version of introSort().
+   */
+  static void introSort(T *pArr, size_t n, CompareFn compare) {
+    introSort<CompareFn>(pArr, n, compare);
+  }
 
   /**
    * @brief Perform a linear search on an array.
@@ -69,186 +377,2657 @@ public:
    * @param pArr Pointer to the first element of the array to search.
    * @param n Number of elements in the array.
    * @param key Key value to search for
-   * @param compare Pointer to a function used to compare two elements. This 
-   * must return a negative value if x < y, zero if x == y, or positive if 
-   * x > y.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
    * @return int Index of the first occurrence of key in pArr, or -1 if the key
    * was not found in the array.
    */
+  template <class Compare>
   static int linearSearch(const T *pArr, size_t n, const T &key,
-                          int (*compare)(const T &x, const T &y));
+                          Compare compare);
 
   /**
-   * @brief Sort an array using the merge sort algorithm.
+   * @brief Function-pointer version of linearSearch().
+   */
+  static int linearSearch(const T *pArr, size_t n, const T &key,
+                          CompareFn compare) {
+    return linearSearch<CompareFn>(pArr, n, key, compare);
+  }
+
+  /**
+   * @brief Perform a linear search on an array, using operator==.
+   * 
+   * For int, float, and double arrays, when the compiler targets AVX2 or
+   * SSE4.1, each instruction compares a whole SIMD register of elements,
+   * and the loop checks LINEAR_UNROLL registers at a time with a single
+   * branch, turning the matches into a bit mask to find the first one. Any
+   * other type is searched one element at a time. Floating-point elements
+   * are compared the same way operator== would: -0.0 matches 0.0, and NaN
+   * matches nothing.
    * 
    * @param pArr Pointer to the first element of the array to search.
-   * @param n Size of the array.
-   * @param compare Pointer to a function used to compare two elements. This 
-   * must return a negative value if x < y, zero if x == y, or positive if 
-   * x > y.
+   * @param n Number of elements in the array.
+   * @param key Key value to search for
+   * @return int Index of the first occurrence of key in pArr, or -1 if the key
+   * was not found in the array.
    */
-  static void mergeSort(T *pArr, size_t n,
-                        int (*compare)(const T &x, const T &y));
+  static int linearSearch(const T *pArr, size_t n, const T &key);
 
   /**
-   * @brief Sort an array using the quicksort algorithm.
+   * @brief Count the elements of an array equal to a key.
    * 
    * @param pArr Pointer to the first element of the array to search.
-   * @param n Size of the array.
-   * @param compare Pointer to a function used to compare two elements. This 
-   * must return a negative value if x < y, zero if x == y, or positive if 
-   * x > y.
+   * @param n Number of elements in the array.
+   * @param key Key value to count
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   * @return size_t Number of elements neither less nor greater than key.
    */
-  static void quickSort(T *pArr, size_t n,
-                        int (*compare)(const T &x, const T &y)) {
+  template <class Compare>
+  static size_t countMatches(const T *pArr, size_t n, const T &key,
+                             Compare compare);
 
-    quickSort(pArr, 0, n - 1, compare);
+  /**
+   * @brief Function-pointer version of countMatches().
+   */
+  static size_t countMatches(const T *pArr, size_t n, const T &key,
+                             CompareFn compare) {
+    return countMatches<CompareFn>(pArr, n, key, compare);
   }
 
   /**
-   * @brief Sort an array using the selection sort algorithm.
+   * @brief Count the elements of an array equal to a key, using
+   * operator==, with SIMD comparisons for the same types as the
+   * operator== version of linearSearch().
    * 
    * @param pArr Pointer to the first element of the array to search.
-   * @param n Size of the array.
-   * @param compare Pointer to a function used to compare two elements. This 
-   * must return a negative value if x < y, zero if x == y, or positive if 
-   * x > y.
+   * @param n Number of elements in the array.
+   * @param key Key value to count
+   * @return size_t Number of elements equal to key.
    */
-  static void selectionSort(T *pArr, size_t n,
-                            int (*compare)(const T &x, const T &y));
+  static size_t countMatches(const T *pArr, size_t n, const T &key);
 
-private:
   /**
-   * @brief Merge two sorted portions of an array together.
+   * @brief Find where a key is, or belongs, in a sorted array.
    * 
-   * @param pA Array containing two sorted portions
-   * @param pB Scratch array destination
-   * @param left left index of left sorted portion
-   * @param right one past right index of right sorted portion
-   * @param mid start of right sorted portion
-   * @param compare Pointer to a function used to compare two elements. This 
-   * must return a negative value if x < y, zero if x == y, or positive if 
-   * x > y.
+   * Unlike binarySearch(), the loop has no branch that depends on the data:
+   * each step moves a base pointer by half of the remaining range or not,
+   * which compiles to a conditional move, so there are no mispredictions.
+   * Both possible next probes are prefetched, so the cache misses of large
+   * arrays overlap too.
+   * 
+   * @param pArr Pointer to the first element of the array to search. The array
+   * must be sorted in ascending order.
+   * @param n Number of elements in the array.
+   * @param key Key value to search for
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   * @return SearchResult Index of the first element not less than key, and
+   * whether that element equals key.
    */
-  static void merge(T *pA, T *pB, size_t left, size_t right, size_t mid,
-                    int (*compare)(const T &x, const T &y));
+  template <class Compare>
+  static SearchResult lowerBound(const T *pArr, size_t n, const T &key,
+                                 Compare compare);
 
   /**
-   * @brief Recursive helper function for mergeSort
+   * @brief Function-pointer version of lowerBound().
+   */
+  static SearchResult lowerBound(const T *pArr, size_t n, const T &key,
+                                 CompareFn compare) {
+    return lowerBound<CompareFn>(pArr, n, key, compare);
+  }
+
+  /**
+   * @brief Sort an array using the merge sort algorithm.
    * 
-   * @param pA Pointer to first element of the array to sort
-   * @param pB Pointer to first element of scratch array
-   * @param left Index of leftmost element in the section to be sorted
-   * @param right One past index of rightmost element in the section to be 
-   * sorted
-   * @param compare Pointer to a function used to compare two elements. This 
-   * must return a negative value if x < y, zero if x == y, or positive if 
-   * x > y.
+   * @param pArr Pointer to the first element of the array to search.
+   * @param n Size of the array.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void mergeSort(T *pArr, size_t n, Compare compare);
+
+  /**
+   * @brief Function-pointer version of mergeSort().
    */
-  static void mergeSort(T *pA, T *pB, size_t left, size_t size_t,
-                        int (*compare)(const T &x, const T &y));
+  static void mergeSort(T *pArr, size_t n, CompareFn compare) {
+    mergeSort<CompareFn>(pArr, n, compare);
+  }
 
   /**
-   * @brief Partitioning helper function for quickSort
+   * @brief Sort an array of strings using most-significant-digit radix
+   * sort.
    * 
-   * @param pArr Pointer to first element of the array to sort.
-   * @param lo Leftmost index in range being sorted.
-   * @param hi Rightmost index in range being sorted.
-   * @param compare Pointer to a function used to compare two elements. This 
-   * must return a negative value if x < y, zero if x == y, or positive if 
-   * x > y.
-   * @return int index in [lo, hi] such that everything to the left is less
-   * than or equal to everything in the right.
+   * Strings are distributed into 257 buckets by their first character, or
+   * by having none, and each bucket is sorted the same way by the next
+   * character. No two strings are ever compared, so a shared prefix is
+   * looked at once per string rather than once per comparison. Finding a
+   * string's character means following a pointer to its text, a likely
+   * cache miss, so each pass reads every character once into a compact
+   * cache, and both counting and distributing work from the cache.
+   * Buckets of STRING_CUTOFF or fewer strings are finished by insertion
+   * sort, comparing only past the prefix the bucket shares. The sort is
+   * stable and uses n strings of scratch space.
+   * 
+   * T must be std::string, or a type with the same size(), operator[] and
+   * compare() members. Strings are ordered as by operator<, by unsigned
+   * character values.
+   * 
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
    */
-  static size_t partition(T *pArr, size_t lo, size_t hi,
-                       int (*compare)(const T &x, const T &y));
+  static void msdRadixSort(T *pArr, size_t n);
 
   /**
-   * @brief Recursive helper function for quickSort.
+   * @brief Sort an array of strings using multikey quicksort, also known
+   * as three-way radix quicksort.
    * 
-   * @param pArr Pointer to first element of the array to sort. 
-   * @param lo Index of the leftmost element in range being sorted.
-   * @param hi Index of the rightmost element in range being sorted.
-   * @param compare Pointer to a function used to compare two elements. This 
-   * must return a negative value if x < y, zero if x == y, or positive if 
-   * x > y.
+   * Each partitioning pass splits the strings by their character at one
+   * position, the same for the whole range, into those with a smaller,
+   * equal, or greater character than the pivot's. Only the equal group
+   * moves on to the next position; the other two are partitioned again at
+   * the same one. Characters of a common prefix are thus examined about lg
+   * n times each, not once per comparison of a comparison sort, and no
+   * scratch space is needed. Pivots are the median of three characters,
+   * small ranges are finished by insertion sort past the shared prefix,
+   * and a range that takes too many passes at one position is heapsorted,
+   * as in introSort(). The sort is not stable.
+   * 
+   * T must be std::string, or a type with the same size(), operator[] and
+   * compare() members. Strings are ordered as by operator<.
+   * 
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
    */
-  static void quickSort(T *pArr, size_t lo, size_t hi,
-                        int (*compare)(const T &x, const T &y));
-};
+  static void multikeyQuickSort(T *pArr, size_t n) {
+    multikeyQuickSort(pArr, 0, n, 0, depthLimit(n));
+  }
 
-//-----------------------------------------------------------------------------
-// function implementations
-//-----------------------------------------------------------------------------
+  /**
+   * @brief Put the element that belongs at index k of the sorted array
+   * there, with no greater element before it and no smaller one after.
+   * 
+   * This is introselect: quicksort's partitioning, choosing pivots as
+   * introSort() does, but only the side holding index k is partitioned
+   * further, so the expected work is linear rather than n lg n. Elements
+   * equal to the pivot are set aside by partitionThreeWay(), and selection
+   * stops as soon as k lands among them. If the partitions keep coming out
+   * lopsided, the remaining range is heapsorted, so the worst case is
+   * O(n lg n).
+   * 
+   * @param pArr Pointer to the first element of the array.
+   * @param n Size of the array.
+   * @param k Index of the element to select; 0 for the smallest.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   * @throws std::out_of_range if k is not less than n.
+   */
+  template <class Compare>
+  static void nthElement(T *pArr, size_t n, size_t k, Compare compare);
 
-/*
- * Implementation of iterative binarySearch() function.
- */
-template <class T>
-int SearchNSort<T>::binarySearch(const T *pArr, size_t n, const T &key,
-                                 int (*comp)(const T &x, const T &y)) {
-  size_t i = 0, j = n - 1, mid;
-  while (i <= j) {
-    mid = (i + j) / 2;
-    int res = comp(pArr[mid], key);
-    if (res == 0) {
-      return mid;
-    } else if (res > 0) {
-      j = mid - 1;
-    } else {
-      i = mid + 1;
-    }
+  /**
+   * @brief Function-pointer version of nthElement().
+   */
+  static void nthElement(T *pArr, size_t n, size_t k, CompareFn compare) {
+    nthElement<CompareFn>(pArr, n, k, compare);
   }
-  return -1;
-}
 
-// doctest unit test for binarySearch
-TEST_CASE("testing SearchNSort::binarySearch") {
-  // make array for searching; make sure it does not have 0, but does have 1
-  int pA[100];
-  std::mt19937_64 prng(time(0));
-  std::uniform_int_distribution<int> dist(-100, 100);
-  for(size_t i = 0; i < 100; i++) {
-    int v = dist(prng);
-    pA[i] = v == 0 ? 1 : v;
-  }
-  pA[17] = 1;
+  /**
+   * @brief Sort the k smallest elements of an array into pArr[0, k),
+   * leaving the rest in unspecified order after them.
+   * 
+   * nthElement() selects the k smallest elements in linear expected time,
+   * and only those are sorted with introSort(), for O(n + k lg k) time in
+   * all. The sort is not stable.
+   * 
+   * @param pArr Pointer to the first element of the array.
+   * @param n Size of the array.
+   * @param k Number of smallest elements wanted; the whole array is sorted
+   * if k is at least n.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void partialSort(T *pArr, size_t n, size_t k, Compare compare);
 
-  // sort the array
-  std::sort(pA, pA + 100);
+  /**
+   * @brief Function-pointer version of partialSort().
+   */
+  static void partialSort(T *pArr, size_t n, size_t k, CompareFn compare) {
+    partialSort<CompareFn>(pArr, n, k, compare);
+  }
 
-  // lambda function for comparing elements for the search
-  auto cmp = [](const int &a, const int &b) { return a - b; };
+  /**
+   * @brief Rearrange an array in place so that element pOrder[i] moves to
+   * index i, as given by argSort().
+   * 
+   * The permutation is applied one cycle at a time: the first element of a
+   * cycle is set aside, each position in the cycle takes the element that
+   * belongs there, and the element set aside fills the last hole. Every
+   * element is moved once, plus once more for the first of each cycle,
+   * with a single element of extra space. Positions are marked as done by
+   * setting pOrder[i] to i, so pOrder is the identity afterwards.
+   * 
+   * @param pArr Pointer to the first element of the array.
+   * @param n Size of the array.
+   * @param pOrder Pointer to a permutation of 0, 1, ..., n - 1.
+   * @throws std::out_of_range if pOrder is not a permutation, in which case
+   * the contents of pArr are unspecified.
+   */
+  static void permute(T *pArr, size_t n, size_t *pOrder);
 
-  // search for 1 should work
-  int idx = SearchNSort<int>::binarySearch(pA, 100, 1, cmp);
-  CHECK(-1 != idx);
-  // search for 0 should not work
-  idx = SearchNSort<int>::binarySearch(pA, 100, 0, cmp);
-  CHECK(-1 == idx);
-}
+  /**
+   * @brief Sort an array using the quicksort algorithm.
+   * 
+   * This runs in introsort mode: see introSort() for the pivot choice,
+   * small-range cutoffs, and heapsort fallback that keep sorted and
+   * reverse-sorted input at O(n lg n) time and O(lg n) stack depth.
+   * 
+   * @param pArr Pointer to the first element of the array to search.
+   * @param n Size of the array.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void quickSort(T *pArr, size_t n, Compare compare) {
+    introSort(pArr, n, compare);
+  }
 
-/*
- * Implementation of bubbleSort() function.
- */
-template <class T>
-void SearchNSort<T>::bubbleSort(T *pArr, size_t n,
-                                int (*comp)(const T &x, const T &y)) {
+  /**
+   * @brief Function-pointer version of quickSort().
+   */
+  static void quickSort(T *pArr, size_t n, CompareFn compare) {
+    quickSort<CompareFn>(pArr, n, compare);
+  }
 
-  do {
-    size_t newN = 0u;
-    for (size_t i = 1u; i < n; i++) {
-      if (comp(pArr[i - 1], pArr[i]) > 0) {
+  /**
+   * @brief Sort an array of numbers using least-significant-digit radix
+   * sort.
+   * 
+   * T must be an integer type of any size, float, or double. See the
+   * key-extractor version for details.
+   * 
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
+   */
+  static void radixSort(T *pArr, size_t n) {
+    radixSort(pArr, n, [](const T &x) { return x; });
+  }
+
+  /**
+   * @brief Sort an array by numeric keys using least-significant-digit
+   * radix sort.
+   * 
+   * Keys are mapped to unsigned integers that order the same way: the sign
+   * bit of a signed integer is flipped, and a float or double has its sign
+   * bit flipped if it is positive, or all of its bits flipped if it is
+   * negative. The array is then sorted by one byte of the mapped keys at a
+   * time, least significant first, with a stable counting sort. Counts for
+   * every byte are gathered in a single pass up front, and a byte that is
+   * the same in every key is skipped, so small-range keys need few passes.
+   * Sorting takes O(n) time for a fixed key size and is stable. NaN keys
+   * are placed after +infinity, or before -infinity if their sign bit is
+   * set.
+   * 
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
+   * @param key Function object taking an element and returning its key, of
+   * any integer type, float, or double.
+   */
+  template <class KeyOf>
+  static void radixSort(T *pArr, size_t n, KeyOf key);
+
+  /**
+   * @brief Sort an array using the selection sort algorithm.
+   * 
+   * @param pArr Pointer to the first element of the array to search.
+   * @param n Size of the array.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void selectionSort(T *pArr, size_t n, Compare compare);
+
+  /**
+   * @brief Function-pointer version of selectionSort().
+   */
+  static void selectionSort(T *pArr, size_t n, CompareFn compare) {
+    selectionSort<CompareFn>(pArr, n, compare);
+  }
+
+  /**
+   * @brief Sort an array of large records by a small key: argSort(), then
+   * permute().
+   * 
+   * Sorting the records directly moves them O(n lg n) times; here each is
+   * moved at most twice, which pays off when moving a record costs much
+   * more than moving its key. The sort is stable.
+   * 
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
+   * @param keyOf Function object taking an element and returning its key.
+   * @param compare Comparator used to compare two keys; see the class 
+   * description.
+   */
+  template <class KeyOf, class Compare>
+  static void sortByKey(T *pArr, size_t n, KeyOf keyOf, Compare compare);
+
+  /**
+   * @brief sortByKey() comparing keys with operator<.
+   */
+  template <class KeyOf>
+  static void sortByKey(T *pArr, size_t n, KeyOf keyOf) {
+    sortByKey(pArr, n, keyOf,
+              std::less<typename std::decay<decltype(keyOf(*pArr))>::type>());
+  }
+
+  /**
+   * @brief Sort an array using quicksort with three-way partitioning.
+   * 
+   * Each partitioning pass splits its range into elements less than, equal
+   * to, and greater than the pivot, and only the first and last groups are
+   * sorted further. Keys with few distinct values are therefore sorted in
+   * close to linear time: once a value has been a pivot, no element equal to
+   * it is touched again. Pivots, small ranges and the recursion depth are
+   * handled as in introSort().
+   * 
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void threeWayQuickSort(T *pArr, size_t n, Compare compare);
+
+  /**
+   * @brief Function-pointer version of threeWayQuickSort().
+   */
+  static void threeWayQuickSort(T *pArr, size_t n, CompareFn compare) {
+    threeWayQuickSort<CompareFn>(pArr, n, compare);
+  }
+
+  /**
+   * @brief Sort an array using Timsort, an adaptive merge sort.
+   * 
+   * The array is scanned for natural runs: stretches that are already
+   * ascending, or strictly descending, which are reversed in place. Runs
+   * shorter than a minimum length between 16 and 32, chosen so the number
+   * of runs is at most a power of two, are extended by binary insertion
+   * sort. The runs are kept on a stack whose lengths shrink at least as
+   * fast as the Fibonacci numbers, merging neighbors when they would not,
+   * so merges stay balanced and the stack stays short.
+   * 
+   * Each merge first skips the elements already in place at both ends of
+   * the pair of runs, then copies only the shorter run to scratch space.
+   * When one run keeps winning, the merge switches to galloping mode: it
+   * finds how many elements of that run come next by exponential search,
+   * and moves them as a block. Input that is sorted or reverse sorted
+   * takes n - 1 comparisons, input made of a few sorted pieces is merged in
+   * about as many comparisons as it has pieces times lg n, and random
+   * input takes about as many comparisons as mergeSort(). The sort is
+   * stable.
+   * 
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void timSort(T *pArr, size_t n, Compare compare);
+
+  /**
+   * @brief Function-pointer version of timSort().
+   */
+  static void timSort(T *pArr, size_t n, CompareFn compare) {
+    timSort<CompareFn>(pArr, n, compare);
+  }
+
+private:
+  /**
+   * @brief ParallelSort builds on the private helpers below.
+   */
+  template <class U> friend class ParallelSort;
+
+  /**
+   * @brief So does EytzingerIndex.
+   */
+  template <class U> friend class EytzingerIndex;
+
+  /**
+   * @brief And LoserTree.
+   */
+  template <class U, class C> friend class LoserTree;
+
+  /**
+   * @brief And TopK.
+   */
+  template <class U, class C> friend class TopK;
+
+  /**
+   * @brief argSort() compares keys with the helpers of SearchNSort<Key>.
+   */
+  template <class U> friend class SearchNSort;
+
+  /**
+   * @brief Ranges this small are finished by insertion sort in introSort()
+   * and threeWayQuickSort(), when no sorting network applies.
+   */
+  static const size_t INSERTION_CUTOFF = 16;
+
+  /**
+   * @brief Ranges this small are finished by lowerBound() in
+   * interpolationSearch().
+   */
+  static const size_t INTERPOLATION_CUTOFF = 16;
+
+  /**
+   * @brief Length of the runs insertion sorted by bottomUpMergeSort().
+   */
+  static const size_t RUN_SIZE = 32;
+
+  /**
+   * @brief timSort() insertion sorts arrays shorter than this, and
+   * otherwise extends runs to at least half of it.
+   */
+  static const size_t MIN_MERGE = 32;
+
+  /**
+   * @brief Number of consecutive wins by one run after which a timSort()
+   * merge first switches to galloping mode.
+   */
+  static const size_t MIN_GALLOP = 7;
+
+  /**
+   * @brief A sorted run pArr[base, base + len) on timSort()'s stack.
+   */
+  struct TimRun {
+    size_t base, len;
+  };
+
+  /**
+   * @brief State shared by the timSort() helpers: the array, the stack of
+   * runs waiting to be merged, scratch space for merging, and the current
+   * number of wins that triggers galloping, which goes down while galloping
+   * pays off and up when it does not.
+   */
+  template <class Compare> struct TimState {
+    T *pArr;
+    Compare &compare;
+    std::vector<TimRun> runs;
+    std::vector<T> tmp;
+    size_t minGallop;
+  };
+
+  /**
+   * @brief Ranges of strings this small are finished by insertion sort in
+   * msdRadixSort() and multikeyQuickSort().
+   */
+  static const size_t STRING_CUTOFF = 16;
+
+  /**
+   * @brief Ranges this large use a ninther pivot in choosePivot().
+   */
+  static const size_t NINTHER_CUTOFF = 128;
+
+  /**
+   * @brief Ranges this small are finished by a SortingNetwork, when
+   * UsesNetwork holds for the comparator.
+   */
+  static const size_t NETWORK_CUTOFF = 32;
+
+  /**
+   * @brief Number of SIMD registers the operator== versions of
+   * linearSearch() and countMatches() compare per loop iteration.
+   */
+  static const size_t LINEAR_UNROLL = 4;
+
+  /**
+   * @brief Whether small ranges sorted with a Compare comparator can go to
+   * a SortingNetwork: the network sorts numbers in ascending order, so T
+   * must be a number type and Compare must be std::less<T>.
+   */
+  template <class Compare>
+  struct UsesNetwork
+      : std::integral_constant<bool,
+                               std::is_arithmetic<T>::value &&
+                                   std::is_same<Compare, std::less<T>>::value> {
+  };
+
+  /**
+   * @brief Sort pArr[0, n) with a SortingNetwork if UsesNetwork holds for
+   * the comparator and n is at most NETWORK_CUTOFF.
+   * 
+   * @return bool true if the range was sorted, false if the caller must
+   * sort it some other way.
+   */
+  template <class Compare>
+  static bool networkSort(T *pArr, size_t n, Compare &) {
+    return networkSort(pArr, n, UsesNetwork<Compare>());
+  }
+
+  /**
+   * @brief networkSort() for comparators a network can stand in for.
+   */
+  static bool networkSort(T *pArr, size_t n, std::true_type) {
+    if (n > NETWORK_CUTOFF) {
+      return false;
+    }
+    SortingNetwork<T>::sort(pArr, n);
+    return true;
+  }
+
+  /**
+   * @brief networkSort() for all other comparators.
+   */
+  static bool networkSort(T *, size_t, std::false_type) { return false; }
+
+  /**
+   * @brief Size below which introSort() and threeWayQuickSort() stop
+   * partitioning and call leafSort().
+   */
+  template <class Compare> static size_t leafCutoff(Compare &) {
+    return UsesNetwork<Compare>::value ? NETWORK_CUTOFF : INSERTION_CUTOFF;
+  }
+
+  /**
+   * @brief Sort the small range pArr[lo, hi) with a SortingNetwork if
+   * possible, and by insertion sort otherwise.
+   */
+  template <class Compare>
+  static void leafSort(T *pArr, size_t lo, size_t hi, Compare &compare) {
+    if (!networkSort(pArr + lo, hi - lo, compare)) {
+      insertionSort(pArr, lo, hi, compare);
+    }
+  }
+
+  /**
+   * @brief Restore the max-heap property below index i of a heap.
+   * 
+   * @param pArr Pointer to the root of the heap.
+   * @param i Index of the element that may be smaller than its children.
+   * @param n Number of elements in the heap.
+   * @param compare Comparator used to compare two elements.
+   */
+  template <class Compare>
+  static void siftDown(T *pArr, size_t i, size_t n, Compare &compare);
+
+  /**
+   * @brief Index of the median of pArr[a], pArr[b] and pArr[c].
+   */
+  template <class Compare>
+  static size_t median(const T *pArr, size_t a, size_t b, size_t c,
+                       Compare &compare);
+
+  /**
+   * @brief Index of a pivot for quicksorting pArr[lo, hi): the median of
+   * the first, middle and last elements, or on large ranges Tukey's
+   * ninther, the median of the medians of three evenly spaced triples.
+   */
+  template <class Compare>
+  static size_t choosePivot(const T *pArr, size_t lo, size_t hi,
+                            Compare &compare);
+
+  /**
+   * @brief Number of partitioning levels allowed when sorting n elements
+   * before giving up on quicksort: 2 lg n.
+   */
+  static size_t depthLimit(size_t n) {
+    size_t depth = 0;
+    for (; n > 1u; n /= 2) {
+      depth += 2;
+    }
+    return depth;
+  }
+
+  /**
+   * @brief Insertion sort of pArr[lo, hi) that shifts larger elements up
+   * rather than swapping, for finishing small ranges.
+   */
+  template <class Compare>
+  static void insertionSort(T *pArr, size_t lo, size_t hi, Compare &compare);
+
+  /**
+   * @brief Iterative helper function for introSort.
+   * 
+   * @param pArr Pointer to first element of the array to sort.
+   * @param lo Index of the leftmost element in range being sorted.
+   * @param hi One past the index of the rightmost element in range being 
+   * sorted.
+   * @param depth Number of further partitioning levels allowed before the
+   * range is handed to heapsort.
+   * @param compare Comparator used to compare two elements.
+   */
+  template <class Compare>
+  static void introSort(T *pArr, size_t lo, size_t hi, size_t depth,
+                        Compare &compare);
+
+  /**
+   * @brief Merge two sorted portions of an array together.
+   * 
+   * @param pA Array containing two sorted portions
+   * @param pB Scratch array destination
+   * @param left left index of left sorted portion
+   * @param right one past right index of right sorted portion
+   * @param mid start of right sorted portion
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void merge(T *pA, T *pB, size_t left, size_t right, size_t mid,
+                    Compare &compare);
+
+  /**
+   * @brief Recursive helper function for mergeSort
+   * 
+   * @param pA Pointer to first element of the array to sort
+   * @param pB Pointer to first element of scratch array
+   * @param left Index of leftmost element in the section to be sorted
+   * @param right One past index of rightmost element in the section to be 
+   * sorted
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   */
+  template <class Compare>
+  static void mergeSort(T *pA, T *pB, size_t left, size_t right,
+                        Compare &compare);
+
+  /**
+   * @brief Partitioning helper function for introSort
+   * 
+   * @param pArr Pointer to first element of the array to sort.
+   * @param lo Leftmost index in range being sorted.
+   * @param hi Rightmost index in range being sorted.
+   * @param compare Comparator used to compare two elements; see the class 
+   * description.
+   * @return int index in [lo, hi] such that everything to the left is less
+   * than or equal to everything in the right.
+   */
+  template <class Compare>
+  static size_t partition(T *pArr, size_t lo, size_t hi, Compare &compare);
+
+  /**
+   * @brief Three-way partitioning helper function for threeWayQuickSort.
+   * 
+   * Rearranges pArr[lo, hi) around the pivot value pArr[lo] so that 
+   * pArr[lo, lt) is less than the pivot, pArr[lt, gt) is equal to it, and
+   * pArr[gt, hi) is greater.
+   * 
+   * @param pArr Pointer to first element of the array to partition.
+   * @param lo Index of the leftmost element in range; holds the pivot.
+   * @param hi One past the index of the rightmost element in range.
+   * @param lt Set to the start of the equal group.
+   * @param gt Set to one past the end of the equal group.
+   * @param compare Comparator used to compare two elements.
+   */
+  template <class Compare>
+  static void partitionThreeWay(T *pArr, size_t lo, size_t hi, size_t &lt,
+                                size_t &gt, Compare &compare);
+
+  /**
+   * @brief Character d of string s as an unsigned value, or -1 past its
+   * end.
+   */
+  static int charAt(const T &s, size_t d) {
+    return d < s.size() ? static_cast<unsigned char>(s[d]) : -1;
+  }
+
+  /**
+   * @brief Insertion sort of the strings pArr[lo, hi), which share their
+   * first d characters, comparing only what follows.
+   */
+  static void stringInsertionSort(T *pArr, size_t lo, size_t hi, size_t d);
+
+  /**
+   * @brief Recursive helper function for multikeyQuickSort(): sort
+   * pArr[lo, hi), whose strings share their first d characters, allowing
+   * depth partitioning passes at position d before heapsorting.
+   */
+  static void multikeyQuickSort(T *pArr, size_t lo, size_t hi, size_t d,
+                                size_t depth);
+
+  /**
+   * @brief Minimum run length for timSort() on n elements: n itself if n
+   * is less than MIN_MERGE, otherwise a length in [MIN_MERGE / 2,
+   * MIN_MERGE] that divides n into a power of two runs, or slightly fewer.
+   */
+  static size_t minRunLength(size_t n) {
+    size_t r = 0;
+    for (; n >= MIN_MERGE; n >>= 1) {
+      r |= n & 1u;
+    }
+    return n + r;
+  }
+
+  /**
+   * @brief Find the natural run starting at pArr[lo], reversing it if it is
+   * strictly descending.
+   * 
+   * @return size_t One past the end of the run, at most hi.
+   */
+  template <class Compare>
+  static size_t countRun(T *pArr, size_t lo, size_t hi, Compare &compare);
+
+  /**
+   * @brief Binary insertion sort of pArr[lo, hi), where pArr[lo, start) is
+   * already sorted. Each element is placed after any equal ones, so the
+   * sort is stable.
+   */
+  template <class Compare>
+  static void binaryInsertionSort(T *pArr, size_t lo, size_t hi,
+                                  size_t start, Compare &compare);
+
+  /**
+   * @brief Exponential search of the sorted pRun[0, len) for the leftmost
+   * place key could go, starting at index hint.
+   * 
+   * @return size_t Number of elements of pRun less than key.
+   */
+  template <class Compare>
+  static size_t gallopLeft(const T &key, const T *pRun, size_t len,
+                           size_t hint, Compare &compare);
+
+  /**
+   * @brief Exponential search of the sorted pRun[0, len) for the rightmost
+   * place key could go, starting at index hint.
+   * 
+   * @return size_t Number of elements of pRun not greater than key.
+   */
+  template <class Compare>
+  static size_t gallopRight(const T &key, const T *pRun, size_t len,
+                            size_t hint, Compare &compare);
+
+  /**
+   * @brief Merge runs on the stack until their lengths shrink like the
+   * Fibonacci numbers from the bottom up, or, if force is true, until a
+   * single run is left.
+   */
+  template <class Compare>
+  static void mergeCollapse(TimState<Compare> &state, bool force);
+
+  /**
+   * @brief Merge runs i and i + 1 of the stack.
+   */
+  template <class Compare> static void mergeAt(TimState<Compare> &state,
+                                               size_t i);
+
+  /**
+   * @brief Merge the adjacent runs a and b, where a is no longer than b and
+   * a's first element and b's last are known to be out of place, copying a
+   * to scratch space and merging from the left.
+   */
+  template <class Compare>
+  static void mergeLo(TimState<Compare> &state, TimRun a, TimRun b);
+
+  /**
+   * @brief Like mergeLo(), for a longer than b: copies b to scratch space
+   * and merges from the right.
+   */
+  template <class Compare>
+  static void mergeHi(TimState<Compare> &state, TimRun a, TimRun b);
+
+  /**
+   * @brief Iterative helper function for threeWayQuickSort.
+   * 
+   * @param pArr Pointer to first element of the array to sort.
+   * @param lo Index of the leftmost element in range being sorted.
+   * @param hi One past the index of the rightmost element in range being 
+   * sorted.
+   * @param depth Number of further partitioning levels allowed before the
+   * range is handed to heapsort.
+   * @param compare Comparator used to compare two elements.
+   */
+  template <class Compare>
+  static void threeWayQuickSort(T *pArr, size_t lo, size_t hi, size_t depth,
+                                Compare &compare);
+
+  /**
+   * @brief Determine whether x sorts before y.
+   * 
+   * @return bool true if x < y according to compare, which may be either
+   * kind of comparator; it is called exactly once.
+   */
+  template <class Compare>
+  static bool before(Compare &compare, const T &x, const T &y) {
+    return isNegative(compare(x, y));
+  }
+
+  /**
+   * @brief Compare x and y three ways.
+   * 
+   * @return int negative if x < y, zero if x == y, or positive if x > y. A
+   * bool comparator is called a second time to tell x == y from x > y.
+   */
+  template <class Compare>
+  static int order(Compare &compare, const T &x, const T &y) {
+    return order(compare, x, y,
+                 std::is_same<bool, decltype(compare(x, y))>());
+  }
+
+  /**
+   * @brief order() for comparators returning bool.
+   */
+  template <class Compare>
+  static int order(Compare &compare, const T &x, const T &y, std::true_type) {
+    return compare(x, y) ? -1 : (compare(y, x) ? 1 : 0);
+  }
+
+  /**
+   * @brief order() for comparators returning a negative, zero, or positive
+   * value.
+   */
+  template <class Compare>
+  static int order(Compare &compare, const T &x, const T &y, std::false_type) {
+    auto res = compare(x, y);
+    return res < 0 ? -1 : (res > 0 ? 1 : 0);
+  }
+
+  /**
+   * @brief Index of the first element of pArr[0, n) equal to key, or n if
+   * there is none, comparing SimdVector<T>::LANES elements at a time.
+   */
+  static size_t findEqual(const T *pArr, size_t n, const T &key,
+                          std::true_type);
+
+  /**
+   * @brief findEqual() one element at a time, for types without SIMD
+   * support.
+   */
+  static size_t findEqual(const T *pArr, size_t n, const T &key,
+                          std::false_type) {
+    size_t i = 0u;
+    while (i < n && !(pArr[i] == key)) {
+      i++;
+    }
+    return i;
+  }
+
+  /**
+   * @brief Number of elements of pArr[0, n) equal to key, comparing
+   * SimdVector<T>::LANES elements at a time.
+   */
+  static size_t countEqual(const T *pArr, size_t n, const T &key,
+                           std::true_type);
+
+  /**
+   * @brief countEqual() one element at a time, for types without SIMD
+   * support.
+   */
+  static size_t countEqual(const T *pArr, size_t n, const T &key,
+                           std::false_type) {
+    size_t count = 0u;
+    for (size_t i = 0u; i < n; i++) {
+      count += pArr[i] == key;
+    }
+    return count;
+  }
+
+  /**
+   * @brief Index of the lowest set bit of the non-zero mask.
+   */
+  static size_t lowestBit(unsigned mask) {
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    size_t bit = 0;
+    for (; (mask & 1u) == 0u; mask >>= 1) {
+      bit++;
+    }
+    return bit;
+#endif
+  }
+
+  /**
+   * @brief Number of set bits in mask.
+   */
+  static size_t popCount(unsigned mask) {
+#if defined(__GNUC__)
+    return __builtin_popcount(mask);
+#else
+    size_t bits = 0;
+    for (; mask != 0u; mask &= mask - 1u) {
+      bits++;
+    }
+    return bits;
+#endif
+  }
+
+  /**
+   * @brief Hint that the cache line holding p will be read soon. Does
+   * nothing on compilers without a prefetch builtin.
+   */
+  static void prefetch(const void *p) {
+#if defined(__GNUC__)
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+  }
+
+  /**
+   * @brief Result of a bool comparator: true already means "less than".
+   */
+  static bool isNegative(bool less) { return less; }
+
+  /**
+   * @brief Result of a three-way comparator: negative means "less than".
+   */
+  template <class R> static bool isNegative(R res) { return res < 0; }
+
+  /**
+   * @brief Radix-sortable form of an unsigned integer key: itself.
+   */
+  template <class K>
+  static typename std::enable_if<std::is_unsigned<K>::value, K>::type
+  radixKey(K k) {
+    return k;
+  }
+
+  /**
+   * @brief Radix-sortable form of a signed integer key: flipping the sign
+   * bit puts negative keys below non-negative ones.
+   */
+  template <class K>
+  static typename std::enable_if<std::is_signed<K>::value &&
+                                     std::is_integral<K>::value,
+                                 typename std::make_unsigned<K>::type>::type
+  radixKey(K k) {
+    typedef typename std::make_unsigned<K>::type U;
+    return static_cast<U>(k) ^ (static_cast<U>(1) << (8 * sizeof(K) - 1));
+  }
+
+  /**
+   * @brief Radix-sortable form of a float key.
+   */
+  static uint32_t radixKey(float k) {
+    uint32_t bits;
+    std::memcpy(&bits, &k, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+  }
+
+  /**
+   * @brief Radix-sortable form of a double key.
+   */
+  static uint64_t radixKey(double k) {
+    uint64_t bits;
+    std::memcpy(&bits, &k, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | (static_cast<uint64_t>(1) << 63);
+  }
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+// definition of the batch size constant, which std::min() takes by reference
+template <class T> const size_t SearchNSort<T>::BATCH_SIZE;
+
+/*
+ * Implementation of argSort() function.
+ */
+template <class T>
+template <class KeyOf, class Compare>
+void SearchNSort<T>::argSort(const T *pArr, size_t n, size_t *pOrder,
+                             KeyOf keyOf, Compare comp) {
+  typedef typename std::decay<decltype(keyOf(*pArr))>::type Key;
+  typedef std::pair<Key, size_t> Entry;
+
+  std::vector<Entry> entries;
+  entries.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    entries.push_back(Entry(keyOf(pArr[i]), i));
+  }
+
+  // ties go by index, which makes the order stable
+  SearchNSort<Entry>::introSort(
+      entries.data(), n, [&comp](const Entry &a, const Entry &b) {
+        int res = SearchNSort<Key>::order(comp, a.first, b.first);
+        return res < 0 || (res == 0 && a.second < b.second);
+      });
+  for (size_t i = 0; i < n; i++) {
+    pOrder[i] = entries[i].second;
+  }
+}
+
+// doctest unit test for argSort
+TEST_CASE("testing SearchNSort::argSort") {
+  // the order matches a stable sort of the indices, and the array is left
+  // alone
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(0, 50);
+  for (size_t n : {0u, 1u, 2u, 10u, 1000u}) {
+    std::vector<std::string> words(n);
+    for (std::string &word : words) {
+      word = std::string(1, char('a' + dist(prng) % 26)) +
+             std::to_string(dist(prng));
+    }
+    std::vector<std::string> original = words;
+    auto first = [](const std::string &w) { return w[0]; };
+
+    std::vector<size_t> order(n), expected(n);
+    for (size_t i = 0; i < n; i++) {
+      expected[i] = i;
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&](size_t a, size_t b) {
+                       return words[a][0] < words[b][0];
+                     });
+    SearchNSort<std::string>::argSort(words.data(), n, order.data(), first);
+    CHECK(order == expected);
+    CHECK(words == original);
+
+    // descending, with a three-way comparator
+    std::reverse(expected.begin(), expected.end());
+    SearchNSort<std::string>::argSort(words.data(), n, order.data(), first,
+                                      [](const char &a, const char &b) {
+                                        return int(b) - int(a);
+                                      });
+    for (size_t i = 1; i < n; i++) {
+      CHECK(words[order[i - 1]][0] >= words[order[i]][0]);
+      if (words[order[i - 1]][0] == words[order[i]][0]) {
+        CHECK(order[i - 1] < order[i]);
+      }
+    }
+  }
+}
+
+/*
+ * Implementation of batchLowerBound() function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::batchLowerBound(const T *pArr, size_t n, const T *pKeys,
+                                     size_t numKeys, size_t *pOut,
+                                     Compare comp) {
+  if (n == 0u) {
+    std::fill(pOut, pOut + numKeys, 0);
+    return;
+  }
+
+  const T *pBase[BATCH_SIZE];
+  for (size_t start = 0; start < numKeys; start += BATCH_SIZE) {
+    size_t count = std::min(BATCH_SIZE, numKeys - start);
+    const T *pKey = pKeys + start;
+    std::fill(pBase, pBase + count, pArr);
+
+    // the range length, and so each step's probe offset, is the same for
+    // every search; only the bases differ
+    size_t len = n;
+    while (len > 1u) {
+      size_t half = len / 2, next = (len - half) / 2;
+      for (size_t i = 0; i < count; i++) {
+        pBase[i] = before(comp, pBase[i][half], pKey[i]) ? pBase[i] + half
+                                                         : pBase[i];
+        prefetch(pBase[i] + next);
+      }
+      len -= half;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      pOut[start + i] = (pBase[i] - pArr) + before(comp, *pBase[i], pKey[i]);
+    }
+  }
+}
+
+// doctest unit test for batchLowerBound
+TEST_CASE("testing SearchNSort::batchLowerBound") {
+  // batches of keys covering every position, on arrays with duplicates, of
+  // sizes around powers of two; the number of keys is not a multiple of
+  // the batch size
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-500, 500);
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+  for(size_t n : {0, 1, 2, 3, 15, 16, 17, 100, 1023, 1024, 1025, 100000}) {
+    std::vector<int> pA(n);
+    for(size_t i = 0; i < n; i++) {
+      pA[i] = dist(prng);
+    }
+    std::sort(pA.begin(), pA.end());
+
+    std::vector<int> keys;
+    for(int key = -502; key <= 502; key++) {
+      keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), prng);
+    std::vector<size_t> out(keys.size()), outFn(keys.size());
+    SearchNSort<int>::batchLowerBound(pA.data(), n, keys.data(), keys.size(),
+                                      out.data(), std::less<int>());
+    SearchNSort<int>::batchLowerBound(pA.data(), n, keys.data(), keys.size(),
+                                      outFn.data(), cmp);
+    for(size_t i = 0; i < keys.size(); i++) {
+      size_t expected = std::lower_bound(pA.begin(), pA.end(), keys[i]) - 
+                        pA.begin();
+      CHECK(expected == out[i]);
+      CHECK(expected == outFn[i]);
+    }
+  }
+
+  // no keys at all
+  int pB[] = {1, 2, 3};
+  SearchNSort<int>::batchLowerBound(pB, 3, pB, 0, nullptr, std::less<int>());
+}
+
+/*
+ * Implementation of iterative binarySearch() function.
+ */
+template <class T>
+template <class Compare>
+int SearchNSort<T>::binarySearch(const T *pArr, size_t n, const T &key,
+                                 Compare comp) {
+  // search the half-open range [i, j), so j never has to go below 0
+  size_t i = 0, j = n, mid;
+  while (i < j) {
+    mid = i + (j - i) / 2;
+    int res = order(comp, pArr[mid], key);
+    if (res == 0) {
+      return mid;
+    } else if (res > 0) {
+      j = mid;
+    } else {
+      i = mid + 1;
+    }
+  }
+  return -1;
+}
+
+// doctest unit test for binarySearch
+TEST_CASE("testing SearchNSort::binarySearch") {
+  // make array for searching; make sure it does not have 0, but does have 1
+  int pA[100];
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100, 100);
+  for(size_t i = 0; i < 100; i++) {
+    int v = dist(prng);
+    pA[i] = v == 0 ? 1 : v;
+  }
+  pA[17] = 1;
+
+  // sort the array
+  std::sort(pA, pA + 100);
+
+  // lambda function for comparing elements for the search
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+
+  // search for 1 should work
+  int idx = SearchNSort<int>::binarySearch(pA, 100, 1, cmp);
+  CHECK(-1 != idx);
+  // search for 0 should not work
+  idx = SearchNSort<int>::binarySearch(pA, 100, 0, cmp);
+  CHECK(-1 == idx);
+
+  // keys below the first element, and empty arrays
+  idx = SearchNSort<int>::binarySearch(pA, 100, -101, cmp);
+  CHECK(-1 == idx);
+  idx = SearchNSort<int>::binarySearch(pA, 1, pA[0], cmp);
+  CHECK(0 == idx);
+  idx = SearchNSort<int>::binarySearch(pA, 0, pA[0], cmp);
+  CHECK(-1 == idx);
+}
+
+/*
+ * Implementation of bottomUpMergeSort() function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::bottomUpMergeSort(T *pArr, size_t n, Compare comp) {
+  // sorted runs to start from
+  for (size_t lo = 0; lo < n; lo += RUN_SIZE) {
+    leafSort(pArr, lo, std::min(n, lo + RUN_SIZE), comp);
+  }
+  if (n <= RUN_SIZE) {
+    return;
+  }
+
+  // merge pairs of runs from pSrc into pDst, then swap roles
+  T *pB = new T[n];
+  T *pSrc = pArr, *pDst = pB;
+  for (size_t width = RUN_SIZE; width < n; width *= 2) {
+    for (size_t left = 0; left < n; left += 2 * width) {
+      size_t mid = std::min(n, left + width);
+      size_t right = std::min(n, left + 2 * width);
+      merge(pSrc, pDst, left, right, mid, comp);
+    }
+    std::swap(pSrc, pDst);
+  }
+
+  // an odd number of passes leaves the result in the scratch array
+  if (pSrc != pArr) {
+    std::copy(pSrc, pSrc + n, pArr);
+  }
+  delete[] pB;
+}
+
+// doctest unit test for bottomUpMergeSort
+TEST_CASE("testing SearchNSort::bottomUpMergeSort") {
+  // make two arrays for sorting
+  int pA[100], pB[100];
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100, 100);
+  for(size_t i = 0; i < 100; i++) {
+    pA[i] = pB[i] = dist(prng);
+  }
+
+  // lambda function for comparing elements for the sort
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+
+  // sort using bottomUpMergeSort
+  SearchNSort<int>::bottomUpMergeSort(pA, 100, cmp);
+
+  // sort using std::sort
+  std::sort(pB, pB + 100);
+
+  // check elements are the same
+  for(size_t i = 0; i < 100; i++) {
+    CHECK(pA[i] == pB[i]);
+  }
+
+  // stability, on sizes giving both odd and even numbers of passes, and
+  // ones that are not multiples of the run size
+  typedef std::pair<int, size_t> Item;
+  auto byKey = [](const Item &a, const Item &b) { return a.first < b.first; };
+  for(size_t n : {0, 1, 31, 32, 33, 64, 100, 1000, 4097, 10000}) {
+    std::vector<Item> items(n), expected;
+    for(size_t i = 0; i < n; i++) {
+      items[i] = Item(dist(prng), i);
+    }
+    expected = items;
+    std::stable_sort(expected.begin(), expected.end(), byKey);
+    SearchNSort<Item>::bottomUpMergeSort(items.data(), n, byKey);
+    CHECK(items == expected);
+  }
+}
+
+/*
+ * Implementation of bubbleSort() function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::bubbleSort(T *pArr, size_t n, Compare comp) {
+
+  do {
+    size_t newN = 0u;
+    for (size_t i = 1u; i < n; i++) {
+      if (before(comp, pArr[i], pArr[i - 1])) {
         std::swap(pArr[i - 1], pArr[i]);
         newN = i;
       }
     }
-    n = newN;
-  } while (n != 0u);
+    n = newN;
+  } while (n != 0u);
+}
+
+// doctest unit test for bubbleSort
+TEST_CASE("testing SearchNSort::bubbleSort") {
+  // make two arrays for sorting
+  int pA[100], pB[100];
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100, 100);
+  for(size_t i = 0; i < 100; i++) {
+    pA[i] = pB[i] = dist(prng);
+  }
+
+  // lambda function for comparing elements for the sort
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+
+  // sort using bubbleSort
+  SearchNSort<int>::bubbleSort(pA, 100, cmp);
+
+  // sort using std::sort
+  std::sort(pB, pB + 100);
+
+  // check elements are the same
+  for(size_t i = 0; i < 100; i++) {
+    CHECK(pA[i] == pB[i]);
+  }
+}
+
+/*
+ * Implementation of exponentialSearch() function.
+ */
+template <class T>
+template <class Compare>
+SearchResult SearchNSort<T>::exponentialSearch(const T *pArr, size_t n,
+                                               const T &key, Compare comp,
+                                               size_t hint) {
+  if (n == 0u) {
+    SearchResult res = {0, false};
+    return res;
+  }
+  hint = std::min(hint, n - 1);
+
+  // gallop until the answer is known to be in [lo, hi]
+  size_t lo, hi, step = 1;
+  if (before(comp, pArr[hint], key)) {
+    // the answer is after hint
+    lo = hint + 1;
+    hi = n;
+    while (step <= n - 1 - hint &&
+           before(comp, pArr[hint + step], key)) {
+      lo = hint + step + 1;
+      step *= 2;
+    }
+    if (step <= n - 1 - hint) {
+      hi = hint + step;
+    }
+  } else {
+    // the answer is hint, or before it
+    lo = 0;
+    hi = hint;
+    while (step <= hint && !before(comp, pArr[hint - step], key)) {
+      hi = hint - step;
+      step *= 2;
+    }
+    if (step <= hint) {
+      lo = hint - step + 1;
+    }
+  }
+
+  SearchResult res = lowerBound(pArr + lo, hi - lo, key, comp);
+  res.index += lo;
+  res.found = res.index < n && !before(comp, key, pArr[res.index]);
+  return res;
+}
+
+// doctest unit test for exponentialSearch
+TEST_CASE("testing SearchNSort::exponentialSearch") {
+  // every key from below the smallest element to above the largest, from
+  // every starting point, on arrays with duplicates
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-50, 50);
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+  for(size_t n : {0, 1, 2, 3, 7, 8, 9, 100}) {
+    std::vector<int> pA(n);
+    for(size_t i = 0; i < n; i++) {
+      pA[i] = dist(prng);
+    }
+    std::sort(pA.begin(), pA.end());
+
+    for(int key = -52; key <= 52; key++) {
+      size_t expected = std::lower_bound(pA.begin(), pA.end(), key) - 
+                        pA.begin();
+      bool found = std::binary_search(pA.begin(), pA.end(), key);
+      for(size_t hint = 0; hint <= n + 1; hint++) {
+        SearchResult res = SearchNSort<int>::exponentialSearch(pA.data(), n,
+                                                               key, cmp, hint);
+        CHECK(expected == res.index);
+        CHECK(found == res.found);
+      }
+    }
+  }
+
+  // galloping from the front of a large array takes about 2 lg d
+  // comparisons for a key d elements in
+  std::vector<int> pB(1000000);
+  for(size_t i = 0; i < pB.size(); i++) {
+    pB[i] = int(i);
+  }
+  size_t count = 0;
+  auto counting = [&count](const int &a, const int &b) {
+    count++;
+    return a < b;
+  };
+  SearchResult res = SearchNSort<int>::exponentialSearch(pB.data(), pB.size(),
+                                                         100, counting);
+  CHECK(100 == res.index);
+  CHECK(res.found);
+  CHECK(count <= 20);
+}
+
+/*
+ * Implementation of private siftDown() helper function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::siftDown(T *pArr, size_t i, size_t n, Compare &compare) {
+  while (2 * i + 1 < n) {
+    // larger of the children
+    size_t child = 2 * i + 1;
+    if (child + 1 < n && before(compare, pArr[child], pArr[child + 1])) {
+      child++;
+    }
+
+    if (!before(compare, pArr[i], pArr[child])) {
+      return;
+    }
+    std::swap(pArr[i], pArr[child]);
+    i = child;
+  }
+}
+
+/*
+ * Implementation of heapSort() function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::heapSort(T *pArr, size_t n, Compare comp) {
+  // build a max-heap, bottom up
+  for (size_t i = n / 2; i > 0u; i--) {
+    siftDown(pArr, i - 1, n, comp);
+  }
+
+  // repeatedly move the largest remaining element to the end
+  for (size_t end = n; end > 1u; end--) {
+    std::swap(pArr[0], pArr[end - 1]);
+    siftDown(pArr, 0, end - 1, comp);
+  }
+}
+
+// doctest unit test for heapSort
+TEST_CASE("testing SearchNSort::heapSort") {
+  // make two arrays for sorting
+  int pA[100], pB[100];
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100, 100);
+  for(size_t i = 0; i < 100; i++) {
+    pA[i] = pB[i] = dist(prng);
+  }
+
+  // lambda function for comparing elements for the sort
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+
+  // sort using heapSort
+  SearchNSort<int>::heapSort(pA, 100, cmp);
+
+  // sort using std::sort
+  std::sort(pB, pB + 100);
+
+  // check elements are the same
+  for(size_t i = 0; i < 100; i++) {
+    CHECK(pA[i] == pB[i]);
+  }
+}
+
+/*
+ * Implementation of insertionSort() function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::insertionSort(T *pArr, size_t n, Compare comp) {
+
+  for (size_t i = 1u; i < n; i++) {
+    size_t j = i;
+    while (j > 0u && before(comp, pArr[j], pArr[j - 1])) {
+      std::swap(pArr[j], pArr[j - 1]);
+      j--;
+    }
+  }
+}
+
+// doctest unit test for insertionSort
+TEST_CASE("testing SearchNSort::insertionSort") {
+  // make two arrays for sorting
+  int pA[100], pB[100];
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100, 100);
+  for(size_t i = 0; i < 100; i++) {
+    pA[i] = pB[i] = dist(prng);
+  }
+
+  // lambda function for comparing elements for the sort
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+
+  // sort using insertionSort
+  SearchNSort<int>::insertionSort(pA, 100, cmp);
+
+  // sort using std::sort
+  std::sort(pB, pB + 100);
+
+  // check elements are the same
+  for(size_t i = 0; i < 100; i++) {
+    CHECK(pA[i] == pB[i]);
+  }
+}
+
+/*
+ * Implementation of private insertionSort() helper function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::insertionSort(T *pArr, size_t lo, size_t hi,
+                                   Compare &compare) {
+  for (size_t i = lo + 1; i < hi; i++) {
+    T value = std::move(pArr[i]);
+    size_t j = i;
+    while (j > lo && before(compare, value, pArr[j - 1])) {
+      pArr[j] = std::move(pArr[j - 1]);
+      j--;
+    }
+    pArr[j] = std::move(value);
+  }
+}
+
+/*
+ * Implementation of interpolationSearch() function.
+ */
+template <class T>
+template <class KeyOf>
+SearchResult SearchNSort<T>::interpolationSearch(const T *pArr, size_t n,
+                                                 const T &key, KeyOf keyOf) {
+  // keys are compared in their own type; double is only used to guess the
+  // probe, since 64-bit integers above 2^53 do not all fit in one exactly.
+  // The answer is always in [lo, hi]
+  typedef typename std::decay<decltype(keyOf(key))>::type Key;
+  const Key k = keyOf(key);
+  size_t lo = 0, hi = n;
+  while (hi - lo > INTERPOLATION_CUTOFF) {
+    Key first = keyOf(pArr[lo]), last = keyOf(pArr[hi - 1]);
+    if (!(first < k)) {
+      hi = lo;
+      break;
+    }
+    if (last < k) {
+      lo = hi;
+      break;
+    }
+
+    // first < k <= last, so a fraction in [0, 1] puts the probe in
+    // [lo, hi - 1]; keys that round to the same double probe the middle
+    size_t oldLen = hi - lo;
+    double frac = (static_cast<double>(k) - static_cast<double>(first)) /
+                  (static_cast<double>(last) - static_cast<double>(first));
+    if (!(frac >= 0.0 && frac <= 1.0)) {
+      frac = 0.5;
+    }
+    size_t probe = lo + static_cast<size_t>(frac * (hi - 1 - lo));
+    probe = std::min(probe, hi - 1);
+    if (keyOf(pArr[probe]) < k) {
+      lo = probe + 1;
+    } else {
+      hi = probe;
+    }
+
+    // a poor guess is followed by a binary search step
+    if (2 * (hi - lo) > oldLen) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (keyOf(pArr[mid]) < k) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+  }
+
+  auto less = [&keyOf](const T &x, const T &y) { return keyOf(x) < keyOf(y); };
+  SearchResult res = lowerBound(pArr + lo, hi - lo, key, less);
+  res.index += lo;
+  res.found = res.index < n && !(k < keyOf(pArr[res.index]));
+  return res;
+}
+
+// doctest unit test for interpolationSearch
+TEST_CASE("testing SearchNSort::interpolationSearch") {
+  std::mt19937_64 prng(time(0));
+
+  // uniform doubles, as in PA08, probing for present and absent keys
+  const size_t n = 100000;
+  std::vector<double> pA(n);
+  std::uniform_real_distribution<double> real;
+  for(size_t i = 0; i < n; i++) {
+    pA[i] = real(prng);
+  }
+  std::sort(pA.begin(), pA.end());
+  for(size_t i = 0; i < 1000; i++) {
+    double key = i % 2 == 0 ? pA[prng() % n] : real(prng);
+    SearchResult res = SearchNSort<double>::interpolationSearch(pA.data(), n,
+                                                                key);
+    CHECK(res.index == size_t(std::lower_bound(pA.begin(), pA.end(), key) -
+                              pA.begin()));
+    CHECK(res.found == (i % 2 == 0));
+  }
+  CHECK(0 == SearchNSort<double>::interpolationSearch(pA.data(), n, -1.0)
+                 .index);
+  CHECK(n == SearchNSort<double>::interpolationSearch(pA.data(), n, 2.0)
+                 .index);
+
+  // skewed keys that defeat interpolation, and duplicates
+  std::vector<long> pB;
+  for(long i = 0; i < 1000; i++) {
+    pB.push_back(i / 3);
+  }
+  pB.push_back(1000000000000L);
+  for(long key = -1; key <= 340; key++) {
+    SearchResult res = SearchNSort<long>::interpolationSearch(pB.data(),
+                                                              pB.size(), key);
+    CHECK(res.index == size_t(std::lower_bound(pB.begin(), pB.end(), key) -
+                              pB.begin()));
+    CHECK(res.found == (key >= 0 && key < 334));
+  }
+
+  // 64-bit keys above 2^53, which are not all exact as doubles
+  std::vector<uint64_t> pC;
+  for(uint64_t i = 0; i < 40; i++) {
+    pC.push_back((uint64_t(1) << 53) + i);
+  }
+  for(uint64_t i = 0; i < 1000; i++) {
+    pC.push_back((uint64_t(1) << 60) + 3 * i);
+  }
+  for(size_t i = 0; i < 2000; i++) {
+    uint64_t key = i < 50 ? (uint64_t(1) << 53) + i - 5
+                          : (uint64_t(1) << 60) + i - 50;
+    SearchResult res = SearchNSort<uint64_t>::interpolationSearch(pC.data(),
+                                                                  pC.size(),
+                                                                  key);
+    size_t expected = std::lower_bound(pC.begin(), pC.end(), key) -
+                      pC.begin();
+    CHECK(res.index == expected);
+    CHECK(res.found == (expected < pC.size() && pC[expected] == key));
+  }
+  CHECK(1 == SearchNSort<uint64_t>::interpolationSearch(
+                 pC.data(), pC.size(), (uint64_t(1) << 53) + 1)
+                 .index);
+
+  // records searched by a numeric field, and small and empty arrays
+  typedef std::pair<int, char> Item;
+  std::vector<Item> items;
+  for(int i = 0; i < 100; i++) {
+    items.push_back(Item(2 * i, 'a' + i % 26));
+  }
+  auto first = [](const Item &item) { return item.first; };
+  SearchResult res = SearchNSort<Item>::interpolationSearch(
+      items.data(), items.size(), Item(42, '?'), first);
+  CHECK(21 == res.index);
+  CHECK(res.found);
+  res = SearchNSort<Item>::interpolationSearch(items.data(), items.size(),
+                                               Item(43, '?'), first);
+  CHECK(22 == res.index);
+  CHECK(!res.found);
+  CHECK(0 == SearchNSort<Item>::interpolationSearch(items.data(), 0,
+                                                    Item(43, '?'), first)
+                 .index);
+}
+
+/*
+ * Implementation of private median() helper function.
+ */
+template <class T>
+template <class Compare>
+size_t SearchNSort<T>::median(const T *pArr, size_t a, size_t b, size_t c,
+                              Compare &compare) {
+  if (before(compare, pArr[a], pArr[b])) {
+    if (before(compare, pArr[b], pArr[c])) {
+      return b;
+    }
+    return before(compare, pArr[a], pArr[c]) ? c : a;
+  }
+  if (before(compare, pArr[a], pArr[c])) {
+    return a;
+  }
+  return before(compare, pArr[b], pArr[c]) ? c : b;
+}
+
+/*
+ * Implementation of private choosePivot() helper function.
+ */
+template <class T>
+template <class Compare>
+size_t SearchNSort<T>::choosePivot(const T *pArr, size_t lo, size_t hi,
+                                   Compare &compare) {
+  size_t n = hi - lo, mid = lo + n / 2, last = hi - 1;
+  if (n < NINTHER_CUTOFF) {
+    return median(pArr, lo, mid, last, compare);
+  }
+  size_t step = n / 8;
+  return median(pArr,
+                median(pArr, lo, lo + step, lo + 2 * step, compare),
+                median(pArr, mid - step, mid, mid + step, compare),
+                median(pArr, last - 2 * step, last - step, last, compare),
+                compare);
+}
+
+/*
+ * Implementation of public introSort() function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::introSort(T *pArr, size_t n, Compare comp) {
+  introSort(pArr, 0, n, depthLimit(n), comp);
+}
+
+/*
+ * Implementation of private introSort() helper function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::introSort(T *pArr, size_t lo, size_t hi, size_t depth,
+                               Compare &compare) {
+
+  while (hi - lo > leafCutoff(compare)) {
+    // too many lopsided partitions: quicksort is going quadratic
+    if (depth == 0u) {
+      heapSort(pArr + lo, hi - lo, compare);
+      return;
+    }
+    depth--;
+
+    // partition() uses the first element as its pivot
+    std::swap(pArr[lo], pArr[choosePivot(pArr, lo, hi, compare)]);
+    size_t p = partition(pArr, lo, hi - 1, compare) + 1;
+
+    // recurse into the smaller side, and loop on the larger one, so the
+    // stack never holds more than lg n frames
+    if (p - lo < hi - p) {
+      introSort(pArr, lo, p, depth, compare);
+      lo = p;
+    } else {
+      introSort(pArr, p, hi, depth, compare);
+      hi = p;
+    }
+  }
+
+  leafSort(pArr, lo, hi, compare);
+}
+
+// doctest unit test for introSort
+TEST_CASE("testing SearchNSort::introSort") {
+  // make two arrays for sorting
+  int pA[100], pB[100];
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100, 100);
+  for(size_t i = 0; i < 100; i++) {
+    pA[i] = pB[i] = dist(prng);
+  }
+
+  // lambda function for comparing elements for the sort
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+
+  // sort using introSort
+  SearchNSort<int>::introSort(pA, 100, cmp);
+
+  // sort using std::sort
+  std::sort(pB, pB + 100);
+
+  // check elements are the same
+  for(size_t i = 0; i < 100; i++) {
+    CHECK(pA[i] == pB[i]);
+  }
+
+  // inputs that make a first-element pivot quadratic take O(n lg n)
+  // comparisons: sorted, reversed, all equal, and organ pipe
+  const size_t n = 100000;
+  std::vector<int> pattern(n), expected;
+  size_t count = 0;
+  auto counting = [&count](const int &a, const int &b) {
+    count++;
+    return a < b;
+  };
+  for(int kind = 0; kind < 4; kind++) {
+    for(size_t i = 0; i < n; i++) {
+      switch(kind) {
+        case 0: pattern[i] = i; break;
+        case 1: pattern[i] = n - i; break;
+        case 2: pattern[i] = 7; break;
+        default: pattern[i] = i < n / 2 ? i : n - i; break;
+      }
+    }
+    expected = pattern;
+    std::sort(expected.begin(), expected.end());
+
+    count = 0;
+    SearchNSort<int>::introSort(pattern.data(), n, counting);
+    CHECK(pattern == expected);
+    CHECK(count < 4 * n * 17);
+  }
+
+  // empty and single-element arrays
+  SearchNSort<int>::introSort(pA, 0, cmp);
+  SearchNSort<int>::introSort(pA, 1, cmp);
+}
+
+/*
+ * Implementation of linearSearch() function.
+ */
+template <class T>
+template <class Compare>
+int SearchNSort<T>::linearSearch(const T *pArr, size_t n, const T &key,
+                                 Compare comp) {
+
+  for (size_t i = 0u; i < n; i++) {
+    if (order(comp, pArr[i], key) == 0) {
+      return i;
+    }
+  }
+
+  // not found? Return -1 flag value
+  return -1;
+}
+
+// doctest unit test for linearSearch
+TEST_CASE("testing SearchNSort::linearSearch") {
+  // make array for searching; make sure it does not have 0, but does have 1
+  int pA[100];
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100, 100);
+  for(size_t i = 0; i < 100; i++) {
+    int v = dist(prng);
+    pA[i] = v == 0 ? 1 : v;
+  }
+  pA[17] = 1;
+
+  // lambda function for comparing elements for the search
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+
+  // search for 1 should work
+  int idx = SearchNSort<int>::linearSearch(pA, 100, 1, cmp);
+  CHECK(-1 != idx);
+  // search for 0 should not work
+  idx = SearchNSort<int>::linearSearch(pA, 100, 0, cmp);
+  CHECK(-1 == idx);
+}
+
+/*
+ * Implementation of operator== linearSearch() function.
+ */
+template <class T>
+int SearchNSort<T>::linearSearch(const T *pArr, size_t n, const T &key) {
+  size_t i = findEqual(pArr, n, key,
+                       std::integral_constant<bool, SimdVector<T>::AVAILABLE>());
+
+  // not found? Return -1 flag value
+  return i < n ? static_cast<int>(i) : -1;
+}
+
+/*
+ * Implementation of private SIMD findEqual() helper function.
+ */
+template <class T>
+size_t SearchNSort<T>::findEqual(const T *pArr, size_t n, const T &key,
+                                 std::true_type) {
+  typedef SimdVector<T> V;
+  typename V::Reg k = V::broadcast(key);
+  const size_t stride = LINEAR_UNROLL * V::LANES;
+
+  // one branch per LINEAR_UNROLL registers; only on a hit do we look at
+  // which register matched, and which lane
+  size_t i = 0u;
+  for (; i + stride <= n; i += stride) {
+    typename V::Reg pEq[LINEAR_UNROLL];
+    for (size_t r = 0u; r < LINEAR_UNROLL; r++) {
+      pEq[r] = V::equal(V::load(pArr + i + r * V::LANES), k);
+    }
+    typename V::Reg hits = V::any(V::any(pEq[0], pEq[1]),
+                                  V::any(pEq[2], pEq[3]));
+    if (V::mask(hits) != 0u) {
+      for (size_t r = 0u; r < LINEAR_UNROLL; r++) {
+        unsigned mask = V::mask(pEq[r]);
+        if (mask != 0u) {
+          return i + r * V::LANES + lowestBit(mask);
+        }
+      }
+    }
+  }
+
+  // whole registers, then single elements
+  for (; i + V::LANES <= n; i += V::LANES) {
+    unsigned mask = V::mask(V::equal(V::load(pArr + i), k));
+    if (mask != 0u) {
+      return i + lowestBit(mask);
+    }
+  }
+  return i + findEqual(pArr + i, n - i, key, std::false_type());
+}
+
+// doctest unit test for operator== linearSearch
+TEST_CASE("testing SearchNSort::linearSearch with operator==") {
+  // the vector loop is only compiled in with SSE4.1 or AVX2, which the
+  // SNSTestsSse41 and SNSTestsAvx2 targets turn on
+#if defined(__AVX2__) || defined(__SSE4_1__)
+  bool simd = SimdVector<int>::AVAILABLE && SimdVector<float>::AVAILABLE &&
+              SimdVector<double>::AVAILABLE;
+  CHECK(simd);
+#endif
+
+  // the key at every position of arrays of every length up to 80, so that
+  // in the SIMD builds it turns up in each register of the unrolled loop,
+  // in each lane, and in the scalar tail
+  for (size_t n = 0; n <= 80; n++) {
+    std::vector<int> pA(n);
+    std::vector<float> pB(n);
+    std::vector<double> pC(n);
+    for (size_t i = 0; i < n; i++) {
+      pA[i] = static_cast<int>(i) + 1;
+      pB[i] = static_cast<float>(i) + 1.0f;
+      pC[i] = static_cast<double>(i) + 1.0;
+    }
+    CHECK(-1 == SearchNSort<int>::linearSearch(pA.data(), n, 0));
+    CHECK(-1 == SearchNSort<float>::linearSearch(pB.data(), n, 0.0f));
+    CHECK(-1 == SearchNSort<double>::linearSearch(pC.data(), n, 0.0));
+    for (size_t i = 0; i < n; i++) {
+      CHECK(int(i) == SearchNSort<int>::linearSearch(pA.data(), n, pA[i]));
+      CHECK(int(i) == SearchNSort<float>::linearSearch(pB.data(), n, pB[i]));
+      CHECK(int(i) == SearchNSort<double>::linearSearch(pC.data(), n, pC[i]));
+    }
+  }
+
+  // the first of several matches is reported
+  std::vector<int> pD(100, 5);
+  pD[70] = pD[90] = 7;
+  CHECK(70 == SearchNSort<int>::linearSearch(pD.data(), pD.size(), 7));
+  CHECK(0 == SearchNSort<int>::linearSearch(pD.data(), pD.size(), 5));
+
+  // floating-point equality: -0.0 matches 0.0, NaN matches nothing
+  std::vector<double> pE(40, 1.0);
+  pE[33] = -0.0;
+  pE[12] = std::numeric_limits<double>::quiet_NaN();
+  CHECK(33 == SearchNSort<double>::linearSearch(pE.data(), pE.size(), 0.0));
+  CHECK(-1 == SearchNSort<double>::linearSearch(
+                  pE.data(), pE.size(), std::numeric_limits<double>::quiet_NaN()));
+
+  // types without SIMD support take the scalar path
+  std::string pS[] = {"b", "a", "c", "a"};
+  CHECK(1 == SearchNSort<std::string>::linearSearch(pS, 4, "a"));
+  CHECK(-1 == SearchNSort<std::string>::linearSearch(pS, 4, "d"));
+  long pL[] = {3L, 1L, 4L, 1L, 5L};
+  CHECK(4 == SearchNSort<long>::linearSearch(pL, 5, 5L));
+}
+
+/*
+ * Implementation of countMatches() function.
+ */
+template <class T>
+template <class Compare>
+size_t SearchNSort<T>::countMatches(const T *pArr, size_t n, const T &key,
+                                    Compare comp) {
+  size_t count = 0u;
+  for (size_t i = 0u; i < n; i++) {
+    count += order(comp, pArr[i], key) == 0;
+  }
+  return count;
+}
+
+/*
+ * Implementation of operator== countMatches() function.
+ */
+template <class T>
+size_t SearchNSort<T>::countMatches(const T *pArr, size_t n, const T &key) {
+  return countEqual(pArr, n, key,
+                    std::integral_constant<bool, SimdVector<T>::AVAILABLE>());
+}
+
+/*
+ * Implementation of private SIMD countEqual() helper function.
+ */
+template <class T>
+size_t SearchNSort<T>::countEqual(const T *pArr, size_t n, const T &key,
+                                  std::true_type) {
+  typedef SimdVector<T> V;
+  typename V::Reg k = V::broadcast(key);
+  const size_t stride = LINEAR_UNROLL * V::LANES;
+
+  // no branches on the data at all: each register's matches become a mask,
+  // and their bits are counted
+  size_t count = 0u, i = 0u;
+  for (; i + stride <= n; i += stride) {
+    for (size_t r = 0u; r < LINEAR_UNROLL; r++) {
+      count += popCount(V::mask(V::equal(V::load(pArr + i + r * V::LANES),
+                                         k)));
+    }
+  }
+  for (; i + V::LANES <= n; i += V::LANES) {
+    count += popCount(V::mask(V::equal(V::load(pArr + i), k)));
+  }
+  return count + countEqual(pArr + i, n - i, key, std::false_type());
+}
+
+// doctest unit test for countMatches
+TEST_CASE("testing SearchNSort::countMatches") {
+  // the SNSTestsSse41 and SNSTestsAvx2 targets count with the vector loop
+#if defined(__AVX2__) || defined(__SSE4_1__)
+  bool simd = SimdVector<int>::AVAILABLE && SimdVector<double>::AVAILABLE;
+  CHECK(simd);
+#endif
+
+  // random arrays of every length up to 100, with many duplicates; every
+  // version agrees with std::count
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-3, 3);
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+  for (size_t n = 0; n <= 100; n++) {
+    std::vector<int> pA(n);
+    std::vector<double> pB(n);
+    for (size_t i = 0; i < n; i++) {
+      pA[i] = dist(prng);
+      pB[i] = pA[i] / 2.0;
+    }
+    for (int key = -4; key <= 4; key++) {
+      size_t expected = std::count(pA.begin(), pA.end(), key);
+      CHECK(expected == SearchNSort<int>::countMatches(pA.data(), n, key));
+      CHECK(expected ==
+            SearchNSort<int>::countMatches(pA.data(), n, key, cmp));
+      CHECK(expected == SearchNSort<int>::countMatches(pA.data(), n, key,
+                                                       std::less<int>()));
+      CHECK(expected ==
+            SearchNSort<double>::countMatches(pB.data(), n, key / 2.0));
+    }
+  }
+
+  // a comparator on part of the element counts matches by that part
+  std::string pS[] = {"apple", "avocado", "banana", "apricot", "cherry"};
+  auto byFirst = [](const std::string &a, const std::string &b) {
+    return a[0] < b[0];
+  };
+  CHECK(3 == SearchNSort<std::string>::countMatches(pS, 5, "a", byFirst));
+  CHECK(1 == SearchNSort<std::string>::countMatches(pS, 5, "banana"));
+  CHECK(0 == SearchNSort<std::string>::countMatches(pS, 5, "b"));
+}
+
+/*
+ * Implementation of branchless lowerBound() function.
+ */
+template <class T>
+template <class Compare>
+SearchResult SearchNSort<T>::lowerBound(const T *pArr, size_t n, const T &key,
+                                        Compare comp) {
+  SearchResult res = {0, false};
+  if (n == 0u) {
+    return res;
+  }
+
+  // the answer is always in [pBase, pBase + len]; each step halves len
+  const T *pBase = pArr;
+  size_t len = n;
+  while (len > 1u) {
+    size_t half = len / 2;
+    prefetch(pBase + half / 2);
+    prefetch(pBase + half + half / 2);
+    pBase = before(comp, pBase[half], key) ? pBase + half : pBase;
+    len -= half;
+  }
+
+  res.index = (pBase - pArr) + before(comp, *pBase, key);
+  res.found = res.index < n && !before(comp, key, pArr[res.index]);
+  return res;
+}
+
+// doctest unit test for lowerBound
+TEST_CASE("testing SearchNSort::lowerBound") {
+  // every key from below the smallest element to above the largest, on
+  // arrays with duplicates, of every size up to 100
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-50, 50);
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+  for(size_t n = 0; n <= 100; n++) {
+    std::vector<int> pA(n);
+    for(size_t i = 0; i < n; i++) {
+      pA[i] = dist(prng);
+    }
+    std::sort(pA.begin(), pA.end());
+
+    for(int key = -52; key <= 52; key++) {
+      size_t expected = std::lower_bound(pA.begin(), pA.end(), key) - 
+                        pA.begin();
+      bool found = std::binary_search(pA.begin(), pA.end(), key);
+      SearchResult res = SearchNSort<int>::lowerBound(pA.data(), n, key, cmp);
+      CHECK(expected == res.index);
+      CHECK(found == res.found);
+      res = SearchNSort<int>::lowerBound(pA.data(), n, key, std::less<int>());
+      CHECK(expected == res.index);
+      CHECK(found == res.found);
+    }
+  }
+}
+
+/*
+ * Implementation of private merge() function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::merge(T *pA, T *pB, size_t left, size_t right, size_t mid,
+                           Compare &comp) {
+
+  size_t i = left, j = mid;
+
+  for (size_t k = left; k < right; k++) {
+    if (i < mid && (j >= right || !before(comp, pA[j], pA[i]))) {
+      pB[k] = pA[i++];
+    } else {
+      pB[k] = pA[j++];
+    }
+  }
+}
+
+/*
+ * Implementation of public mergeSort() function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::mergeSort(T *pArr, size_t n, Compare comp) {
+  // create temporary array
+  T *pB = new T[n];
+
+  // do the sorting
+  mergeSort(pArr, pB, 0, n, comp);
+
+  // free temporary array
+  delete[] pB;
+}
+
+// doctest unit test for mergeSort
+TEST_CASE("testing SearchNSort::mergeSort") {
+  // make two arrays for sorting
+  int pA[100], pB[100];
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100, 100);
+  for(size_t i = 0; i < 100; i++) {
+    pA[i] = pB[i] = dist(prng);
+  }
+
+  // lambda function for comparing elements for the sort
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+
+  // sort using mergeSort
+  SearchNSort<int>::mergeSort(pA, 100, cmp);
+
+  // sort using std::sort
+  std::sort(pB, pB + 100);
+
+  // check elements are the same
+  for(size_t i = 0; i < 100; i++) {
+    CHECK(pA[i] == pB[i]);
+  }
+}
+
+/*
+ * Implementation of private mergeSort() helper function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::mergeSort(T *pA, T *pB, size_t left, size_t right,
+                               Compare &comp) {
+
+  // array of size one or less is already sorted!
+  if ((right - left) < 2) {
+    return;
+  }
+
+  // small arrays of numbers go to a sorting network
+  if (networkSort(pA + left, right - left, comp)) {
+    return;
+  }
+
+  // otherwise, split, sort, and merge
+  size_t mid = (left + right) / 2;
+  mergeSort(pA, pB, left, mid, comp);
+  mergeSort(pA, pB, mid, right, comp);
+  merge(pA, pB, left, right, mid, comp);
+
+  // copy from scratch back to original array
+  for (size_t i = left; i < right; i++) {
+    pA[i] = pB[i];
+  }
+}
+
+/*
+ * Implementation of msdRadixSort() function.
+ */
+template <class T> void SearchNSort<T>::msdRadixSort(T *pArr, size_t n) {
+  std::vector<T> aux(n);
+  std::vector<unsigned short> cache(n);
+
+  // ranges still to sort, each with the number of characters its strings
+  // share; a stack on the heap rather than recursion, which would use a
+  // frame per shared character
+  struct Bucket {
+    size_t lo, hi, d;
+  };
+  std::vector<Bucket> stack;
+  if (n > 1u) {
+    stack.push_back(Bucket{0, n, 0});
+  }
+  size_t pCount[258];
+  while (!stack.empty()) {
+    Bucket b = stack.back();
+    stack.pop_back();
+    if (b.hi - b.lo <= STRING_CUTOFF) {
+      stringInsertionSort(pArr, b.lo, b.hi, b.d);
+      continue;
+    }
+
+    // one pass over the strings fills the cache and counts each bucket;
+    // bucket 0 is for strings with no character d, bucket c + 1 for c
+    std::fill(pCount, pCount + 258, 0u);
+    for (size_t i = b.lo; i < b.hi; i++) {
+      cache[i] = static_cast<unsigned short>(charAt(pArr[i], b.d) + 1);
+      pCount[cache[i] + 1]++;
+    }
+
+    // every string has the same character d: nothing moves, so go straight
+    // on to the next one
+    size_t first = cache[b.lo];
+    if (first > 0u && pCount[first + 1] == b.hi - b.lo) {
+      b.d++;
+      stack.push_back(b);
+      continue;
+    }
+    for (size_t c = 1; c < 258; c++) {
+      pCount[c] += pCount[c - 1];
+    }
+
+    // distribute from the cache, in order, so the sort is stable;
+    // afterwards pCount[c] is the end of bucket c
+    for (size_t i = b.lo; i < b.hi; i++) {
+      aux[b.lo + pCount[cache[i]]++] = std::move(pArr[i]);
+    }
+    std::move(aux.begin() + b.lo, aux.begin() + b.hi, pArr + b.lo);
+
+    // strings in bucket 0 are equal; the rest share one more character
+    for (size_t c = 1, start = b.lo + pCount[0]; c < 257; c++) {
+      size_t end = b.lo + pCount[c];
+      if (end - start > 1u) {
+        stack.push_back(Bucket{start, end, b.d + 1});
+      }
+      start = end;
+    }
+  }
 }
 
-// doctest unit test for bubbleSort
-TEST_CASE("testing SearchNSort::bubbleSort") {
+// doctest unit test for msdRadixSort
+TEST_CASE("testing SearchNSort::msdRadixSort") {
+  // random strings over a small alphabet, so there are long shared
+  // prefixes and duplicates, plus empty strings and characters above 127
+  std::mt19937_64 prng(time(0));
+  for (size_t n : {0u, 1u, 2u, 16u, 17u, 1000u, 20000u}) {
+    std::vector<std::string> words(n);
+    for (std::string &word : words) {
+      size_t len = prng() % 12;
+      for (size_t i = 0; i < len; i++) {
+        word += "ab\xe9z"[prng() % 4];
+      }
+    }
+    std::vector<std::string> expected = words;
+    std::sort(expected.begin(), expected.end());
+    SearchNSort<std::string>::msdRadixSort(words.data(), n);
+    CHECK(words == expected);
+  }
+
+  // many copies of a few long strings that differ only near the end
+  std::vector<std::string> words;
+  std::string prefix(200, 'x');
+  for (size_t i = 0; i < 3000; i++) {
+    words.push_back(prefix + std::to_string(prng() % 50));
+  }
+  words.push_back(prefix);
+  std::vector<std::string> expected = words;
+  std::sort(expected.begin(), expected.end());
+  SearchNSort<std::string>::msdRadixSort(words.data(), words.size());
+  CHECK(words == expected);
+
+  // a prefix far longer than the stack could hold one frame per character
+  // of, shared by more strings than insertion sort takes
+  words.assign(1000, std::string(100000, 'y'));
+  for (std::string &word : words) {
+    word += std::to_string(prng() % 100);
+  }
+  expected = words;
+  std::sort(expected.begin(), expected.end());
+  SearchNSort<std::string>::msdRadixSort(words.data(), words.size());
+  CHECK(words == expected);
+}
+
+/*
+ * Implementation of private multikeyQuickSort() helper function.
+ */
+template <class T>
+void SearchNSort<T>::multikeyQuickSort(T *pArr, size_t lo, size_t hi,
+                                       size_t d, size_t depth) {
+  while (hi - lo > STRING_CUTOFF) {
+    // too many lopsided partitions at this position
+    if (depth == 0u) {
+      auto suffixLess = [d](const T &a, const T &b) {
+        return a.compare(d, T::npos, b, d, T::npos) < 0;
+      };
+      heapSort(pArr + lo, hi - lo, suffixLess);
+      return;
+    }
+    depth--;
+
+    // the median of three characters is the pivot
+    int a = charAt(pArr[lo], d), b = charAt(pArr[lo + (hi - lo) / 2], d),
+        c = charAt(pArr[hi - 1], d);
+    int pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+    // pArr[lo, lt) has smaller characters, pArr[lt, i) the pivot,
+    // pArr[i, gt) is unseen, and pArr[gt, hi) has greater characters
+    size_t lt = lo, gt = hi, i = lo;
+    while (i < gt) {
+      int ch = charAt(pArr[i], d);
+      if (ch < pivot) {
+        std::swap(pArr[lt++], pArr[i++]);
+      } else if (ch > pivot) {
+        std::swap(pArr[i], pArr[--gt]);
+      } else {
+        i++;
+      }
+    }
+
+    // every string has the pivot character: loop on the next one rather
+    // than recursing once per character of a long shared prefix
+    if (lt == lo && gt == hi && pivot >= 0) {
+      d++;
+      depth = depthLimit(hi - lo);
+      continue;
+    }
+
+    // the equal group moves on to the next character, unless its strings
+    // have all ended; of the other two, recurse into the smaller and loop
+    // on the larger
+    if (pivot >= 0) {
+      multikeyQuickSort(pArr, lt, gt, d + 1, depthLimit(gt - lt));
+    }
+    if (lt - lo < hi - gt) {
+      multikeyQuickSort(pArr, lo, lt, d, depth);
+      lo = gt;
+    } else {
+      multikeyQuickSort(pArr, gt, hi, d, depth);
+      hi = lt;
+    }
+  }
+
+  stringInsertionSort(pArr, lo, hi, d);
+}
+
+// doctest unit test for multikeyQuickSort
+TEST_CASE("testing SearchNSort::multikeyQuickSort") {
+  // the same inputs as for msdRadixSort()
+  std::mt19937_64 prng(time(0));
+  for (size_t n : {0u, 1u, 2u, 16u, 17u, 1000u, 20000u}) {
+    std::vector<std::string> words(n);
+    for (std::string &word : words) {
+      size_t len = prng() % 12;
+      for (size_t i = 0; i < len; i++) {
+        word += "ab\xe9z"[prng() % 4];
+      }
+    }
+    std::vector<std::string> expected = words;
+    std::sort(expected.begin(), expected.end());
+    SearchNSort<std::string>::multikeyQuickSort(words.data(), n);
+    CHECK(words == expected);
+  }
+
+  std::vector<std::string> words;
+  std::string prefix(200, 'x');
+  for (size_t i = 0; i < 3000; i++) {
+    words.push_back(prefix + std::to_string(prng() % 50));
+  }
+  words.push_back(prefix);
+  std::vector<std::string> expected = words;
+  std::sort(expected.begin(), expected.end());
+  SearchNSort<std::string>::multikeyQuickSort(words.data(), words.size());
+  CHECK(words == expected);
+
+  // sorted and reversed words still sort
+  SearchNSort<std::string>::multikeyQuickSort(words.data(), words.size());
+  CHECK(words == expected);
+  std::reverse(words.begin(), words.end());
+  SearchNSort<std::string>::multikeyQuickSort(words.data(), words.size());
+  CHECK(words == expected);
+
+  // a prefix far longer than the stack could hold one frame per character
+  // of
+  words.assign(1000, std::string(100000, 'y'));
+  for (std::string &word : words) {
+    word += std::to_string(prng() % 100);
+  }
+  expected = words;
+  std::sort(expected.begin(), expected.end());
+  SearchNSort<std::string>::multikeyQuickSort(words.data(), words.size());
+  CHECK(words == expected);
+}
+
+/*
+ * Implementation of nthElement() function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::nthElement(T *pArr, size_t n, size_t k, Compare comp) {
+  if (k >= n) {
+    throw std::out_of_range("Index out of range in SearchNSort::nthElement()");
+  }
+
+  size_t lo = 0, hi = n, depth = depthLimit(n);
+  while (hi - lo > leafCutoff(comp)) {
+    if (depth == 0u) {
+      heapSort(pArr + lo, hi - lo, comp);
+      return;
+    }
+    depth--;
+
+    // partition as threeWayQuickSort() does, but keep only the side
+    // holding k; if k is among the elements equal to the pivot, it is done
+    std::swap(pArr[lo], pArr[choosePivot(pArr, lo, hi, comp)]);
+    size_t lt, gt;
+    partitionThreeWay(pArr, lo, hi, lt, gt, comp);
+    if (k < lt) {
+      hi = lt;
+    } else if (k >= gt) {
+      lo = gt;
+    } else {
+      return;
+    }
+  }
+
+  leafSort(pArr, lo, hi, comp);
+}
+
+// doctest unit test for nthElement
+TEST_CASE("testing SearchNSort::nthElement") {
+  // every k of random arrays of several sizes, with and without many
+  // duplicates, against a sorted copy
+  std::mt19937_64 prng(time(0));
+  auto cmp = [](const int &a, const int &b) { return a - b; };
+  for (size_t n : {1u, 2u, 17u, 100u, 1000u}) {
+    for (int range : {3, 1000000}) {
+      std::uniform_int_distribution<int> dist(0, range);
+      std::vector<int> keys(n);
+      for (int &key : keys) {
+        key = dist(prng);
+      }
+      std::vector<int> expected = keys;
+      std::sort(expected.begin(), expected.end());
+
+      for (size_t k = 0; k < n; k += 1 + n / 50) {
+        std::vector<int> pA = keys;
+        SearchNSort<int>::nthElement(pA.data(), n, k, cmp);
+        CHECK(expected[k] == pA[k]);
+        CHECK(std::all_of(pA.begin(), pA.begin() + k,
+                          [&](int x) { return x <= pA[k]; }));
+        CHECK(std::all_of(pA.begin() + k, pA.end(),
+                          [&](int x) { return x >= pA[k]; }));
+      }
+    }
+  }
+
+  // selection takes a linear number of comparisons, even on inputs that
+  // are bad for a first-element pivot
+  const size_t n = 100000;
+  std::vector<int> keys(n);
+  size_t count = 0;
+  auto counting = [&count](const int &a, const int &b) {
+    count++;
+    return a < b;
+  };
+  for (int kind = 0; kind < 3; kind++) {
+    for (size_t i = 0; i < n; i++) {
+      keys[i] = kind == 0 ? int(i) : (kind == 1 ? int(n - i) : int(prng()));
+    }
+    std::vector<int> expected = keys;
+    std::sort(expected.begin(), expected.end());
+    count = 0;
+    SearchNSort<int>::nthElement(keys.data(), n, n / 2, counting);
+    CHECK(expected[n / 2] == keys[n / 2]);
+    CHECK(count < 8 * n);
+  }
+
+  // k past the end
+  bool flag = false;
+  try {
+    SearchNSort<int>::nthElement(keys.data(), n, n, counting);
+  } catch (const std::out_of_range &) {
+    flag = true;
+  }
+  CHECK(flag);
+}
+
+/*
+ * Implementation of partialSort() function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::partialSort(T *pArr, size_t n, size_t k, Compare comp) {
+  if (k >= n) {
+    introSort(pArr, 0, n, depthLimit(n), comp);
+    return;
+  }
+  if (k == 0u) {
+    return;
+  }
+
+  // pArr[k - 1] is in place, and everything before it is no greater
+  nthElement(pArr, n, k - 1, comp);
+  introSort(pArr, 0, k - 1, depthLimit(k - 1), comp);
+}
+
+// doctest unit test for partialSort
+TEST_CASE("testing SearchNSort::partialSort") {
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-1000, 1000);
+  const size_t n = 1000;
+  std::vector<int> keys(n);
+  for (int &key : keys) {
+    key = dist(prng);
+  }
+  std::vector<int> expected = keys;
+  std::sort(expected.begin(), expected.end());
+
+  // the first k elements are the k smallest, in order, and the rest are
+  // the other elements
+  for (size_t k : {0u, 1u, 2u, 10u, 500u, 999u, 1000u, 2000u}) {
+    std::vector<int> pA = keys;
+    SearchNSort<int>::partialSort(pA.data(), n, k, std::less<int>());
+    size_t m = std::min(k, n);
+    CHECK(std::equal(pA.begin(), pA.begin() + m, expected.begin()));
+    std::sort(pA.begin() + m, pA.end());
+    CHECK(std::equal(pA.begin() + m, pA.end(), expected.begin() + m));
+  }
+
+  // descending order with a function-pointer comparator
+  SearchNSort<int>::CompareFn descending = [](const int &a, const int &b) {
+    return b - a;
+  };
+  std::vector<int> pB = keys;
+  SearchNSort<int>::partialSort(pB.data(), n, 3, descending);
+  CHECK(expected[n - 1] == pB[0]);
+  CHECK(expected[n - 2] == pB[1]);
+  CHECK(expected[n - 3] == pB[2]);
+
+  // empty array
+  SearchNSort<int>::partialSort(pB.data(), 0, 5, descending);
+}
+
+/*
+ * Implementation of permute() function.
+ */
+template <class T>
+void SearchNSort<T>::permute(T *pArr, size_t n, size_t *pOrder) {
+  for (size_t start = 0; start < n; start++) {
+    if (pOrder[start] == start) {
+      continue;
+    }
+
+    // walk the cycle through start; a position already marked done, or
+    // an index out of range, means pOrder is not a permutation
+    T held = std::move(pArr[start]);
+    size_t i = start;
+    while (pOrder[i] != start) {
+      size_t next = pOrder[i];
+      if (next >= n || next == i) {
+        throw std::out_of_range("Invalid permutation in "
+                                "SearchNSort::permute()");
+      }
+      pArr[i] = std::move(pArr[next]);
+      pOrder[i] = i;
+      i = next;
+    }
+    pArr[i] = std::move(held);
+    pOrder[i] = i;
+  }
+}
+
+// doctest unit test for permute
+TEST_CASE("testing SearchNSort::permute") {
+  // random permutations of strings, against building the result in a copy
+  std::mt19937_64 prng(time(0));
+  for (size_t n : {0u, 1u, 2u, 3u, 100u, 1000u}) {
+    std::vector<std::string> words(n);
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; i++) {
+      words[i] = std::to_string(i);
+      order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), prng);
+
+    std::vector<std::string> expected(n);
+    for (size_t i = 0; i < n; i++) {
+      expected[i] = words[order[i]];
+    }
+    SearchNSort<std::string>::permute(words.data(), n, order.data());
+    CHECK(words == expected);
+    for (size_t i = 0; i < n; i++) {
+      CHECK(i == order[i]);
+    }
+  }
+
+  // repeated and out-of-range indices are caught
+  int pA[] = {10, 20, 30, 40};
+  size_t pBad[][4] = {{1, 1, 2, 3}, {3, 0, 1, 4}, {0, 2, 2, 1}};
+  for (size_t *pOrder : pBad) {
+    bool flag = false;
+    try {
+      SearchNSort<int>::permute(pA, 4, pOrder);
+    } catch (const std::out_of_range &) {
+      flag = true;
+    }
+    CHECK(flag);
+  }
+}
+
+/*
+ * Implementation of partition() helper function.
+ */
+template <class T>
+template <class Compare>
+size_t SearchNSort<T>::partition(T *pArr, size_t lo, size_t hi,
+                                 Compare &compare) {
+
+  // arbitrarily choose first value in range as pivot value; copy it, since
+  // the element at lo may be swapped away before partitioning is done
+  const T pivot = pArr[lo];
+
+  // indices to slide right and left
+  size_t i = lo - 1;
+  size_t j = hi + 1;
+
+  while (true) {
+    // slide i right until we find value >= pivot
+    while (before(compare, pArr[++i], pivot))
+      ; // empty loop body
+
+    // slide j left until we find value <= pivot
+    while (before(compare, pivot, pArr[--j]))
+      ; // empty loop body
+
+    // if the indices have crossed, j is the pivot index
+    if (i >= j) {
+      return j;
+    }
+
+    // if not, swap the out of place elements and continue
+    // sliding i and j
+    std::swap(pArr[i], pArr[j]);
+  }
+}
+
+// doctest unit test for quickSort
+TEST_CASE("testing SearchNSort::quickSort") {
   // make two arrays for sorting
   int pA[100], pB[100];
   std::mt19937_64 prng(time(0));
@@ -260,8 +3039,104 @@ TEST_CASE("testing SearchNSort::bubbleSort") {
   // lambda function for comparing elements for the sort
   auto cmp = [](const int &a, const int &b) { return a - b; };
 
-  // sort using bubbleSort
-  SearchNSort<int>::bubbleSort(pA, 100, cmp);
+  // sort using quickSort
+  SearchNSort<int>::quickSort(pA, 100, cmp);
+
+  // sort using std::sort
+  std::sort(pB, pB + 100);
+
+  // check elements are the same
+  for(size_t i = 0; i < 100; i++) {
+    CHECK(pA[i] == pB[i]);
+  }
+
+  // sorted and reversed input, which took a first-element pivot quadratic
+  // time and linear stack depth, now costs O(n lg n) comparisons; lg n is
+  // about 18 here
+  const size_t n = 200000;
+  size_t count = 0;
+  auto counting = [&count](const int &a, const int &b) {
+    count++;
+    return a < b;
+  };
+  std::vector<int> sorted(n);
+  for(size_t i = 0; i < n; i++) {
+    sorted[i] = int(i);
+  }
+  std::vector<int> pC = sorted;
+  SearchNSort<int>::quickSort(pC.data(), n, counting);
+  CHECK(pC == sorted);
+  std::reverse(pC.begin(), pC.end());
+  SearchNSort<int>::quickSort(pC.data(), n, counting);
+  CHECK(pC == sorted);
+  CHECK(count < 2 * 3 * n * 18);
+}
+
+/*
+ * Implementation of radixSort() function.
+ */
+template <class T>
+template <class KeyOf>
+void SearchNSort<T>::radixSort(T *pArr, size_t n, KeyOf key) {
+  typedef decltype(radixKey(key(*pArr))) Key;
+  const size_t numBytes = sizeof(Key);
+  if (n < 2u) {
+    return;
+  }
+
+  // one histogram per byte of the key, all from a single pass
+  std::vector<size_t> counts(numBytes * 256, 0u);
+  for (size_t i = 0; i < n; i++) {
+    Key k = radixKey(key(pArr[i]));
+    for (size_t b = 0; b < numBytes; b++) {
+      counts[b * 256 + ((k >> (8 * b)) & 0xFF)]++;
+    }
+  }
+
+  T *pB = new T[n];
+  T *pSrc = pArr, *pDst = pB;
+  Key first = radixKey(key(pArr[0]));
+  for (size_t b = 0; b < numBytes; b++) {
+    // if every key has the same value in this byte, the pass would not
+    // move anything
+    size_t *pCount = &counts[b * 256];
+    if (pCount[(first >> (8 * b)) & 0xFF] == n) {
+      continue;
+    }
+
+    // turn the counts into starting offsets, then deal the elements out
+    size_t offset = 0;
+    for (size_t d = 0; d < 256; d++) {
+      size_t c = pCount[d];
+      pCount[d] = offset;
+      offset += c;
+    }
+    for (size_t i = 0; i < n; i++) {
+      Key k = radixKey(key(pSrc[i]));
+      pDst[pCount[(k >> (8 * b)) & 0xFF]++] = pSrc[i];
+    }
+    std::swap(pSrc, pDst);
+  }
+
+  // an odd number of passes leaves the result in the scratch array
+  if (pSrc != pArr) {
+    std::copy(pSrc, pSrc + n, pArr);
+  }
+  delete[] pB;
+}
+
+// doctest unit test for radixSort
+TEST_CASE("testing SearchNSort::radixSort") {
+  // make two arrays for sorting
+  int pA[100], pB[100];
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100, 100);
+  for(size_t i = 0; i < 100; i++) {
+    pA[i] = pB[i] = dist(prng);
+  }
+
+  // sort using radixSort
+  SearchNSort<int>::radixSort(pA, 100);
 
   // sort using std::sort
   std::sort(pB, pB + 100);
@@ -270,26 +3145,98 @@ TEST_CASE("testing SearchNSort::bubbleSort") {
   for(size_t i = 0; i < 100; i++) {
     CHECK(pA[i] == pB[i]);
   }
+
+  // full-range 64-bit keys, signed and unsigned
+  const size_t n = 10000;
+  std::vector<int64_t> signedKeys(n), signedExpected;
+  std::vector<uint64_t> unsignedKeys(n), unsignedExpected;
+  for(size_t i = 0; i < n; i++) {
+    unsignedKeys[i] = prng();
+    signedKeys[i] = static_cast<int64_t>(prng());
+  }
+  signedKeys[0] = INT64_MIN;
+  signedKeys[1] = INT64_MAX;
+  signedExpected = signedKeys;
+  unsignedExpected = unsignedKeys;
+  std::sort(signedExpected.begin(), signedExpected.end());
+  std::sort(unsignedExpected.begin(), unsignedExpected.end());
+  SearchNSort<int64_t>::radixSort(signedKeys.data(), n);
+  SearchNSort<uint64_t>::radixSort(unsignedKeys.data(), n);
+  CHECK(signedKeys == signedExpected);
+  CHECK(unsignedKeys == unsignedExpected);
+
+  // floating point, including negatives, zeros and infinities
+  std::uniform_real_distribution<double> real(-1e6, 1e6);
+  std::vector<double> doubles(n), doublesExpected;
+  std::vector<float> floats(n), floatsExpected;
+  for(size_t i = 0; i < n; i++) {
+    doubles[i] = real(prng);
+    floats[i] = static_cast<float>(real(prng));
+  }
+  doubles[0] = -0.0;
+  doubles[1] = 0.0;
+  doubles[2] = std::numeric_limits<double>::infinity();
+  doubles[3] = -std::numeric_limits<double>::infinity();
+  doubles[4] = std::numeric_limits<double>::denorm_min();
+  floats[0] = -std::numeric_limits<float>::infinity();
+  floats[1] = std::numeric_limits<float>::max();
+  doublesExpected = doubles;
+  floatsExpected = floats;
+  std::sort(doublesExpected.begin(), doublesExpected.end());
+  std::sort(floatsExpected.begin(), floatsExpected.end());
+  SearchNSort<double>::radixSort(doubles.data(), n);
+  SearchNSort<float>::radixSort(floats.data(), n);
+  CHECK(floats == floatsExpected);
+  CHECK(doubles == doublesExpected);
+
+  // -0.0 == 0.0, but its mapped key is smaller, so it comes first
+  size_t zero = std::find(doubles.begin(), doubles.end(), 0.0) - doubles.begin();
+  CHECK(std::signbit(doubles[zero]));
+  CHECK(!std::signbit(doubles[zero + 1]));
+
+  // records by a key extractor; the sort is stable, and keys in a small
+  // range take a single pass
+  typedef std::pair<short, size_t> Item;
+  std::vector<Item> items(n), itemsExpected;
+  std::uniform_int_distribution<short> small(-50, 50);
+  for(size_t i = 0; i < n; i++) {
+    items[i] = Item(small(prng), i);
+  }
+  itemsExpected = items;
+  std::stable_sort(itemsExpected.begin(), itemsExpected.end(),
+                   [](const Item &a, const Item &b) {
+                     return a.first < b.first;
+                   });
+  SearchNSort<Item>::radixSort(items.data(), n,
+                               [](const Item &x) { return x.first; });
+  CHECK(items == itemsExpected);
 }
 
 /*
- * Implementation of insertionSort() function.
+ * Implementation of selectionSort() function.
  */
 template <class T>
-void SearchNSort<T>::insertionSort(T *pArr, size_t n,
-                                   int (*comp)(const T &x, const T &y)) {
+template <class Compare>
+void SearchNSort<T>::selectionSort(T *pArr, size_t n, Compare comp) {
+  size_t i, j, minIndex;
 
-  for (size_t i = 1u; i < n; i++) {
-    size_t j = i;
-    while (j > 0u && comp(pArr[j - 1], pArr[j]) > 0) {
-      std::swap(pArr[j], pArr[j - 1]);
-      j--;
+  for (i = 0u; i < n - 1u; i++) {
+
+    minIndex = i;
+    for (j = i + 1u; j < n; j++) {
+      if (before(comp, pArr[j], pArr[minIndex])) {
+        minIndex = j;
+      }
+    }
+
+    if (minIndex != i) {
+      std::swap(pArr[i], pArr[minIndex]);
     }
   }
 }
 
-// doctest unit test for insertionSort
-TEST_CASE("testing SearchNSort::insertionSort") {
+// doctest unit test for selectionSort
+TEST_CASE("testing SearchNSort::selectionSort") {
   // make two arrays for sorting
   int pA[100], pB[100];
   std::mt19937_64 prng(time(0));
@@ -301,8 +3248,8 @@ TEST_CASE("testing SearchNSort::insertionSort") {
   // lambda function for comparing elements for the sort
   auto cmp = [](const int &a, const int &b) { return a - b; };
 
-  // sort using insertionSort
-  SearchNSort<int>::insertionSort(pA, 100, cmp);
+  // sort using selectionSort
+  SearchNSort<int>::selectionSort(pA, 100, cmp);
 
   // sort using std::sort
   std::sort(pB, pB + 100);
@@ -314,81 +3261,161 @@ TEST_CASE("testing SearchNSort::insertionSort") {
 }
 
 /*
- * Implementation of linearSearch() function.
+ * Implementation of private stringInsertionSort() helper function.
  */
 template <class T>
-int SearchNSort<T>::linearSearch(const T *pArr, size_t n, const T &key,
-                                 int (*comp)(const T &x, const T &y)) {
-
-  for (size_t i = 0u; i < n; i++) {
-    if (comp(pArr[i], key) == 0) {
-      return i;
+void SearchNSort<T>::stringInsertionSort(T *pArr, size_t lo, size_t hi,
+                                         size_t d) {
+  for (size_t i = lo + 1; i < hi; i++) {
+    // compare() skips straight past the shared prefix
+    T value = std::move(pArr[i]);
+    size_t j = i;
+    for (; j > lo && value.compare(d, T::npos, pArr[j - 1], d, T::npos) < 0;
+         j--) {
+      pArr[j] = std::move(pArr[j - 1]);
     }
+    pArr[j] = std::move(value);
   }
+}
 
-  // not found? Return -1 flag value
-  return -1;
+/*
+ * Implementation of sortByKey() function.
+ */
+template <class T>
+template <class KeyOf, class Compare>
+void SearchNSort<T>::sortByKey(T *pArr, size_t n, KeyOf keyOf,
+                               Compare compare) {
+  std::vector<size_t> order(n);
+  argSort(pArr, n, order.data(), keyOf, compare);
+  permute(pArr, n, order.data());
 }
 
-// doctest unit test for linearSearch
-TEST_CASE("testing SearchNSort::linearSearch") {
-  // make array for searching; make sure it does not have 0, but does have 1
-  int pA[100];
+// doctest unit test for sortByKey
+TEST_CASE("testing SearchNSort::sortByKey") {
+  // large records that count how often they are moved or copied
+  struct Record {
+    int key;
+    size_t id;
+    char payload[256];
+    static size_t &moves() {
+      static size_t count = 0;
+      return count;
+    }
+    Record() : key(0), id(0) {}
+    Record(const Record &r) : key(r.key), id(r.id) {
+      std::memcpy(payload, r.payload, sizeof(payload));
+      moves()++;
+    }
+    Record &operator=(const Record &r) {
+      key = r.key;
+      id = r.id;
+      std::memcpy(payload, r.payload, sizeof(payload));
+      moves()++;
+      return *this;
+    }
+  };
+
   std::mt19937_64 prng(time(0));
-  std::uniform_int_distribution<int> dist(-100, 100);
-  for(size_t i = 0; i < 100; i++) {
-    int v = dist(prng);
-    pA[i] = v == 0 ? 1 : v;
+  std::uniform_int_distribution<int> dist(0, 100);
+  const size_t n = 10000;
+  std::vector<Record> records(n);
+  for (size_t i = 0; i < n; i++) {
+    records[i].key = dist(prng);
+    records[i].id = i;
+    records[i].payload[0] = char(i);
+  }
+  std::vector<std::pair<int, size_t>> expected;
+  for (const Record &r : records) {
+    expected.push_back(std::make_pair(r.key, r.id));
+  }
+  std::stable_sort(expected.begin(), expected.end(),
+                   [](const std::pair<int, size_t> &a,
+                      const std::pair<int, size_t> &b) {
+                     return a.first < b.first;
+                   });
+
+  // sorted stably, with each record moved at most twice
+  Record::moves() = 0;
+  SearchNSort<Record>::sortByKey(records.data(), n,
+                                 [](const Record &r) { return r.key; });
+  CHECK(Record::moves() <= 2 * n);
+  for (size_t i = 0; i < n; i++) {
+    CHECK(expected[i].first == records[i].key);
+    CHECK(expected[i].second == records[i].id);
+    CHECK(char(records[i].id) == records[i].payload[0]);
   }
-  pA[17] = 1;
-
-  // lambda function for comparing elements for the search
-  auto cmp = [](const int &a, const int &b) { return a - b; };
-
-  // search for 1 should work
-  int idx = SearchNSort<int>::linearSearch(pA, 100, 1, cmp);
-  CHECK(-1 != idx);
-  // search for 0 should not work
-  idx = SearchNSort<int>::linearSearch(pA, 100, 0, cmp);
-  CHECK(-1 == idx);
 }
 
 /*
- * Implementation of private merge() function.
+ * Implementation of partitionThreeWay() helper function.
  */
 template <class T>
-void SearchNSort<T>::merge(T *pA, T *pB, size_t left, size_t right, size_t mid,
-                           int (*comp)(const T &x, const T &y)) {
-
-  size_t i = left, j = mid;
-
-  for (size_t k = left; k < right; k++) {
-    if (i < mid && (j >= right || comp(pA[i], pA[j]) <= 0)) {
-      pB[k] = pA[i++];
+template <class Compare>
+void SearchNSort<T>::partitionThreeWay(T *pArr, size_t lo, size_t hi,
+                                       size_t &lt, size_t &gt,
+                                       Compare &compare) {
+  const T pivot = pArr[lo];
+
+  // pArr[lo, lt) < pivot, pArr[lt, i) == pivot, pArr[i, gt) unseen, and
+  // pArr[gt, hi) > pivot
+  lt = lo;
+  gt = hi;
+  size_t i = lo;
+  while (i < gt) {
+    int res = order(compare, pArr[i], pivot);
+    if (res < 0) {
+      std::swap(pArr[lt++], pArr[i++]);
+    } else if (res > 0) {
+      std::swap(pArr[i], pArr[--gt]);
     } else {
-      pB[k] = pA[j++];
+      i++;
     }
   }
 }
 
 /*
- * Implementation of public mergeSort() function.
+ * Implementation of public threeWayQuickSort() function.
  */
 template <class T>
-void SearchNSort<T>::mergeSort(T *pArr, size_t n,
-                               int (*comp)(const T &x, const T &y)) {
-  // create temporary array
-  T *pB = new T[n];
+template <class Compare>
+void SearchNSort<T>::threeWayQuickSort(T *pArr, size_t n, Compare comp) {
+  threeWayQuickSort(pArr, 0, n, depthLimit(n), comp);
+}
 
-  // do the sorting
-  mergeSort(pArr, pB, 0, n, comp);
+/*
+ * Implementation of private threeWayQuickSort() helper function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::threeWayQuickSort(T *pArr, size_t lo, size_t hi,
+                                       size_t depth, Compare &compare) {
+
+  while (hi - lo > leafCutoff(compare)) {
+    if (depth == 0u) {
+      heapSort(pArr + lo, hi - lo, compare);
+      return;
+    }
+    depth--;
 
-  // free temporary array
-  delete[] pB;
+    std::swap(pArr[lo], pArr[choosePivot(pArr, lo, hi, compare)]);
+    size_t lt, gt;
+    partitionThreeWay(pArr, lo, hi, lt, gt, compare);
+
+    // the equal group is done; recurse into the smaller of the other two
+    if (lt - lo < hi - gt) {
+      threeWayQuickSort(pArr, lo, lt, depth, compare);
+      lo = gt;
+    } else {
+      threeWayQuickSort(pArr, gt, hi, depth, compare);
+      hi = lt;
+    }
+  }
+
+  leafSort(pArr, lo, hi, compare);
 }
 
-// doctest unit test for mergeSort
-TEST_CASE("testing SearchNSort::mergeSort") {
+// doctest unit test for threeWayQuickSort
+TEST_CASE("testing SearchNSort::threeWayQuickSort") {
   // make two arrays for sorting
   int pA[100], pB[100];
   std::mt19937_64 prng(time(0));
@@ -400,8 +3427,8 @@ TEST_CASE("testing SearchNSort::mergeSort") {
   // lambda function for comparing elements for the sort
   auto cmp = [](const int &a, const int &b) { return a - b; };
 
-  // sort using mergeSort
-  SearchNSort<int>::mergeSort(pA, 100, cmp);
+  // sort using threeWayQuickSort
+  SearchNSort<int>::threeWayQuickSort(pA, 100, cmp);
 
   // sort using std::sort
   std::sort(pB, pB + 100);
@@ -410,155 +3437,584 @@ TEST_CASE("testing SearchNSort::mergeSort") {
   for(size_t i = 0; i < 100; i++) {
     CHECK(pA[i] == pB[i]);
   }
+
+  // with only a handful of distinct keys, each partitioning pass retires
+  // a whole key, so the number of comparisons is linear in n
+  const size_t n = 100000;
+  std::vector<int> keys(n), expected;
+  std::uniform_int_distribution<int> few(0, 4);
+  for(size_t i = 0; i < n; i++) {
+    keys[i] = few(prng);
+  }
+  expected = keys;
+  std::sort(expected.begin(), expected.end());
+  size_t count = 0;
+  auto counting = [&count](const int &a, const int &b) {
+    count++;
+    return a - b;
+  };
+  SearchNSort<int>::threeWayQuickSort(keys.data(), n, counting);
+  CHECK(keys == expected);
+  CHECK(count < 5 * n);
+
+  // sorted and reversed input still split evenly
+  for(size_t i = 0; i < n; i++) {
+    keys[i] = n - i;
+  }
+  SearchNSort<int>::threeWayQuickSort(keys.data(), n, std::less<int>());
+  CHECK(std::is_sorted(keys.begin(), keys.end()));
+  SearchNSort<int>::threeWayQuickSort(keys.data(), n, std::less<int>());
+  CHECK(std::is_sorted(keys.begin(), keys.end()));
 }
 
 /*
- * Implementation of private mergeSort() helper function.
+ * Implementation of timSort() function.
  */
 template <class T>
-void SearchNSort<T>::mergeSort(T *pA, T *pB, size_t left, size_t right,
-                               int (*comp)(const T &x, const T &y)) {
-
-  // array of size one or less is already sorted!
-  if ((right - left) < 2) {
+template <class Compare>
+void SearchNSort<T>::timSort(T *pArr, size_t n, Compare comp) {
+  if (n < 2u) {
     return;
   }
 
-  // otherwise, split, sort, and merge
-  size_t mid = (left + right) / 2;
-  mergeSort(pA, pB, left, mid, comp);
-  mergeSort(pA, pB, mid, right, comp);
-  merge(pA, pB, left, right, mid, comp);
+  TimState<Compare> state = {pArr, comp, std::vector<TimRun>(),
+                             std::vector<T>(), MIN_GALLOP};
+  size_t minRun = minRunLength(n);
+  for (size_t lo = 0u; lo < n;) {
+    // take the next natural run, extending it to minRun if it is short
+    size_t hi = countRun(pArr, lo, n, comp);
+    if (hi - lo < minRun) {
+      size_t end = std::min(n, lo + minRun);
+      binaryInsertionSort(pArr, lo, end, hi, comp);
+      hi = end;
+    }
 
-  // copy from scratch back to original array
-  for (size_t i = left; i < right; i++) {
-    pA[i] = pB[i];
+    TimRun run = {lo, hi - lo};
+    state.runs.push_back(run);
+    mergeCollapse(state, false);
+    lo = hi;
   }
+  mergeCollapse(state, true);
 }
 
 /*
- * Implementation of partition() helper function.
+ * Implementation of private countRun() helper function.
  */
 template <class T>
-size_t SearchNSort<T>::partition(T *pArr, size_t lo, size_t hi,
-                              int (*compare)(const T &x, const T &y)) {
-
-  // arbitrarily choose first value in range as pivot value
-  const T &pivot = pArr[lo];
-
-  // indices to slide right and left
-  size_t i = lo - 1;
-  size_t j = hi + 1;
-
-  while (true) {
-    // slide i right until we find value >= pivot
-    while (compare(pArr[++i], pivot) < 0)
-      ; // empty loop body
-
-    // slide j left until we find value <= pivot
-    while (compare(pArr[--j], pivot) > 0)
-      ; // empty loop body
+template <class Compare>
+size_t SearchNSort<T>::countRun(T *pArr, size_t lo, size_t hi,
+                                Compare &compare) {
+  size_t end = lo + 1;
+  if (end == hi) {
+    return hi;
+  }
 
-    // if the indices have crossed, j is the pivot index
-    if (i >= j) {
-      return j;
+  // a descending run must be strict, or reversing it would not be stable
+  if (before(compare, pArr[end], pArr[lo])) {
+    for (end++; end < hi && before(compare, pArr[end], pArr[end - 1]);
+         end++) {
+    }
+    std::reverse(pArr + lo, pArr + end);
+  } else {
+    for (end++; end < hi && !before(compare, pArr[end], pArr[end - 1]);
+         end++) {
     }
-
-    // if not, swap the out of place elements and continue
-    // sliding i and j
-    std::swap(pArr[i], pArr[j]);
   }
+  return end;
 }
 
 /*
- * Implementation of recursive quickSort() helper function.
+ * Implementation of private binaryInsertionSort() helper function.
  */
 template <class T>
-void SearchNSort<T>::quickSort(T *pArr, size_t lo, size_t hi,
-                               int (*compare)(const T &x, const T &y)) {
+template <class Compare>
+void SearchNSort<T>::binaryInsertionSort(T *pArr, size_t lo, size_t hi,
+                                         size_t start, Compare &compare) {
+  for (size_t i = std::max(start, lo + 1); i < hi; i++) {
+    // find the first element greater than the new one
+    size_t left = lo, right = i;
+    while (left < right) {
+      size_t mid = left + (right - left) / 2;
+      if (before(compare, pArr[i], pArr[mid])) {
+        right = mid;
+      } else {
+        left = mid + 1;
+      }
+    }
 
-  // portion of size 0 or 1 is already sorted!
-  if (lo < hi) {
+    T value = std::move(pArr[i]);
+    std::move_backward(pArr + left, pArr + i, pArr + i + 1);
+    pArr[left] = std::move(value);
+  }
+}
 
-    // array portion of array so pArr[lo, p - 1] is <= pArr[p],
-    // and pArr[p + 1, hi) is >= pArr[p]
-    size_t p = partition(pArr, lo, hi, compare);
+/*
+ * Implementation of private gallopLeft() helper function.
+ */
+template <class T>
+template <class Compare>
+size_t SearchNSort<T>::gallopLeft(const T &key, const T *pRun, size_t len,
+                                  size_t hint, Compare &compare) {
+  // gallop away from the hint by offsets 1, 3, 7, ... until key is
+  // bracketed: pRun[lo] < key <= pRun[hi], with lo = -1 or hi = len meaning
+  // past the ends
+  std::ptrdiff_t lo, hi;
+  std::ptrdiff_t h = hint, n = len, last = 0, ofs = 1;
+  if (before(compare, pRun[h], key)) {
+    std::ptrdiff_t maxOfs = n - h;
+    while (ofs < maxOfs && before(compare, pRun[h + ofs], key)) {
+      last = ofs;
+      ofs = 2 * ofs + 1;
+    }
+    lo = h + last;
+    hi = h + std::min(ofs, maxOfs);
+  } else {
+    std::ptrdiff_t maxOfs = h + 1;
+    while (ofs < maxOfs && !before(compare, pRun[h - ofs], key)) {
+      last = ofs;
+      ofs = 2 * ofs + 1;
+    }
+    lo = h - std::min(ofs, maxOfs);
+    hi = h - last;
+  }
 
-    // recursively sort left and right halves
-    quickSort(pArr, lo, p, compare);
-    quickSort(pArr, p + 1, hi, compare);
+  // then binary search between the brackets
+  for (lo++; lo < hi;) {
+    std::ptrdiff_t mid = lo + (hi - lo) / 2;
+    if (before(compare, pRun[mid], key)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
   }
+  return hi;
 }
 
-// doctest unit test for quickSort
-TEST_CASE("testing SearchNSort::quickSort") {
-  // make two arrays for sorting
-  int pA[100], pB[100];
-  std::mt19937_64 prng(time(0));
-  std::uniform_int_distribution<int> dist(-100, 100);
-  for(size_t i = 0; i < 100; i++) {
-    pA[i] = pB[i] = dist(prng);
+/*
+ * Implementation of private gallopRight() helper function.
+ */
+template <class T>
+template <class Compare>
+size_t SearchNSort<T>::gallopRight(const T &key, const T *pRun, size_t len,
+                                   size_t hint, Compare &compare) {
+  // as gallopLeft(), but bracketing pRun[lo] <= key < pRun[hi]
+  std::ptrdiff_t lo, hi;
+  std::ptrdiff_t h = hint, n = len, last = 0, ofs = 1;
+  if (before(compare, key, pRun[h])) {
+    std::ptrdiff_t maxOfs = h + 1;
+    while (ofs < maxOfs && before(compare, key, pRun[h - ofs])) {
+      last = ofs;
+      ofs = 2 * ofs + 1;
+    }
+    lo = h - std::min(ofs, maxOfs);
+    hi = h - last;
+  } else {
+    std::ptrdiff_t maxOfs = n - h;
+    while (ofs < maxOfs && !before(compare, key, pRun[h + ofs])) {
+      last = ofs;
+      ofs = 2 * ofs + 1;
+    }
+    lo = h + last;
+    hi = h + std::min(ofs, maxOfs);
   }
 
-  // lambda function for comparing elements for the sort
-  auto cmp = [](const int &a, const int &b) { return a - b; };
+  for (lo++; lo < hi;) {
+    std::ptrdiff_t mid = lo + (hi - lo) / 2;
+    if (before(compare, key, pRun[mid])) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return hi;
+}
 
-  // sort using quickSort
-  SearchNSort<int>::quickSort(pA, 100, cmp);
+/*
+ * Implementation of private mergeCollapse() helper function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::mergeCollapse(TimState<Compare> &state, bool force) {
+  std::vector<TimRun> &runs = state.runs;
+  while (runs.size() > 1u) {
+    // the top three lengths must satisfy A > B + C and B > C, and the
+    // three below the top A > B + C too, or the stack can grow too deep
+    size_t i = runs.size() - 2;
+    bool over = (i > 0u && runs[i - 1].len <= runs[i].len + runs[i + 1].len) ||
+                (i > 1u && runs[i - 2].len <= runs[i - 1].len + runs[i].len);
+    if (over || force) {
+      if (i > 0u && runs[i - 1].len < runs[i + 1].len) {
+        i--;
+      }
+    } else if (runs[i].len > runs[i + 1].len) {
+      break;
+    }
+    mergeAt(state, i);
+  }
+}
 
-  // sort using std::sort
-  std::sort(pB, pB + 100);
+/*
+ * Implementation of private mergeAt() helper function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::mergeAt(TimState<Compare> &state, size_t i) {
+  TimRun a = state.runs[i], b = state.runs[i + 1];
+  state.runs[i].len += b.len;
+  state.runs.erase(state.runs.begin() + i + 1);
+
+  // elements of a not greater than b's first, and elements of b not less
+  // than a's last, are already in place
+  T *pArr = state.pArr;
+  size_t k = gallopRight(pArr[b.base], pArr + a.base, a.len, 0, state.compare);
+  a.base += k;
+  a.len -= k;
+  if (a.len == 0u) {
+    return;
+  }
+  b.len = gallopLeft(pArr[a.base + a.len - 1], pArr + b.base, b.len,
+                     b.len - 1, state.compare);
+  if (b.len == 0u) {
+    return;
+  }
 
-  // check elements are the same
-  for(size_t i = 0; i < 100; i++) {
-    CHECK(pA[i] == pB[i]);
+  if (a.len <= b.len) {
+    mergeLo(state, a, b);
+  } else {
+    mergeHi(state, a, b);
   }
 }
 
 /*
- * Implementation of selectionSort() function.
+ * Implementation of private mergeLo() helper function.
  */
 template <class T>
-void SearchNSort<T>::selectionSort(T *pArr, size_t n,
-                                   int (*comp)(const T &x, const T &y)) {
-  size_t i, j, minIndex;
+template <class Compare>
+void SearchNSort<T>::mergeLo(TimState<Compare> &state, TimRun a, TimRun b) {
+  T *pArr = state.pArr;
+  Compare &compare = state.compare;
+  std::vector<T> &tmp = state.tmp;
+  tmp.assign(std::make_move_iterator(pArr + a.base),
+             std::make_move_iterator(pArr + a.base + a.len));
+
+  // i walks the copy of a, j walks b, and dest fills in from a.base
+  size_t i = 0, j = b.base, end = b.base + b.len, dest = a.base;
+  while (i < a.len && j < end) {
+    // one element at a time, until one run wins minGallop times in a row
+    size_t winsA = 0, winsB = 0;
+    while (i < a.len && j < end && std::max(winsA, winsB) < state.minGallop) {
+      if (before(compare, pArr[j], tmp[i])) {
+        pArr[dest++] = std::move(pArr[j++]);
+        winsB++;
+        winsA = 0;
+      } else {
+        pArr[dest++] = std::move(tmp[i++]);
+        winsA++;
+        winsB = 0;
+      }
+    }
 
-  for (i = 0u; i < n - 1u; i++) {
+    // then whole blocks, for as long as the blocks stay long
+    while (i < a.len && j < end) {
+      winsA = gallopRight(pArr[j], tmp.data() + i, a.len - i, 0, compare);
+      std::move(tmp.begin() + i, tmp.begin() + i + winsA, pArr + dest);
+      i += winsA;
+      dest += winsA;
+      if (i == a.len) {
+        break;
+      }
+      winsB = gallopLeft(tmp[i], pArr + j, end - j, 0, compare);
+      std::move(pArr + j, pArr + j + winsB, pArr + dest);
+      j += winsB;
+      dest += winsB;
+      if (j == end) {
+        break;
+      }
+      if (winsA < MIN_GALLOP && winsB < MIN_GALLOP) {
+        state.minGallop += 2;
+        break;
+      }
+      if (state.minGallop > 1u) {
+        state.minGallop--;
+      }
+    }
+  }
 
-    minIndex = i;
-    for (j = i + 1u; j < n; j++) {
-      if (comp(pArr[j], pArr[minIndex]) < 0) {
-        minIndex = j;
+  // whatever is left of b is already in place
+  std::move(tmp.begin() + i, tmp.begin() + a.len, pArr + dest);
+}
+
+/*
+ * Implementation of private mergeHi() helper function.
+ */
+template <class T>
+template <class Compare>
+void SearchNSort<T>::mergeHi(TimState<Compare> &state, TimRun a, TimRun b) {
+  T *pArr = state.pArr;
+  Compare &compare = state.compare;
+  std::vector<T> &tmp = state.tmp;
+  tmp.assign(std::make_move_iterator(pArr + b.base),
+             std::make_move_iterator(pArr + b.base + b.len));
+
+  // the mirror image of mergeLo(): i and j are one past the last unmerged
+  // elements of the copy of b and of a, and dest fills in from the right
+  size_t i = b.len, j = a.base + a.len, dest = b.base + b.len;
+  while (i > 0u && j > a.base) {
+    size_t winsA = 0, winsB = 0;
+    while (i > 0u && j > a.base &&
+           std::max(winsA, winsB) < state.minGallop) {
+      if (before(compare, tmp[i - 1], pArr[j - 1])) {
+        pArr[--dest] = std::move(pArr[--j]);
+        winsA++;
+        winsB = 0;
+      } else {
+        pArr[--dest] = std::move(tmp[--i]);
+        winsB++;
+        winsA = 0;
       }
     }
 
-    if (minIndex != i) {
-      std::swap(pArr[i], pArr[minIndex]);
+    while (i > 0u && j > a.base) {
+      size_t len = j - a.base;
+      winsA = len - gallopRight(tmp[i - 1], pArr + a.base, len, len - 1,
+                                compare);
+      std::move_backward(pArr + j - winsA, pArr + j, pArr + dest);
+      j -= winsA;
+      dest -= winsA;
+      if (j == a.base) {
+        break;
+      }
+      winsB = i - gallopLeft(pArr[j - 1], tmp.data(), i, i - 1, compare);
+      std::move_backward(tmp.begin() + i - winsB, tmp.begin() + i,
+                         pArr + dest);
+      i -= winsB;
+      dest -= winsB;
+      if (i == 0u) {
+        break;
+      }
+      if (winsA < MIN_GALLOP && winsB < MIN_GALLOP) {
+        state.minGallop += 2;
+        break;
+      }
+      if (state.minGallop > 1u) {
+        state.minGallop--;
+      }
     }
   }
+
+  // whatever is left of a is already in place
+  std::move_backward(tmp.begin(), tmp.begin() + i, pArr + dest);
 }
 
-// doctest unit test for selectionSort
-TEST_CASE("testing SearchNSort::selectionSort") {
-  // make two arrays for sorting
-  int pA[100], pB[100];
+// doctest unit test for timSort
+TEST_CASE("testing SearchNSort::timSort") {
+  // random arrays of many sizes and key ranges, of (key, index) pairs,
+  // must match std::stable_sort
+  typedef std::pair<int, size_t> Item;
   std::mt19937_64 prng(time(0));
-  std::uniform_int_distribution<int> dist(-100, 100);
-  for(size_t i = 0; i < 100; i++) {
-    pA[i] = pB[i] = dist(prng);
+  auto byKey = [](const Item &a, const Item &b) { return a.first - b.first; };
+  auto byKeyLess = [](const Item &a, const Item &b) {
+    return a.first < b.first;
+  };
+  for (size_t n : {0u, 1u, 2u, 31u, 32u, 33u, 100u, 1000u, 5000u}) {
+    for (int range : {3, 100, 1000000}) {
+      std::uniform_int_distribution<int> dist(0, range);
+      std::vector<Item> items(n);
+      for (size_t i = 0; i < n; i++) {
+        items[i] = Item(dist(prng), i);
+      }
+      std::vector<Item> expected = items;
+      std::stable_sort(expected.begin(), expected.end(), byKeyLess);
+      SearchNSort<Item>::timSort(items.data(), n, byKey);
+      CHECK(items == expected);
+    }
   }
 
-  // lambda function for comparing elements for the sort
-  auto cmp = [](const int &a, const int &b) { return a - b; };
-
-  // sort using selectionSort
-  SearchNSort<int>::selectionSort(pA, 100, cmp);
+  // patterns with long runs, which exercise galloping and both merge
+  // directions: sorted blocks, interleaved ranges, sawtooth, and sorted
+  // data with a few random elements appended or swapped in
+  const size_t n = 20000;
+  std::uniform_int_distribution<int> dist(0, int(n));
+  std::vector<std::vector<int>> patterns;
+  std::vector<int> keys(n);
+  for (size_t i = 0; i < n; i++) {
+    keys[i] = int(i % 7000);
+  }
+  patterns.push_back(keys);
+  for (size_t i = 0; i < n; i++) {
+    keys[i] = i < n / 2 ? int(2 * i) : int(2 * (i - n / 2) + 1);
+  }
+  patterns.push_back(keys);
+  for (size_t i = 0; i < n; i++) {
+    keys[i] = i < 100 ? int(n + i) : int(i);
+  }
+  patterns.push_back(keys);
+  for (size_t i = 0; i < n; i++) {
+    keys[i] = (i / 500) % 2 == 0 ? int(i) : int(n - i);
+  }
+  patterns.push_back(keys);
+  for (size_t i = 0; i < n; i++) {
+    keys[i] = i < n - 200 ? int(i) : dist(prng);
+  }
+  patterns.push_back(keys);
+  for (size_t i = 0; i < n; i++) {
+    keys[i] = int(i);
+  }
+  for (size_t i = 0; i < 20; i++) {
+    std::swap(keys[prng() % n], keys[prng() % n]);
+  }
+  patterns.push_back(keys);
+  for (std::vector<int> &pattern : patterns) {
+    std::vector<int> expected = pattern;
+    std::sort(expected.begin(), expected.end());
+    SearchNSort<int>::timSort(pattern.data(), n, std::less<int>());
+    CHECK(pattern == expected);
+  }
 
-  // sort using std::sort
-  std::sort(pB, pB + 100);
+  // sorted and strictly reversed input take n - 1 comparisons, and
+  // reversed input with ties is still sorted stably
+  size_t count = 0;
+  auto counting = [&count](const int &a, const int &b) {
+    count++;
+    return a < b;
+  };
+  for (size_t i = 0; i < n; i++) {
+    keys[i] = int(i);
+  }
+  SearchNSort<int>::timSort(keys.data(), n, counting);
+  CHECK(n - 1 == count);
+  CHECK(std::is_sorted(keys.begin(), keys.end()));
+  std::reverse(keys.begin(), keys.end());
+  count = 0;
+  SearchNSort<int>::timSort(keys.data(), n, counting);
+  CHECK(n - 1 == count);
+  CHECK(std::is_sorted(keys.begin(), keys.end()));
+
+  std::vector<Item> items(n);
+  for (size_t i = 0; i < n; i++) {
+    items[i] = Item(int((n - i) / 10), i);
+  }
+  std::vector<Item> expected = items;
+  std::stable_sort(expected.begin(), expected.end(), byKeyLess);
+  SearchNSort<Item>::timSort(items.data(), n, byKeyLess);
+  CHECK(items == expected);
+
+  // two sorted halves merge in far fewer than n lg n comparisons
+  for (size_t i = 0; i < n; i++) {
+    keys[i] = i < n / 2 ? int(i) : int(i - n / 2 + n / 4);
+  }
+  count = 0;
+  SearchNSort<int>::timSort(keys.data(), n, counting);
+  CHECK(std::is_sorted(keys.begin(), keys.end()));
+  CHECK(count < 2 * n);
+
+  // strings, and a function-pointer comparator
+  std::vector<std::string> words = {"pear", "fig", "apple", "kiwi", "date"};
+  SearchNSort<std::string>::timSort(words.data(), words.size(),
+                                    std::less<std::string>());
+  CHECK(std::is_sorted(words.begin(), words.end()));
+  int pA[] = {5, 3, 9, 1, 7};
+  SearchNSort<int>::CompareFn cmp = [](const int &a, const int &b) {
+    return a - b;
+  };
+  SearchNSort<int>::timSort(pA, 5, cmp);
+  CHECK(std::is_sorted(pA, pA + 5));
+}
 
-  // check elements are the same
+// doctest unit test for the different kinds of comparator
+TEST_CASE("testing SearchNSort comparator kinds") {
+  // make arrays for sorting
+  int pA[100], pB[100], pC[100], pD[100];
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-100, 100);
   for(size_t i = 0; i < 100; i++) {
-    CHECK(pA[i] == pB[i]);
+    pA[i] = pB[i] = pC[i] = pD[i] = dist(prng);
+  }
+  std::sort(pD, pD + 100);
+
+  // plain function pointer, as existing callers pass
+  SearchNSort<int>::CompareFn fn = [](const int &a, const int &b) {
+    return a - b;
+  };
+  SearchNSort<int>::quickSort(pA, 100, fn);
+
+  // bool comparator
+  SearchNSort<int>::mergeSort(pB, 100, std::less<int>());
+
+  // function object with state; insertion sort of sorted input does one
+  // comparison per element after the first
+  size_t count = 0;
+  auto counting = [&count](const int &a, const int &b) {
+    count++;
+    return a < b;
+  };
+  SearchNSort<int>::insertionSort(pC, 100, counting);
+  for(size_t i = 0; i < 100; i++) {
+    CHECK(pA[i] == pD[i]);
+    CHECK(pB[i] == pD[i]);
+    CHECK(pC[i] == pD[i]);
   }
+  count = 0;
+  SearchNSort<int>::insertionSort(pC, 100, counting);
+  CHECK(99 == count);
+
+  // searches tell equal from greater with a bool comparator, too
+  CHECK(pD[50] == pD[SearchNSort<int>::binarySearch(pD, 100, pD[50], 
+                                                      std::less<int>())]);
+  CHECK(-1 == SearchNSort<int>::binarySearch(pD, 100, 101, std::less<int>()));
+  CHECK(-1 == SearchNSort<int>::linearSearch(pD, 100, -101, fn));
+
+  // sorting descending is just a different comparator
+  SearchNSort<int>::quickSort(pA, 100, std::greater<int>());
+  for(size_t i = 0; i < 100; i++) {
+    CHECK(pA[i] == pD[99 - i]);
+  }
+}
+
+// doctest unit test for the sorting-network leaves
+TEST_CASE("testing SearchNSort sorting-network leaves") {
+  std::mt19937_64 prng(time(0));
+  std::uniform_real_distribution<double> dist(-100.0, 100.0);
+
+  // std::less on numbers hands small ranges to a SortingNetwork; sizes
+  // around the cutoffs, with few distinct values so there are ties
+  for(size_t n : {2, 5, 16, 17, 31, 32, 33, 64, 65, 100, 1000, 10000}) {
+    std::vector<double> doubles(n), expected;
+    for(size_t i = 0; i < n; i++) {
+      doubles[i] = std::floor(dist(prng));
+    }
+    expected = doubles;
+    std::sort(expected.begin(), expected.end());
+    std::vector<int> ints(expected.begin(), expected.end()), intsExpected;
+    intsExpected = ints;
+    std::shuffle(ints.begin(), ints.end(), prng);
+    std::vector<float> floats(doubles.begin(), doubles.end());
+    std::vector<float> floatsExpected(expected.begin(), expected.end());
+
+    std::vector<double> pA = doubles, pB = doubles, pC = doubles, 
+                        pD = doubles, pE = doubles;
+    SearchNSort<double>::quickSort(pA.data(), n, std::less<double>());
+    SearchNSort<double>::mergeSort(pB.data(), n, std::less<double>());
+    SearchNSort<double>::introSort(pC.data(), n, std::less<double>());
+    SearchNSort<double>::threeWayQuickSort(pD.data(), n, 
+                                           std::less<double>());
+    SearchNSort<double>::bottomUpMergeSort(pE.data(), n, 
+                                           std::less<double>());
+    CHECK(pA == expected);
+    CHECK(pB == expected);
+    CHECK(pC == expected);
+    CHECK(pD == expected);
+    CHECK(pE == expected);
+
+    SearchNSort<int>::introSort(ints.data(), n, std::less<int>());
+    CHECK(ints == intsExpected);
+    SearchNSort<float>::mergeSort(floats.data(), n, std::less<float>());
+    CHECK(floats == floatsExpected);
+  }
+
+  // other element types and comparators keep insertion sort
+  std::vector<std::string> words = {"pear", "fig", "apple", "kiwi", "date"};
+  SearchNSort<std::string>::introSort(words.data(), words.size(),
+                                      std::less<std::string>());
+  CHECK(std::is_sorted(words.begin(), words.end()));
 }
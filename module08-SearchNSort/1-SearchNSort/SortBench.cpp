@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include "ParallelSort.hpp"
+#include "SearchNSort.hpp"
+
+/**
+ * @brief Function-pointer comparator, as PA08 passes to quickSort.
+ * 
+ * @param x Item 1 to compare
+ * 
+ * @param y Item 2 to compare
+ * 
+ * @return -1 if x < y, 1 if x > y, 0 if x == y
+ */
+int compare(const double &x, const double &y) { 
+    if(x < y) {
+        return -1;
+    } else if(x > y) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * @brief Fill an array of doubles with values uniform in [0, 1).
+ * 
+ * @param pArr Pointer to array to fill
+ * 
+ * @param n Number of elements in the array
+ * 
+ * @param numDistinct If not 0, round each value down to a multiple of 
+ * 1 / numDistinct, so the array holds at most numDistinct different values
+ */
+void fill(double *pArr, unsigned n, unsigned numDistinct) {
+    std::mt19937_64 prng(time(0));
+    std::uniform_real_distribution<double> dist;
+
+    for(unsigned i = 0; i < n; i++) {
+        pArr[i] = dist(prng);
+        if(numDistinct != 0) {
+            pArr[i] = std::floor(pArr[i] * numDistinct) / numDistinct;
+        }
+    }
+}
+
+/**
+ * @brief Randomly shuffle and array of doubles
+ * 
+ * @param pArr Pointer to array to shuffle
+ * 
+ * @param n Number of elements in the array
+ */
+void shuffle(double *pArr, unsigned n) { 
+    std::mt19937_64 prng(time(0));
+    std::uniform_int_distribution<unsigned> dist(0, n - 1u);
+
+    for(unsigned i = 0; i < n; i++) {
+        std::swap(pArr[i], pArr[dist(prng)]);
+    }
+}
+
+/**
+ * @brief Determine if an array is sorted
+ * 
+ * @param pArr Pointer to array to check
+ * 
+ * @param n Number of elements in the array
+ * 
+ * @return true if the array is sorted ascending, false otherwise
+ */
+bool isSorted(double *pArr, unsigned n) {
+    for(unsigned i = 0; i < n - 1; i++) {
+        if(pArr[i] > pArr[i + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Time a sort, averaged over 10 runs on freshly shuffled data.
+ * 
+ * @param pArr Pointer to array to sort
+ * 
+ * @param n Number of elements in the array
+ * 
+ * @param sort Callable taking pArr and n that sorts the array
+ * 
+ * @return Mean time per sort in nanoseconds, or a negative value if the 
+ * sort left the array unsorted
+ */
+template <class Sort>
+long double timeSort(double *pArr, unsigned n, Sort sort) {
+    long double dur = 0;
+    for(int i = 0; i < 10; i++) {
+        shuffle(pArr, n);
+        auto begin = std::chrono::high_resolution_clock::now();
+        sort(pArr, n);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        if(!isSorted(pArr, n)) {
+            return -1;
+        }
+        dur += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    }
+    return dur / 10.0;
+}
+
+/**
+ * @brief Time a sort on a fixed input, averaged over 10 runs.
+ * 
+ * @param pSrc Pointer to the input, which is copied before each run
+ * 
+ * @param pArr Pointer to an array of n elements to sort the copy in
+ * 
+ * @param n Number of elements in the arrays
+ * 
+ * @param sort Callable taking pArr and n that sorts the array
+ * 
+ * @return Mean time per sort in nanoseconds, or a negative value if the 
+ * sort left the array unsorted
+ */
+template <class Sort>
+long double timeFixed(const double *pSrc, double *pArr, unsigned n, 
+    Sort sort) {
+    long double dur = 0;
+    for(int i = 0; i < 10; i++) {
+        std::copy(pSrc, pSrc + n, pArr);
+        auto begin = std::chrono::high_resolution_clock::now();
+        sort(pArr, n);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        if(!isSorted(pArr, n)) {
+            return -1;
+        }
+        dur += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    }
+    return dur / 10.0;
+}
+
+/**
+ * @brief Application entry point.
+ * 
+ * Times the SearchNSort algorithms on the PA08 workload, arrays of doubles 
+ * uniform in [0, 1) from 256 to 2^maxPower elements, comparing the
+ * function-pointer comparator to an inlined lambda, recursive merge sort to
+ * bottom-up merge sort, and quicksort to
+ * introsort, three-way quicksort, the parallel sorts, and radix sort. The
+ * "Network" columns pass std::less, which lets the sorts finish small 
+ * ranges with SortingNetwork. A second table times timSort against 
+ * bottom-up merge sort, introsort, and std::stable_sort on 2^maxPower 
+ * elements that are already partly in order: sorted, reversed, sorted with
+ * 1% random values appended, sorted with 1% of the elements swapped at
+ * random, and 16 sorted blocks. An optional second 
+ * argument limits the number of distinct values, for duplicate-heavy keys; 
+ * an optional third sets the number of threads for the parallel sorts.
+ * 
+ * @param argc Number of command-line arguments
+ * 
+ * @param ppszArgs Array of command-line argument strings
+ */
+int main(int argc, char **ppszArgs) {
+    // command-line argument sanity check
+    if(argc < 2) {
+        fprintf(stderr, "Usage: ./SortBench maxPower [numDistinct [numThreads]]\n");
+        return EXIT_FAILURE;
+    }
+    int powerCap = atoi(ppszArgs[1]);
+    unsigned numDistinct = argc > 2 ? atoi(ppszArgs[2]) : 0;
+    ThreadPool pool(argc > 3 ? atoi(ppszArgs[3]) : 0);
+
+    auto less = [](const double &x, const double &y) { return x < y; };
+
+    unsigned n = 256;
+
+    printf("%8s,%12s,%12s,%12s,%12s,%12s,%12s,%12s,%12s,%12s,%12s,%12s,%12s,"
+        "%12s,%12s\n", "n", "qsFn", "qsInline", "msFn", "msInline", 
+        "msBottomUp", "introInline", "3wayInline", "msParallel", "qsParallel",
+        "radix", "qsNetwork", "msNetwork", "introNetwork", "timInline");
+    for(int power = 8; power <= powerCap; power++) {
+        double *pArr = new double[n];
+        fill(pArr, n, numDistinct);
+
+        long double pDur[] = {
+            timeSort(pArr, n, [](double *pA, unsigned m) {
+                SearchNSort<double>::quickSort(pA, m, compare);
+            }),
+            timeSort(pArr, n, [less](double *pA, unsigned m) {
+                SearchNSort<double>::quickSort(pA, m, less);
+            }),
+            timeSort(pArr, n, [](double *pA, unsigned m) {
+                SearchNSort<double>::mergeSort(pA, m, compare);
+            }),
+            timeSort(pArr, n, [less](double *pA, unsigned m) {
+                SearchNSort<double>::mergeSort(pA, m, less);
+            }),
+            timeSort(pArr, n, [less](double *pA, unsigned m) {
+                SearchNSort<double>::bottomUpMergeSort(pA, m, less);
+            }),
+            timeSort(pArr, n, [less](double *pA, unsigned m) {
+                SearchNSort<double>::introSort(pA, m, less);
+            }),
+            timeSort(pArr, n, [less](double *pA, unsigned m) {
+                SearchNSort<double>::threeWayQuickSort(pA, m, less);
+            }),
+            timeSort(pArr, n, [less, &pool](double *pA, unsigned m) {
+                ParallelSort<double>::mergeSort(pA, m, less, pool);
+            }),
+            timeSort(pArr, n, [less, &pool](double *pA, unsigned m) {
+                ParallelSort<double>::quickSort(pA, m, less, pool);
+            }),
+            timeSort(pArr, n, [](double *pA, unsigned m) {
+                SearchNSort<double>::radixSort(pA, m);
+            }),
+            timeSort(pArr, n, [](double *pA, unsigned m) {
+                SearchNSort<double>::quickSort(pA, m, std::less<double>());
+            }),
+            timeSort(pArr, n, [](double *pA, unsigned m) {
+                SearchNSort<double>::mergeSort(pA, m, std::less<double>());
+            }),
+            timeSort(pArr, n, [](double *pA, unsigned m) {
+                SearchNSort<double>::introSort(pA, m, std::less<double>());
+            }),
+            timeSort(pArr, n, [less](double *pA, unsigned m) {
+                SearchNSort<double>::timSort(pA, m, less);
+            })
+        };
+        size_t numSorts = sizeof(pDur) / sizeof(pDur[0]);
+
+        printf("%8d", n);
+        for(size_t i = 0; i < numSorts; i++) {
+            if(pDur[i] < 0) {
+                fprintf(stderr, "\nSORT %zu FAILURE!\n", i);
+                return EXIT_FAILURE;
+            }
+            printf(", %0.5LE", pDur[i]);
+        }
+        printf("\n");
+
+        delete [] pArr;
+
+        n *= 2;
+    }
+
+    // partly ordered inputs of the largest size
+    n /= 2;
+    double *pSrc = new double[n], *pArr = new double[n];
+    std::mt19937_64 prng(time(0));
+    std::uniform_real_distribution<double> dist;
+    const char *ppszPatterns[] = {"sorted", "reversed", "appended", 
+        "swapped", "blocks"};
+
+    printf("\n%10s,%12s,%12s,%12s,%12s\n", "pattern", "timInline", 
+        "msBottomUp", "introInline", "stable");
+    for(int pattern = 0; pattern < 5; pattern++) {
+        for(unsigned i = 0; i < n; i++) {
+            pSrc[i] = i / double(n);
+        }
+        if(pattern == 1) {
+            std::reverse(pSrc, pSrc + n);
+        } else if(pattern == 2) {
+            for(unsigned i = n - n / 100; i < n; i++) {
+                pSrc[i] = dist(prng);
+            }
+        } else if(pattern == 3) {
+            for(unsigned i = 0; i < n / 200; i++) {
+                std::swap(pSrc[prng() % n], pSrc[prng() % n]);
+            }
+        } else if(pattern == 4) {
+            for(unsigned i = 0; i < n; i++) {
+                pSrc[i] = (i % (n / 16)) / double(n) + (i / (n / 16)) * 1e-9;
+            }
+        }
+
+        long double pDur[] = {
+            timeFixed(pSrc, pArr, n, [less](double *pA, unsigned m) {
+                SearchNSort<double>::timSort(pA, m, less);
+            }),
+            timeFixed(pSrc, pArr, n, [less](double *pA, unsigned m) {
+                SearchNSort<double>::bottomUpMergeSort(pA, m, less);
+            }),
+            timeFixed(pSrc, pArr, n, [less](double *pA, unsigned m) {
+                SearchNSort<double>::introSort(pA, m, less);
+            }),
+            timeFixed(pSrc, pArr, n, [less](double *pA, unsigned m) {
+                std::stable_sort(pA, pA + m, less);
+            })
+        };
+
+        printf("%10s", ppszPatterns[pattern]);
+        for(long double dur : pDur) {
+            if(dur < 0) {
+                fprintf(stderr, "\nSORT FAILURE!\n");
+                return EXIT_FAILURE;
+            }
+            printf(", %0.5LE", dur);
+        }
+        printf("\n");
+    }
+    delete [] pSrc;
+    delete [] pArr;
+
+    return EXIT_SUCCESS;
+}
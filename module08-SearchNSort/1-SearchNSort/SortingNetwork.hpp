@@ -0,0 +1,501 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <ctime>
+#include <doctest.h>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+/*-----------------------------------------------------------------------------
+ * SIMD vector definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief The vector operations SortingNetwork needs for one element type.
+ *
+ * Each specialization wraps one SIMD register type, holding LANES elements,
+ * with unaligned loads and stores, lane-wise min and max, and exchange(),
+ * which does one step of a bitonic sorting network inside a register. The
+ * searches in SearchNSort use broadcast(), equal(), any() and mask(), which
+ * packs the top bit of each lane into an int, lane 0 in bit 0. The
+ * AVX2 versions are used when the compiler targets AVX2 (e.g. with
+ * -march=native), the SSE4.1 versions when it targets SSE4.1, and otherwise
+ * AVAILABLE is false and SortingNetwork falls back to scalar code.
+ */
+template <class T> struct SimdVector {
+  static const bool AVAILABLE = false;
+};
+
+#if defined(__AVX2__)
+
+/**
+ * @brief Eight ints in an AVX2 register.
+ */
+template <> struct SimdVector<int> {
+  static const bool AVAILABLE = true;
+  static const size_t LANES = 8;
+  typedef __m256i Reg;
+
+  static Reg load(const int *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  }
+  static void store(int *p, Reg v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+  }
+  static Reg min(Reg a, Reg b) { return _mm256_min_epi32(a, b); }
+  static Reg max(Reg a, Reg b) { return _mm256_max_epi32(a, b); }
+  static Reg broadcast(int x) { return _mm256_set1_epi32(x); }
+  static Reg equal(Reg a, Reg b) { return _mm256_cmpeq_epi32(a, b); }
+  static Reg any(Reg a, Reg b) { return _mm256_or_si256(a, b); }
+  static unsigned mask(Reg a) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(a));
+  }
+
+  /**
+   * @brief Compare-exchange lanes i and i ^ j of v, for j < LANES, where
+   * lane i holds element base + i of the block being sorted. Lane i keeps
+   * the larger value if exactly one of (base + i) & j and (base + i) & k is
+   * set, and the smaller one otherwise.
+   */
+  static Reg exchange(Reg v, size_t base, size_t j, size_t k) {
+    __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i partner = _mm256_permutevar8x32_epi32(
+        v, _mm256_xor_si256(lane, _mm256_set1_epi32(int(j))));
+    __m256i i = _mm256_add_epi32(lane, _mm256_set1_epi32(int(base)));
+    __m256i vj = _mm256_set1_epi32(int(j)), vk = _mm256_set1_epi32(int(k));
+    __m256i takeMax = _mm256_xor_si256(
+        _mm256_cmpeq_epi32(_mm256_and_si256(i, vj), vj),
+        _mm256_cmpeq_epi32(_mm256_and_si256(i, vk), vk));
+    return _mm256_blendv_epi8(min(v, partner), max(v, partner), takeMax);
+  }
+};
+
+/**
+ * @brief Eight floats in an AVX2 register.
+ */
+template <> struct SimdVector<float> {
+  static const bool AVAILABLE = true;
+  static const size_t LANES = 8;
+  typedef __m256 Reg;
+
+  static Reg load(const float *p) { return _mm256_loadu_ps(p); }
+  static void store(float *p, Reg v) { _mm256_storeu_ps(p, v); }
+  static Reg min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+  static Reg max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+  static Reg broadcast(float x) { return _mm256_set1_ps(x); }
+  static Reg equal(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+  static Reg any(Reg a, Reg b) { return _mm256_or_ps(a, b); }
+  static unsigned mask(Reg a) { return _mm256_movemask_ps(a); }
+
+  /**
+   * @brief Compare-exchange within a register; see SimdVector<int>.
+   */
+  static Reg exchange(Reg v, size_t base, size_t j, size_t k) {
+    __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256 partner = _mm256_permutevar8x32_ps(
+        v, _mm256_xor_si256(lane, _mm256_set1_epi32(int(j))));
+    __m256i i = _mm256_add_epi32(lane, _mm256_set1_epi32(int(base)));
+    __m256i vj = _mm256_set1_epi32(int(j)), vk = _mm256_set1_epi32(int(k));
+    __m256i takeMax = _mm256_xor_si256(
+        _mm256_cmpeq_epi32(_mm256_and_si256(i, vj), vj),
+        _mm256_cmpeq_epi32(_mm256_and_si256(i, vk), vk));
+    return _mm256_blendv_ps(min(v, partner), max(v, partner),
+                            _mm256_castsi256_ps(takeMax));
+  }
+};
+
+/**
+ * @brief Four doubles in an AVX2 register.
+ */
+template <> struct SimdVector<double> {
+  static const bool AVAILABLE = true;
+  static const size_t LANES = 4;
+  typedef __m256d Reg;
+
+  static Reg load(const double *p) { return _mm256_loadu_pd(p); }
+  static void store(double *p, Reg v) { _mm256_storeu_pd(p, v); }
+  static Reg min(Reg a, Reg b) { return _mm256_min_pd(a, b); }
+  static Reg max(Reg a, Reg b) { return _mm256_max_pd(a, b); }
+  static Reg broadcast(double x) { return _mm256_set1_pd(x); }
+  static Reg equal(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+  static Reg any(Reg a, Reg b) { return _mm256_or_pd(a, b); }
+  static unsigned mask(Reg a) { return _mm256_movemask_pd(a); }
+
+  /**
+   * @brief Compare-exchange within a register; see SimdVector<int>.
+   */
+  static Reg exchange(Reg v, size_t base, size_t j, size_t k) {
+    __m256d partner = j == 1 ? _mm256_permute4x64_pd(v, 0xB1)
+                             : _mm256_permute4x64_pd(v, 0x4E);
+    __m256i i = _mm256_add_epi64(_mm256_setr_epi64x(0, 1, 2, 3),
+                                 _mm256_set1_epi64x((long long)base));
+    __m256i vj = _mm256_set1_epi64x((long long)j);
+    __m256i vk = _mm256_set1_epi64x((long long)k);
+    __m256i takeMax = _mm256_xor_si256(
+        _mm256_cmpeq_epi64(_mm256_and_si256(i, vj), vj),
+        _mm256_cmpeq_epi64(_mm256_and_si256(i, vk), vk));
+    return _mm256_blendv_pd(min(v, partner), max(v, partner),
+                            _mm256_castsi256_pd(takeMax));
+  }
+};
+
+#elif defined(__SSE4_1__)
+
+/**
+ * @brief Four ints in an SSE register.
+ */
+template <> struct SimdVector<int> {
+  static const bool AVAILABLE = true;
+  static const size_t LANES = 4;
+  typedef __m128i Reg;
+
+  static Reg load(const int *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  }
+  static void store(int *p, Reg v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+  }
+  static Reg min(Reg a, Reg b) { return _mm_min_epi32(a, b); }
+  static Reg max(Reg a, Reg b) { return _mm_max_epi32(a, b); }
+  static Reg broadcast(int x) { return _mm_set1_epi32(x); }
+  static Reg equal(Reg a, Reg b) { return _mm_cmpeq_epi32(a, b); }
+  static Reg any(Reg a, Reg b) { return _mm_or_si128(a, b); }
+  static unsigned mask(Reg a) { return _mm_movemask_ps(_mm_castsi128_ps(a)); }
+
+  /**
+   * @brief Compare-exchange lanes i and i ^ j of v, for j < LANES, where
+   * lane i holds element base + i of the block being sorted. Lane i keeps
+   * the larger value if exactly one of (base + i) & j and (base + i) & k is
+   * set, and the smaller one otherwise.
+   */
+  static Reg exchange(Reg v, size_t base, size_t j, size_t k) {
+    __m128i partner = j == 1 ? _mm_shuffle_epi32(v, 0xB1)
+                             : _mm_shuffle_epi32(v, 0x4E);
+    __m128i i = _mm_add_epi32(_mm_setr_epi32(0, 1, 2, 3),
+                              _mm_set1_epi32(int(base)));
+    __m128i vj = _mm_set1_epi32(int(j)), vk = _mm_set1_epi32(int(k));
+    __m128i takeMax = _mm_xor_si128(_mm_cmpeq_epi32(_mm_and_si128(i, vj), vj),
+                                    _mm_cmpeq_epi32(_mm_and_si128(i, vk), vk));
+    return _mm_blendv_epi8(min(v, partner), max(v, partner), takeMax);
+  }
+};
+
+/**
+ * @brief Four floats in an SSE register.
+ */
+template <> struct SimdVector<float> {
+  static const bool AVAILABLE = true;
+  static const size_t LANES = 4;
+  typedef __m128 Reg;
+
+  static Reg load(const float *p) { return _mm_loadu_ps(p); }
+  static void store(float *p, Reg v) { _mm_storeu_ps(p, v); }
+  static Reg min(Reg a, Reg b) { return _mm_min_ps(a, b); }
+  static Reg max(Reg a, Reg b) { return _mm_max_ps(a, b); }
+  static Reg broadcast(float x) { return _mm_set1_ps(x); }
+  static Reg equal(Reg a, Reg b) { return _mm_cmpeq_ps(a, b); }
+  static Reg any(Reg a, Reg b) { return _mm_or_ps(a, b); }
+  static unsigned mask(Reg a) { return _mm_movemask_ps(a); }
+
+  /**
+   * @brief Compare-exchange within a register; see SimdVector<int>.
+   */
+  static Reg exchange(Reg v, size_t base, size_t j, size_t k) {
+    __m128 partner = j == 1 ? _mm_shuffle_ps(v, v, 0xB1)
+                            : _mm_shuffle_ps(v, v, 0x4E);
+    __m128i i = _mm_add_epi32(_mm_setr_epi32(0, 1, 2, 3),
+                              _mm_set1_epi32(int(base)));
+    __m128i vj = _mm_set1_epi32(int(j)), vk = _mm_set1_epi32(int(k));
+    __m128i takeMax = _mm_xor_si128(_mm_cmpeq_epi32(_mm_and_si128(i, vj), vj),
+                                    _mm_cmpeq_epi32(_mm_and_si128(i, vk), vk));
+    return _mm_blendv_ps(min(v, partner), max(v, partner),
+                         _mm_castsi128_ps(takeMax));
+  }
+};
+
+/**
+ * @brief Two doubles in an SSE register.
+ */
+template <> struct SimdVector<double> {
+  static const bool AVAILABLE = true;
+  static const size_t LANES = 2;
+  typedef __m128d Reg;
+
+  static Reg load(const double *p) { return _mm_loadu_pd(p); }
+  static void store(double *p, Reg v) { _mm_storeu_pd(p, v); }
+  static Reg min(Reg a, Reg b) { return _mm_min_pd(a, b); }
+  static Reg max(Reg a, Reg b) { return _mm_max_pd(a, b); }
+  static Reg broadcast(double x) { return _mm_set1_pd(x); }
+  static Reg equal(Reg a, Reg b) { return _mm_cmpeq_pd(a, b); }
+  static Reg any(Reg a, Reg b) { return _mm_or_pd(a, b); }
+  static unsigned mask(Reg a) { return _mm_movemask_pd(a); }
+
+  /**
+   * @brief Compare-exchange within a register; see SimdVector<int>. Only
+   * j == 1 is possible.
+   */
+  static Reg exchange(Reg v, size_t base, size_t j, size_t k) {
+    __m128d partner = _mm_shuffle_pd(v, v, 1);
+    __m128i i = _mm_add_epi64(_mm_set_epi64x(1, 0),
+                              _mm_set1_epi64x((long long)base));
+    __m128i vk = _mm_set1_epi64x((long long)k);
+    __m128i takeMax = _mm_xor_si128(_mm_set_epi64x(-1, 0),
+                                    _mm_cmpeq_epi64(_mm_and_si128(i, vk), vk));
+    return _mm_blendv_pd(min(v, partner), max(v, partner),
+                         _mm_castsi128_pd(takeMax));
+  }
+};
+
+#endif
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Sorting networks for small arrays of numbers.
+ *
+ * A sorting network is a fixed sequence of compare-exchange steps, the same
+ * whatever the data, so it has no unpredictable branches, and steps that
+ * touch disjoint pairs of elements can run side by side in SIMD registers.
+ * That makes it faster than insertion sort for the small ranges at the
+ * bottom of quicksort and merge sort.
+ *
+ * This class uses Batcher's bitonic sorting network. An array of n
+ * elements is copied into a block whose size is the next power of two,
+ * padded with the largest possible value, sorted, and copied back. For int,
+ * float and double the network runs on AVX2 or SSE4.1 registers when the
+ * compiler targets them; every other arithmetic type, and every type on
+ * other targets, uses the scalar version of the same network.
+ *
+ * The sort is not stable, which cannot be seen for integers. For floating
+ * point types, -0.0 and 0.0 may come out in either order, and arrays
+ * holding NaN are not sorted correctly.
+ */
+template <class T> class SortingNetwork {
+  static_assert(std::is_arithmetic<T>::value,
+                "SortingNetwork sorts arithmetic types only");
+
+public:
+  /**
+   * @brief Largest array the networks sort.
+   */
+  static const size_t MAX_SIZE = 64;
+
+  /**
+   * @brief Sort a small array into ascending order, with SIMD instructions
+   * when they are available.
+   *
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array, at most MAX_SIZE.
+   * @throws std::out_of_range if n is larger than MAX_SIZE.
+   */
+  static void sort(T *pArr, size_t n);
+
+  /**
+   * @brief Sort a small array into ascending order with the scalar network.
+   *
+   * @param pArr Pointer to the first element of the array to sort.
+   * @param n Size of the array, at most MAX_SIZE.
+   * @throws std::out_of_range if n is larger than MAX_SIZE.
+   */
+  static void sortScalar(T *pArr, size_t n);
+
+  /**
+   * @brief Whether sort() uses SIMD instructions for this type.
+   */
+  static bool usesSimd() { return SimdVector<T>::AVAILABLE; }
+
+private:
+  /**
+   * @brief Copy pArr[0, n) into pBuf, padded up to the returned block size,
+   * a power of two no smaller than minSize.
+   */
+  static size_t pad(const T *pArr, size_t n, T *pBuf, size_t minSize);
+
+  /**
+   * @brief sort() for types with SIMD support.
+   */
+  static void sort(T *pArr, size_t n, std::true_type);
+
+  /**
+   * @brief sort() for types without SIMD support.
+   */
+  static void sort(T *pArr, size_t n, std::false_type) {
+    sortScalar(pArr, n);
+  }
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Implementation of private pad() helper function.
+ */
+template <class T>
+size_t SortingNetwork<T>::pad(const T *pArr, size_t n, T *pBuf,
+                              size_t minSize) {
+  if (n > MAX_SIZE) {
+    throw std::out_of_range("Array too large in SortingNetwork::sort()");
+  }
+  size_t size = minSize;
+  while (size < n) {
+    size *= 2;
+  }
+  std::copy(pArr, pArr + n, pBuf);
+  std::fill(pBuf + n, pBuf + size,
+            std::numeric_limits<T>::has_infinity
+                ? std::numeric_limits<T>::infinity()
+                : std::numeric_limits<T>::max());
+  return size;
+}
+
+/*
+ * Implementation of sortScalar() function.
+ */
+template <class T> void SortingNetwork<T>::sortScalar(T *pArr, size_t n) {
+  T pBuf[MAX_SIZE];
+  size_t size = pad(pArr, n, pBuf, 1);
+
+  // merge bitonic sequences of length k; pairs i, i + j are put in
+  // ascending order in blocks where i & k is 0, descending elsewhere
+  for (size_t k = 2; k <= size; k *= 2) {
+    for (size_t j = k / 2; j > 0; j /= 2) {
+      for (size_t block = 0; block < size; block += 2 * j) {
+        bool up = (block & k) == 0;
+        T *pLo = pBuf + block + (up ? 0 : j), *pHi = pBuf + block + (up ? j : 0);
+        for (size_t i = 0; i < j; i++) {
+          T a = pLo[i], b = pHi[i];
+          pLo[i] = b < a ? b : a;
+          pHi[i] = a < b ? b : a;
+        }
+      }
+    }
+  }
+
+  std::copy(pBuf, pBuf + n, pArr);
+}
+
+/*
+ * Implementation of sort() function.
+ */
+template <class T> void SortingNetwork<T>::sort(T *pArr, size_t n) {
+  sort(pArr, n, std::integral_constant<bool, SimdVector<T>::AVAILABLE>());
+}
+
+/*
+ * Implementation of private SIMD sort() helper function.
+ */
+template <class T>
+void SortingNetwork<T>::sort(T *pArr, size_t n, std::true_type) {
+  typedef SimdVector<T> V;
+  typedef typename V::Reg Reg;
+  const size_t L = V::LANES;
+
+  alignas(32) T pBuf[MAX_SIZE];
+  size_t size = pad(pArr, n, pBuf, L);
+
+  for (size_t k = 2; k <= size; k *= 2) {
+    // steps pairing elements at least a register apart compare whole
+    // registers, and k > j >= L makes the direction the same in every lane
+    for (size_t j = k / 2; j >= L; j /= 2) {
+      for (size_t i = 0; i < size; i += L) {
+        if ((i & j) == 0) {
+          Reg a = V::load(pBuf + i), b = V::load(pBuf + i + j);
+          Reg lo = V::min(a, b), hi = V::max(a, b);
+          bool up = (i & k) == 0;
+          V::store(pBuf + i, up ? lo : hi);
+          V::store(pBuf + i + j, up ? hi : lo);
+        }
+      }
+    }
+
+    // the remaining steps pair lanes of the same register
+    for (size_t j = std::min(k / 2, L / 2); j > 0; j /= 2) {
+      for (size_t i = 0; i < size; i += L) {
+        V::store(pBuf + i, V::exchange(V::load(pBuf + i), i, j, k));
+      }
+    }
+  }
+
+  std::copy(pBuf, pBuf + n, pArr);
+}
+
+// doctest unit test for SortingNetwork
+TEST_CASE("testing SortingNetwork") {
+  std::mt19937_64 prng(time(0));
+
+  // the SNSTestsSse41 and SNSTestsAvx2 targets build with the vector kernels
+#if defined(__AVX2__) || defined(__SSE4_1__)
+  bool simd = SimdVector<int>::AVAILABLE && SimdVector<float>::AVAILABLE &&
+              SimdVector<double>::AVAILABLE;
+  CHECK(simd);
+#endif
+
+  // every size up to the limit, both kernels, for each SIMD type
+  std::uniform_int_distribution<int> intDist(-1000, 1000);
+  std::uniform_real_distribution<double> realDist(-1.0, 1.0);
+  for (size_t n = 0; n <= SortingNetwork<int>::MAX_SIZE; n++) {
+    std::vector<int> ints(n), intsScalar, intsExpected;
+    std::vector<float> floats(n), floatsScalar, floatsExpected;
+    std::vector<double> doubles(n), doublesScalar, doublesExpected;
+    for (size_t i = 0; i < n; i++) {
+      ints[i] = intDist(prng);
+      doubles[i] = realDist(prng);
+      floats[i] = static_cast<float>(doubles[i]);
+    }
+    intsScalar = intsExpected = ints;
+    floatsScalar = floatsExpected = floats;
+    doublesScalar = doublesExpected = doubles;
+    std::sort(intsExpected.begin(), intsExpected.end());
+    std::sort(floatsExpected.begin(), floatsExpected.end());
+    std::sort(doublesExpected.begin(), doublesExpected.end());
+
+    SortingNetwork<int>::sort(ints.data(), n);
+    SortingNetwork<int>::sortScalar(intsScalar.data(), n);
+    CHECK(ints == intsExpected);
+    CHECK(intsScalar == intsExpected);
+    SortingNetwork<float>::sort(floats.data(), n);
+    SortingNetwork<float>::sortScalar(floatsScalar.data(), n);
+    CHECK(floats == floatsExpected);
+    CHECK(floatsScalar == floatsExpected);
+    SortingNetwork<double>::sort(doubles.data(), n);
+    SortingNetwork<double>::sortScalar(doublesScalar.data(), n);
+    CHECK(doubles == doublesExpected);
+    CHECK(doublesScalar == doublesExpected);
+  }
+
+  // keys equal to the padding value, and a type with no SIMD kernel
+  const int big = std::numeric_limits<int>::max();
+  int pA[] = {big, 3, big, -big, 0};
+  SortingNetwork<int>::sort(pA, 5);
+  CHECK((-big == pA[0] && 0 == pA[1] && 3 == pA[2] && big == pA[3] &&
+         big == pA[4]));
+  double inf = std::numeric_limits<double>::infinity();
+  double pB[] = {inf, 1.5, -inf};
+  SortingNetwork<double>::sort(pB, 3);
+  CHECK((-inf == pB[0] && 1.5 == pB[1] && inf == pB[2]));
+  unsigned char pC[] = {200, 7, 255, 0, 7};
+  SortingNetwork<unsigned char>::sort(pC, 5);
+  CHECK((0 == pC[0] && 7 == pC[1] && 7 == pC[2] && 200 == pC[3] &&
+         255 == pC[4]));
+
+  // arrays too large for a network
+  bool flag = false;
+  std::vector<int> tooBig(SortingNetwork<int>::MAX_SIZE + 1);
+  try {
+    SortingNetwork<int>::sort(tooBig.data(), tooBig.size());
+  } catch (const std::out_of_range &) {
+    flag = true;
+  }
+  CHECK(flag);
+}
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "SearchNSort.hpp"
+
+/**
+ * @brief Time one sort of a shuffled copy of the words.
+ *
+ * @param words Shuffled words to sort; not changed
+ *
+ * @param expected Words in sorted order, to check the result against
+ *
+ * @param sort Callable taking an array of strings and its size
+ *
+ * @return Time taken in seconds, or a negative value if the sort failed
+ */
+template <class Sort>
+double timeSort(const std::vector<std::string> &words,
+    const std::vector<std::string> &expected, Sort sort) {
+
+    std::vector<std::string> arr = words;
+    auto begin = std::chrono::high_resolution_clock::now();
+    sort(arr.data(), arr.size());
+    auto end = std::chrono::high_resolution_clock::now();
+
+    if(arr != expected) {
+        return -1.0;
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end -
+        begin).count() / 1e9;
+}
+
+/**
+ * @brief Application entry point.
+ *
+ * Reads a word list, one word per line, shuffles it, and times sorting it
+ * with introSort, threeWayQuickSort, multikeyQuickSort, msdRadixSort, and
+ * std::sort for reference. The list can be repeated several times, each
+ * copy with a different suffix, to make a larger input with the same
+ * shared prefixes. Each sort is checked against std::sort.
+ *
+ * @param argc Number of command-line arguments
+ *
+ * @param ppszArgs Array of command-line argument strings
+ */
+int main(int argc, char **ppszArgs) {
+    std::string path = argc > 1 ? ppszArgs[1] :
+        "../../module02-SimpleSLL/3-PA2/dictionary.txt";
+    int copies = argc > 2 ? atoi(ppszArgs[2]) : 1;
+
+    // read the words, dropping a UTF-8 byte order mark and DOS line ends
+    std::ifstream in(path);
+    if(!in) {
+        fprintf(stderr, "Usage: ./StringBench [wordFile] [copies]\n");
+        return EXIT_FAILURE;
+    }
+    std::vector<std::string> dictionary;
+    std::string word;
+    while(std::getline(in, word)) {
+        if(dictionary.empty() && word.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+            word.erase(0, 3);
+        }
+        if(!word.empty() && word.back() == '\r') {
+            word.pop_back();
+        }
+        dictionary.push_back(word);
+    }
+
+    std::vector<std::string> words;
+    for(int i = 0; i < copies; i++) {
+        for(const std::string &w : dictionary) {
+            words.push_back(i == 0 ? w : w + std::to_string(i));
+        }
+    }
+    std::mt19937_64 prng(time(0));
+    std::shuffle(words.begin(), words.end(), prng);
+    std::vector<std::string> expected = words;
+    std::sort(expected.begin(), expected.end());
+
+    auto less = [](const std::string &x, const std::string &y) {
+        return x < y;
+    };
+    auto threeWay = [](const std::string &x, const std::string &y) {
+        return x.compare(y);
+    };
+    double pDur[] = {
+        timeSort(words, expected, [&](std::string *pArr, size_t n) {
+            SearchNSort<std::string>::introSort(pArr, n, less);
+        }),
+        timeSort(words, expected, [&](std::string *pArr, size_t n) {
+            SearchNSort<std::string>::threeWayQuickSort(pArr, n, threeWay);
+        }),
+        timeSort(words, expected, [](std::string *pArr, size_t n) {
+            SearchNSort<std::string>::multikeyQuickSort(pArr, n);
+        }),
+        timeSort(words, expected, [](std::string *pArr, size_t n) {
+            SearchNSort<std::string>::msdRadixSort(pArr, n);
+        }),
+        timeSort(words, expected, [](std::string *pArr, size_t n) {
+            std::sort(pArr, pArr + n);
+        })
+    };
+
+    if(std::any_of(pDur, pDur + 5, [](double d) { return d < 0.0; })) {
+        fprintf(stderr, "\nSORT FAILURE!\n");
+        return EXIT_FAILURE;
+    }
+    printf("%10s,%12s,%12s,%12s,%12s,%12s\n", "n", "intro", "threeWay",
+        "multikey", "msdRadix", "std");
+    printf("%10zu", words.size());
+    for(double dur : pDur) {
+        printf(", %0.5E", dur);
+    }
+    printf("\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,4 @@
+// phantom C++ file for TopK unit testing. This file only inlcudes the 
+// TopK header; doctest generates the testing program based on unit 
+// tests written alongside the code in the header file
+#include "TopK.hpp"
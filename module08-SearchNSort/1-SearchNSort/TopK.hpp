@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <ctime>
+#include <doctest.h>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "SearchNSort.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief The k smallest elements of a stream, kept in a bounded heap.
+ *
+ * SearchNSort::partialSort() needs the whole array in memory. TopK sees
+ * one element at a time and keeps only the k smallest seen so far, in a
+ * max-heap whose root is the largest of them. A new element that is not
+ * smaller than the root is turned away after one comparison, which is what
+ * happens to most elements of a long stream; one that is smaller replaces
+ * the root and sinks into place with SearchNSort's siftDown(). A stream of
+ * n elements costs O(n lg k) time at worst and O(k) memory.
+ *
+ * An element equal to the largest one kept is turned away, so a later
+ * element never displaces an equal earlier one. For the k largest
+ * elements, reverse the comparator.
+ *
+ * @tparam T Type of element.
+ * @tparam Compare Comparator type; see SearchNSort.
+ */
+template <class T, class Compare = std::less<T>> class TopK {
+public:
+  /**
+   * @brief Construct a new, empty TopK.
+   *
+   * @param k Number of smallest elements to keep.
+   * @param compare Comparator used to compare two elements.
+   */
+  explicit TopK(size_t k, Compare compare = Compare());
+
+  /**
+   * @brief Offer an element, which is kept if it is among the k smallest
+   * so far.
+   *
+   * @param x Element to offer.
+   */
+  void push(const T &x);
+
+  /**
+   * @brief Get the number of elements kept, which is k once at least k
+   * have been offered.
+   *
+   * @return size_t Number of elements kept.
+   */
+  size_t size() const { return heap.size(); }
+
+  /**
+   * @brief Get the largest element kept: once k elements are kept, an
+   * element must be smaller than this to get in.
+   *
+   * @return const T& Reference to the largest element kept.
+   * @throws std::out_of_range if no elements are kept.
+   */
+  const T &threshold() const;
+
+  /**
+   * @brief Get the elements kept, smallest first.
+   *
+   * @return std::vector<T> The kept elements in sorted order.
+   */
+  std::vector<T> sorted() const;
+
+  /**
+   * @brief Forget every element kept, to start a new stream.
+   */
+  void clear() { heap.clear(); }
+
+private:
+  /**
+   * @brief Number of elements to keep.
+   */
+  size_t k;
+
+  /**
+   * @brief Comparator used to compare two elements.
+   */
+  Compare compare;
+
+  /**
+   * @brief Kept elements, as a max-heap.
+   */
+  std::vector<T> heap;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Implementation of TopK constructor.
+ */
+template <class T, class Compare>
+TopK<T, Compare>::TopK(size_t k, Compare compare) : k(k), compare(compare) {
+  heap.reserve(k);
+}
+
+/*
+ * Implementation of push() function.
+ */
+template <class T, class Compare> void TopK<T, Compare>::push(const T &x) {
+  if (heap.size() < k) {
+    // not full yet: add x as a leaf and float it up
+    heap.push_back(x);
+    for (size_t i = heap.size() - 1; i > 0u;) {
+      size_t parent = (i - 1) / 2;
+      if (!SearchNSort<T>::before(compare, heap[parent], heap[i])) {
+        break;
+      }
+      std::swap(heap[parent], heap[i]);
+      i = parent;
+    }
+  } else if (k > 0u && SearchNSort<T>::before(compare, x, heap[0])) {
+    heap[0] = x;
+    SearchNSort<T>::siftDown(heap.data(), 0, k, compare);
+  }
+}
+
+/*
+ * Implementation of threshold() function.
+ */
+template <class T, class Compare>
+const T &TopK<T, Compare>::threshold() const {
+  if (heap.empty()) {
+    throw std::out_of_range("No elements in TopK::threshold()");
+  }
+  return heap[0];
+}
+
+/*
+ * Implementation of sorted() function.
+ */
+template <class T, class Compare>
+std::vector<T> TopK<T, Compare>::sorted() const {
+  // heapSort() builds the heap again, which costs only O(k) more
+  std::vector<T> res = heap;
+  SearchNSort<T>::heapSort(res.data(), res.size(), compare);
+  return res;
+}
+
+// doctest unit test for TopK
+TEST_CASE("testing TopK") {
+  // streams of random values, against sorting the whole stream
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<int> dist(-1000, 1000);
+  for (size_t k : {0u, 1u, 5u, 100u, 2000u}) {
+    std::vector<int> stream(1000);
+    TopK<int> top(k);
+    for (int &x : stream) {
+      x = dist(prng);
+      top.push(x);
+    }
+    std::sort(stream.begin(), stream.end());
+    size_t m = std::min(k, stream.size());
+    CHECK(m == top.size());
+    std::vector<int> kept = top.sorted();
+    CHECK(std::equal(kept.begin(), kept.end(), stream.begin()));
+    CHECK(m == kept.size());
+    if (m > 0u) {
+      CHECK(stream[m - 1] == top.threshold());
+    }
+  }
+
+  // the k largest with a reversed three-way comparator; the last 9 ties
+  // the threshold and is turned away
+  typedef std::pair<int, size_t> Item;
+  auto descending = [](const Item &a, const Item &b) {
+    return b.first - a.first;
+  };
+  TopK<Item, decltype(descending)> top(3, descending);
+  int keys[] = {5, 9, 9, 1, 9, 7, 9};
+  for (size_t i = 0; i < 7; i++) {
+    top.push(Item(keys[i], i));
+  }
+  std::vector<Item> kept = top.sorted();
+  REQUIRE(3 == kept.size());
+  std::sort(kept.begin(), kept.end());
+  CHECK(Item(9, 1) == kept[0]);
+  CHECK(Item(9, 2) == kept[1]);
+  CHECK(Item(9, 4) == kept[2]);
+
+  // comparisons: a long ascending stream is turned away one comparison at
+  // a time once the heap is full
+  size_t count = 0;
+  auto counting = [&count](const int &a, const int &b) {
+    count++;
+    return a < b;
+  };
+  TopK<int, decltype(counting)> small(10, counting);
+  for (int i = 0; i < 100000; i++) {
+    small.push(i);
+  }
+  CHECK(count < 100000 + 100);
+
+  // an empty TopK has no threshold
+  small.clear();
+  CHECK(0 == small.size());
+  bool flag = false;
+  try {
+    small.threshold();
+  } catch (const std::out_of_range &) {
+    flag = true;
+  }
+  CHECK(flag);
+}
@@ -0,0 +1,4 @@
+// phantom C++ file for JohnsonScheduler unit testing. This file only
+// inlcudes the JohnsonScheduler header; doctest generates the testing
+// program based on unit tests written alongside the code in the header file
+#include "JohnsonScheduler.hpp"
@@ -0,0 +1,595 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <doctest.h>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../1-SearchNSort/SearchNSort.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Class representing a task that takes two phases.
+ *
+ */
+class Task {
+public:
+  /**
+   * @brief Construct a new Task object with empty values.
+   *
+   */
+  Task() : name(""), elapsed1(0), elapsed2(0) {}
+
+  /**
+   * @brief Construct a new Task object.
+   *
+   * @param name Name of the task.
+   * @param elapsed1 Elapsed time for phase 1.
+   * @param elapsed2 Elapsed time for phase 2.
+   */
+  Task(const std::string &name, size_t elapsed1, size_t elapsed2)
+      : name(name), elapsed1(elapsed1), elapsed2(elapsed2) {}
+
+  /**
+   * @brief Name of the task.
+   *
+   */
+  std::string name;
+  /**
+   * @brief Elapsed time for phase 1.
+   *
+   */
+  size_t elapsed1;
+  /**
+   * @brief Elapsed time for phase 2.
+   *
+   */
+  size_t elapsed2;
+
+  /**
+   * @brief Override of < for Task objects.
+   *
+   * @param t Task to compare with this one.
+   * @return If elapsed1 fields are equal, return elapsed2 < t.elapsed 2;
+   * otherwise, return elapsed1 < t.elapsed1;
+   */
+  bool operator<(const Task &t) const {
+    if (elapsed1 == t.elapsed1) {
+      return elapsed2 < t.elapsed2;
+    } else {
+      return elapsed1 < t.elapsed1;
+    }
+  }
+
+  /**
+   * @brief Override of > for Task objects.
+   *
+   * @param t Task to compare with this one.
+   * @return If elapsed1 fields are equal, return elapsed2 > t.elapsed 2;
+   * otherwise, return elapsed1 > t.elapsed1;
+   */
+  bool operator>(const Task &t) const {
+    if (elapsed1 == t.elapsed1) {
+      return elapsed2 > t.elapsed2;
+    } else {
+      return elapsed1 > t.elapsed1;
+    }
+  }
+
+  /**
+   * @brief Override of == for Task objects.
+   *
+   * @param t Task to compare with this one.
+   * @return If elapsed1 fields are equal, return elapsed2 == t.elapsed 2;
+   * otherwise, return elapsed1 == t.elapsed1;
+   */
+  bool operator==(const Task &t) const {
+    if (elapsed1 == t.elapsed1) {
+      return elapsed2 == t.elapsed2;
+    } else {
+      return elapsed1 == t.elapsed1;
+    }
+  }
+};
+
+/**
+ * @brief Stream insertion override for Task objects.
+ *
+ * @param out std::ostream to write to
+ * @param t Task object to write
+ * @return std::ostream& out for chaining
+ */
+inline std::ostream &operator<<(std::ostream &out, const Task &t) {
+  out << t.name << ": (" << t.elapsed1 << ", " << t.elapsed2 << ")";
+  return out;
+}
+
+/**
+ * @brief Two-machine flow shop scheduler using Johnson's rule.
+ *
+ * Every task runs phase 1 on the first machine and then phase 2 on the
+ * second, and each machine runs one task at a time. Johnson's rule finds
+ * an order that finishes the last task as early as possible: first the
+ * tasks whose phase 1 is shorter than their phase 2, by increasing phase 1
+ * time, so the second machine gets work early; then the rest, by
+ * decreasing phase 2 time, so little is left for the second machine once
+ * the first is done. schedule() splits compact (time, index) pairs into
+ * the two groups in one pass and sorts each group with
+ * SearchNSort::radixSort(), so only the pairs are sorted and each Task is
+ * moved once. That takes O(n) time, within the O(n lg n) a comparison sort
+ * would need. Tasks with equal keys keep the order they were added in.
+ *
+ * Tasks are read from text files of one record per line, a name and the
+ * start and end times of both phases, as in times.txt. The file is read a
+ * block at a time and parsed in place, so millions of records take a few
+ * seconds. A first line holding only a number, such as the task count at
+ * the top of times.txt, is used as a hint for how many tasks to expect, as
+ * far as the file is large enough to hold them.
+ */
+class JohnsonScheduler {
+public:
+  /**
+   * @brief Size of each block read by readFile().
+   */
+  static const size_t BLOCK_BYTES = 1 << 16;
+
+  /**
+   * @brief Add a task at the end of the current order.
+   *
+   * @param t Task to add.
+   */
+  void add(const Task &t) { tasks.push_back(t); }
+
+  /**
+   * @brief Read tasks from a file and add them, in file order.
+   *
+   * Each line is blank or holds a task name followed by the start and end
+   * times of phase 1 and of phase 2, separated by spaces or tabs; the first
+   * line may instead hold a count hint. DOS line endings are accepted.
+   *
+   * @param path Path of the file to read.
+   * @return size_t Number of tasks read.
+   * @throws std::runtime_error if the file cannot be opened or read, or a
+   * line is not a valid record.
+   */
+  size_t readFile(const std::string &path);
+
+  /**
+   * @brief Put the tasks in the order given by Johnson's rule, which
+   * minimizes the makespan.
+   */
+  void schedule();
+
+  /**
+   * @brief Get the number of tasks.
+   *
+   * @return size_t Number of tasks.
+   */
+  size_t size() const { return tasks.size(); }
+
+  /**
+   * @brief Get the task at a position of the current order.
+   *
+   * @param i Position of the task.
+   * @return const Task& Reference to the task.
+   * @throws std::out_of_range if i is not less than size().
+   */
+  const Task &operator[](size_t i) const;
+
+  /**
+   * @brief Get the time from starting the first task to finishing the last
+   * one, in the current order.
+   *
+   * @return size_t The makespan.
+   */
+  size_t makespan() const;
+
+  /**
+   * @brief Get the total time the first machine is idle before the
+   * makespan ends, in the current order; it is never idle before its last
+   * task finishes.
+   *
+   * @return size_t Idle time of the first machine.
+   */
+  size_t idleTime1() const;
+
+  /**
+   * @brief Get the total time the second machine is idle before the
+   * makespan ends, in the current order, including the wait for the first
+   * task's phase 1.
+   *
+   * @return size_t Idle time of the second machine.
+   */
+  size_t idleTime2() const;
+
+private:
+  /**
+   * @brief Tasks, in the current order.
+   */
+  std::vector<Task> tasks;
+
+  /**
+   * @brief Fewest bytes a task record and its newline can take, such as
+   * "a 0 0 0 0\n".
+   */
+  static const size_t MIN_RECORD_BYTES = 10;
+
+  /**
+   * @brief Parse the line [pBegin, pEnd) of a task file, adding the task
+   * it holds, if any; a count hint on line 1 reserves room for at most
+   * maxHint tasks.
+   */
+  void parseLine(const char *pBegin, const char *pEnd, size_t lineNum,
+                 size_t maxHint);
+
+  /**
+   * @brief Parse [pBegin, pEnd) as an unsigned number, returning false if
+   * it is not one.
+   */
+  static bool parseNumber(const char *pBegin, const char *pEnd,
+                          size_t &value);
+
+  /**
+   * @brief Sum of one phase's times over all tasks.
+   */
+  size_t total(size_t Task::*pElapsed) const;
+};
+
+//-----------------------------------------------------------------------------
+// function implementations
+//-----------------------------------------------------------------------------
+
+/*
+ * Implementation of makespan() function.
+ */
+inline size_t JohnsonScheduler::makespan() const {
+  // the second machine starts a task once the first machine has finished
+  // its phase 1 and the second machine has finished the task before it
+  size_t finish1 = 0, finish2 = 0;
+  for (const Task &t : tasks) {
+    finish1 += t.elapsed1;
+    finish2 = std::max(finish1, finish2) + t.elapsed2;
+  }
+  return finish2;
+}
+
+/*
+ * Implementation of idleTime1() function.
+ */
+inline size_t JohnsonScheduler::idleTime1() const {
+  return makespan() - total(&Task::elapsed1);
+}
+
+/*
+ * Implementation of idleTime2() function.
+ */
+inline size_t JohnsonScheduler::idleTime2() const {
+  return makespan() - total(&Task::elapsed2);
+}
+
+/*
+ * Implementation of private total() helper function.
+ */
+inline size_t JohnsonScheduler::total(size_t Task::*pElapsed) const {
+  size_t sum = 0;
+  for (const Task &t : tasks) {
+    sum += t.*pElapsed;
+  }
+  return sum;
+}
+
+// doctest unit test for makespan and idle times
+TEST_CASE("testing JohnsonScheduler::makespan") {
+  JohnsonScheduler empty;
+  CHECK(0 == empty.makespan());
+  CHECK(0 == empty.idleTime1());
+  CHECK(0 == empty.idleTime2());
+
+  // machine 1 runs 0-3, 3-5, 5-9; machine 2 waits until 3, runs 3-7,
+  // 7-8, waits until 9, and runs 9-11
+  JohnsonScheduler js;
+  js.add(Task("a", 3, 4));
+  js.add(Task("b", 2, 1));
+  js.add(Task("c", 4, 2));
+  CHECK(11 == js.makespan());
+  CHECK(2 == js.idleTime1());
+  CHECK(4 == js.idleTime2());
+}
+
+/*
+ * Implementation of operator[].
+ */
+inline const Task &JohnsonScheduler::operator[](size_t i) const {
+  if (i >= tasks.size()) {
+    throw std::out_of_range("Index out of range in "
+                            "JohnsonScheduler::operator[]()");
+  }
+  return tasks[i];
+}
+
+/*
+ * Implementation of private parseNumber() helper function.
+ */
+inline bool JohnsonScheduler::parseNumber(const char *pBegin,
+                                          const char *pEnd, size_t &value) {
+  const size_t MAX = std::numeric_limits<size_t>::max();
+  value = 0;
+  for (const char *p = pBegin; p < pEnd; p++) {
+    size_t digit = size_t(*p - '0');
+    if (digit > 9u || value > (MAX - digit) / 10) {
+      return false;
+    }
+    value = value * 10 + digit;
+  }
+  return pBegin < pEnd;
+}
+
+/*
+ * Implementation of private parseLine() helper function.
+ */
+inline void JohnsonScheduler::parseLine(const char *pBegin, const char *pEnd,
+                                        size_t lineNum, size_t maxHint) {
+  // split the line into at most six fields; a sixth means too many
+  const char *ppFields[6][2];
+  size_t numFields = 0;
+  const char *p = pBegin;
+  while (numFields < 6) {
+    while (p < pEnd && (*p == ' ' || *p == '\t' || *p == '\r')) {
+      p++;
+    }
+    if (p == pEnd) {
+      break;
+    }
+    ppFields[numFields][0] = p;
+    while (p < pEnd && *p != ' ' && *p != '\t' && *p != '\r') {
+      p++;
+    }
+    ppFields[numFields++][1] = p;
+  }
+
+  size_t pTimes[4];
+  bool ok = numFields == 5;
+  for (size_t i = 1; ok && i < 5; i++) {
+    ok = parseNumber(ppFields[i][0], ppFields[i][1], pTimes[i - 1]);
+  }
+  if (ok && pTimes[0] <= pTimes[1] && pTimes[2] <= pTimes[3]) {
+    tasks.push_back(Task(std::string(ppFields[0][0], ppFields[0][1]),
+                         pTimes[1] - pTimes[0], pTimes[3] - pTimes[2]));
+  } else if (numFields == 1 && lineNum == 1u &&
+             parseNumber(ppFields[0][0], ppFields[0][1], pTimes[0])) {
+    tasks.reserve(tasks.size() + std::min(pTimes[0], maxHint));
+  } else if (numFields > 0u) {
+    throw std::runtime_error("Invalid task record on line " +
+                             std::to_string(lineNum) +
+                             " in JohnsonScheduler::readFile()");
+  }
+}
+
+/*
+ * Implementation of readFile() function.
+ */
+inline size_t JohnsonScheduler::readFile(const std::string &path) {
+  FILE *pFile = std::fopen(path.c_str(), "rb");
+  if (pFile == nullptr) {
+    throw std::runtime_error("Cannot open " + path +
+                             " in JohnsonScheduler::readFile()");
+  }
+
+  size_t before = tasks.size(), lineNum = 1;
+  try {
+    // a count hint larger than the file could hold is not trusted
+    size_t maxHint = 0;
+    if (std::fseek(pFile, 0, SEEK_END) == 0) {
+      long bytes = std::ftell(pFile);
+      maxHint = bytes > 0 ? size_t(bytes) / MIN_RECORD_BYTES : 0;
+    }
+    std::rewind(pFile);
+
+    // lines are parsed straight from the block, except one that straddles
+    // two blocks, which is put together in partial first
+    std::vector<char> block(BLOCK_BYTES);
+    std::string partial;
+    size_t got;
+    while ((got = std::fread(block.data(), 1, BLOCK_BYTES, pFile)) > 0u) {
+      const char *p = block.data(), *pEnd = p + got;
+      const char *pNewline;
+      while ((pNewline = static_cast<const char *>(
+                  std::memchr(p, '\n', pEnd - p))) != nullptr) {
+        if (partial.empty()) {
+          parseLine(p, pNewline, lineNum++, maxHint);
+        } else {
+          partial.append(p, pNewline);
+          parseLine(partial.data(), partial.data() + partial.size(),
+                    lineNum++, maxHint);
+          partial.clear();
+        }
+        p = pNewline + 1;
+      }
+      partial.append(p, pEnd);
+    }
+    if (std::ferror(pFile)) {
+      throw std::runtime_error("Read error in JohnsonScheduler::readFile()");
+    }
+    parseLine(partial.data(), partial.data() + partial.size(), lineNum,
+              maxHint);
+  } catch (...) {
+    std::fclose(pFile);
+    throw;
+  }
+  std::fclose(pFile);
+  return tasks.size() - before;
+}
+
+// doctest unit test for readFile
+TEST_CASE("testing JohnsonScheduler::readFile") {
+  // a count hint, DOS line endings, tabs, a blank line, and a last line
+  // without a newline; a line longer than a block straddles two of them
+  std::string longName(JohnsonScheduler::BLOCK_BYTES + 10, 'x');
+  FILE *pFile = std::fopen("JohnsonTest.txt", "wb");
+  REQUIRE(pFile != nullptr);
+  std::fputs("4\r\nJ1  910 1026 1027 1210\r\n\r\nJ2\t5 5 7 9\r\n", pFile);
+  std::fprintf(pFile, "%s 0 1 2 4\nJ4 100 200 300 301", longName.c_str());
+  std::fclose(pFile);
+
+  JohnsonScheduler js;
+  CHECK(4 == js.readFile("JohnsonTest.txt"));
+  REQUIRE(4 == js.size());
+  CHECK("J1" == js[0].name);
+  CHECK(116 == js[0].elapsed1);
+  CHECK(183 == js[0].elapsed2);
+  CHECK("J2" == js[1].name);
+  CHECK(0 == js[1].elapsed1);
+  CHECK(2 == js[1].elapsed2);
+  CHECK(longName == js[2].name);
+  CHECK(1 == js[3].elapsed2);
+
+  // a count hint far larger than the file is not trusted
+  pFile = std::fopen("JohnsonTest.txt", "wb");
+  REQUIRE(pFile != nullptr);
+  std::fputs("1000000000000000000\nJ5 0 1 2 3\n", pFile);
+  std::fclose(pFile);
+  CHECK(1 == js.readFile("JohnsonTest.txt"));
+  CHECK(5 == js.size());
+
+  // malformed records, with too few fields, too many, a field that is not
+  // a number, or a phase that ends before it starts, and a count hint
+  // after the first line
+  const char *ppBad[] = {"J1 1 2 3\n", "J1 1 2 3 4 5\n", "J1 1 2 x 4\n",
+                         "J1 1 2 4 3\n", "4 5\n", "7\n"};
+  for (const char *pszBad : ppBad) {
+    pFile = std::fopen("JohnsonTest.txt", "wb");
+    REQUIRE(pFile != nullptr);
+    std::fprintf(pFile, "J0 0 1 2 3\n%s", pszBad);
+    std::fclose(pFile);
+    bool flag = false;
+    try {
+      js.readFile("JohnsonTest.txt");
+    } catch (const std::runtime_error &) {
+      flag = true;
+    }
+    CHECK(flag);
+  }
+  std::remove("JohnsonTest.txt");
+
+  // a missing file
+  bool flag = false;
+  try {
+    js.readFile("JohnsonTest.txt");
+  } catch (const std::runtime_error &) {
+    flag = true;
+  }
+  CHECK(flag);
+
+  flag = false;
+  try {
+    JohnsonScheduler().operator[](0);
+  } catch (const std::out_of_range &) {
+    flag = true;
+  }
+  CHECK(flag);
+}
+
+/*
+ * Implementation of schedule() function.
+ */
+inline void JohnsonScheduler::schedule() {
+  // partition (key, index) pairs into the two groups, each in task order;
+  // complementing phase 2 times makes an increasing sort of the second
+  // group put them in decreasing order
+  typedef std::pair<size_t, size_t> Entry;
+  size_t n = tasks.size(), numFirst = 0;
+  for (const Task &t : tasks) {
+    numFirst += t.elapsed1 < t.elapsed2;
+  }
+  std::vector<Entry> order(n);
+  for (size_t i = 0, first = 0, second = numFirst; i < n; i++) {
+    const Task &t = tasks[i];
+    if (t.elapsed1 < t.elapsed2) {
+      order[first++] = Entry(t.elapsed1, i);
+    } else {
+      order[second++] = Entry(~t.elapsed2, i);
+    }
+  }
+
+  // stable sorts keep tasks with equal keys in order
+  auto key = [](const Entry &e) { return e.first; };
+  SearchNSort<Entry>::radixSort(order.data(), numFirst, key);
+  SearchNSort<Entry>::radixSort(order.data() + numFirst, n - numFirst, key);
+
+  // gathering into a new array reads the tasks in random order but writes
+  // them in sequence, which beats following permute()'s cycles
+  std::vector<Task> scheduled;
+  scheduled.reserve(n);
+  for (const Entry &e : order) {
+    scheduled.push_back(std::move(tasks[e.second]));
+  }
+  tasks.swap(scheduled);
+}
+
+// doctest unit test for schedule
+TEST_CASE("testing JohnsonScheduler::schedule") {
+  // the example from makespan's test improves from 11 to 10
+  JohnsonScheduler js;
+  js.add(Task("a", 3, 4));
+  js.add(Task("b", 2, 1));
+  js.add(Task("c", 4, 2));
+  js.schedule();
+  CHECK("a" == js[0].name);
+  CHECK("c" == js[1].name);
+  CHECK("b" == js[2].name);
+  CHECK(10 == js.makespan());
+
+  // on small random instances the makespan matches the best of every
+  // order, found by brute force
+  std::mt19937_64 prng(time(0));
+  std::uniform_int_distribution<size_t> dist(0, 20);
+  for (size_t trial = 0; trial < 100; trial++) {
+    size_t n = trial % 8;
+    std::vector<Task> tasks(n);
+    for (size_t i = 0; i < n; i++) {
+      tasks[i] = Task(std::to_string(i), dist(prng), dist(prng));
+    }
+
+    JohnsonScheduler johnson;
+    for (const Task &t : tasks) {
+      johnson.add(t);
+    }
+    johnson.schedule();
+
+    size_t best = std::numeric_limits<size_t>::max();
+    std::sort(tasks.begin(), tasks.end(),
+              [](const Task &a, const Task &b) { return a.name < b.name; });
+    do {
+      JohnsonScheduler order;
+      for (const Task &t : tasks) {
+        order.add(t);
+      }
+      best = std::min(best, order.makespan());
+    } while (std::next_permutation(
+        tasks.begin(), tasks.end(),
+        [](const Task &a, const Task &b) { return a.name < b.name; }));
+    CHECK(best == johnson.makespan());
+  }
+
+  // tasks with equal keys keep their order
+  JohnsonScheduler ties;
+  ties.add(Task("p", 1, 5));
+  ties.add(Task("q", 3, 3));
+  ties.add(Task("r", 1, 5));
+  ties.add(Task("s", 3, 3));
+  ties.schedule();
+  CHECK("p" == ties[0].name);
+  CHECK("r" == ties[1].name);
+  CHECK("q" == ties[2].name);
+  CHECK("s" == ties[3].name);
+}
@@ -0,0 +1,80 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <string>
+#include "JohnsonScheduler.hpp"
+
+/**
+ * @brief Seconds elapsed since a given time.
+ *
+ * @param begin Starting time
+ *
+ * @return Seconds since begin
+ */
+double secondsSince(std::chrono::high_resolution_clock::time_point begin) {
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end -
+        begin).count() / 1e9;
+}
+
+/**
+ * @brief Application entry point.
+ *
+ * Writes a file of random task records in the format of times.txt, then
+ * times reading it into a JohnsonScheduler and scheduling it, and reports
+ * the makespan and idle times before and after scheduling. The file goes
+ * in the current directory, unless a path is given.
+ *
+ * @param argc Number of command-line arguments
+ *
+ * @param ppszArgs Array of command-line argument strings
+ */
+int main(int argc, char **ppszArgs) {
+    // command-line argument sanity check
+    if(argc < 2) {
+        fprintf(stderr, "Usage: ./SchedulingBench numTasks [path]\n");
+        return EXIT_FAILURE;
+    }
+    size_t n = atol(ppszArgs[1]);
+    std::string path = argc > 2 ? ppszArgs[2] : "SchedulingBench.txt";
+
+    // each phase starts some time after the one before it ends
+    std::mt19937_64 prng(time(0));
+    std::uniform_int_distribution<size_t> dist(1, 1000);
+    FILE *pFile = fopen(path.c_str(), "w");
+    if(pFile == nullptr) {
+        fprintf(stderr, "Cannot create %s\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+    fprintf(pFile, "%zu\n", n);
+    size_t now = 0;
+    for(size_t i = 0; i < n; i++) {
+        size_t s1 = now + dist(prng), e1 = s1 + dist(prng);
+        size_t s2 = e1 + dist(prng), e2 = s2 + dist(prng);
+        fprintf(pFile, "J%zu %zu %zu %zu %zu\n", i + 1, s1, e1, s2, e2);
+        now = s1;
+    }
+    fclose(pFile);
+
+    JohnsonScheduler js;
+    auto begin = std::chrono::high_resolution_clock::now();
+    js.readFile(path);
+    double readTime = secondsSince(begin);
+    size_t before = js.makespan();
+
+    begin = std::chrono::high_resolution_clock::now();
+    js.schedule();
+    double scheduleTime = secondsSince(begin);
+    remove(path.c_str());
+
+    printf("%zu tasks: read %0.3f s, schedule %0.3f s\n", js.size(),
+        readTime, scheduleTime);
+    printf("makespan %zu in file order, %zu by Johnson's rule\n", before,
+        js.makespan());
+    printf("idle time %zu (machine 1), %zu (machine 2)\n", js.idleTime1(),
+        js.idleTime2());
+
+    return EXIT_SUCCESS;
+}
@@ -4,6 +4,7 @@
 #include <ctime>
 #include <random>
 #include "BucketSort.hpp"
+#include "ParallelBucketSort.hpp"
 #include "../1-SearchNSort/SearchNSort.hpp"
 
 /**
@@ -90,8 +91,9 @@ int main(int argc, char **ppszArgs) {
     int powerCap = atoi(ppszArgs[1]);
 
     unsigned n = 256;
+    ThreadPool pool;
 
-    printf("%8s,%12s,%12s\n", "n" ,"bs" ,"qs");
+    printf("%8s,%12s,%12s,%12s\n", "n" ,"bs" ,"qs", "pbs");
     for(int power = 8; power <= powerCap; power++) {
         double *pArr = new double[n];
         fill(pArr, n);
@@ -130,6 +132,23 @@ int main(int argc, char **ppszArgs) {
             dur += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
         }
         dur /= 10.0;
+        printf("%0.5LE, ", dur);
+
+        // parallel bucketsort tests
+        dur = 0;
+        for(int i = 0; i < 10; i++) {
+            shuffle(pArr, n);
+            auto begin = std::chrono::high_resolution_clock::now();
+            parallelBucketSort(pArr, n, pool);
+            auto end = std::chrono::high_resolution_clock::now();
+
+            if(!isSorted(pArr, n)) {
+                fprintf(stderr, "PARALLEL BUCKETSORT FAILURE!\n");
+                return EXIT_FAILURE;
+            }
+            dur += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+        }
+        dur /= 10.0;
         printf("%0.5LE\n", dur);
 
         delete [] pArr;
@@ -0,0 +1,4 @@
+// phantom C++ file for parallelBucketSort unit testing. This file only 
+// inlcudes the ParallelBucketSort header; doctest generates the testing 
+// program based on unit tests written alongside the code in the header files
+#include "ParallelBucketSort.hpp"
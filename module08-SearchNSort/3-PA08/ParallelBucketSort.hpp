@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <doctest.h>
+#include <functional>
+#include <future>
+#include <random>
+#include <vector>
+#include "../1-SearchNSort/SearchNSort.hpp"
+#include "../1-SearchNSort/ThreadPool.hpp"
+
+/*-----------------------------------------------------------------------------
+ * class definition
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Key-to-bucket mapping for keys spread evenly over [lo, hi).
+ *
+ * A mapping is any function object taking a key and the number of buckets,
+ * and returning a bucket index in [0, numBuckets). It must keep order:
+ * if x < y, x's bucket must not come after y's. Keys outside [lo, hi) go to
+ * the first or last bucket.
+ */
+class UniformBuckets {
+public:
+    /**
+     * @brief Construct a new UniformBuckets mapping.
+     *
+     * @param lo Smallest expected key.
+     * @param hi Largest expected key, exclusive.
+     */
+    UniformBuckets(double lo = 0.0, double hi = 1.0) : lo(lo),
+        scale(1.0 / (hi - lo)) { }
+
+    /**
+     * @brief Map a key to a bucket.
+     */
+    size_t operator()(double key, size_t numBuckets) const {
+        double pos = (key - lo) * scale * numBuckets;
+        if(!(pos > 0)) {
+            return 0;
+        }
+        return std::min(static_cast<size_t>(pos), numBuckets - 1);
+    }
+
+private:
+    /**
+     * @brief Smallest expected key.
+     */
+    double lo;
+
+    /**
+     * @brief 1 / (hi - lo).
+     */
+    double scale;
+};
+
+/*-----------------------------------------------------------------------------
+ * function definitions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * @brief Average number of elements per bucket parallelBucketSort() aims
+ * for.
+ */
+const size_t BUCKET_SIZE = 32;
+
+/**
+ * @brief Parallel bucket sort for arrays of any element type.
+ *
+ * Unlike the vector-of-vectors bucket sort in BucketSort.hpp, this version
+ * makes no allocation per bucket, adapts the number of buckets to n, and
+ * runs on every worker of a ThreadPool:
+ *
+ *   - the array is cut into one block per worker, and each worker counts
+ *     how many of its block's elements fall in each bucket
+ *
+ *   - prefix sums of the counts give every block its own write position in
+ *     every bucket, so the workers can then copy their elements into one
+ *     contiguous scratch buffer, bucket by bucket, without any locking
+ *
+ *   - the buckets are dealt out to the workers in contiguous groups of
+ *     about n / numThreads elements, and each worker sorts its buckets with
+ *     SearchNSort::introSort() and copies them back
+ *
+ * Elements are compared with operator<. For keys that are not uniform over
+ * a known range, pass a mapping that spreads them evenly, such as one based
+ * on the keys' cumulative distribution function. A poor mapping costs
+ * speed, never correctness: an overfull bucket is simply a bigger
+ * introsort.
+ *
+ * @param pArr Pointer to the array to be sorted
+ *
+ * @param n Number of elements in the array
+ *
+ * @param bucketOf Order-keeping key-to-bucket mapping; see UniformBuckets
+ *
+ * @param pool Pool whose workers do the sorting
+ */
+template <class T, class BucketOf>
+void parallelBucketSort(T *pArr, size_t n, BucketOf bucketOf,
+    ThreadPool &pool) {
+
+    if(n < 2) {
+        return;
+    }
+    size_t numBuckets = std::max<size_t>(1, n / BUCKET_SIZE);
+    size_t numBlocks = std::min(pool.numThreads(), n);
+    size_t blockSize = (n + numBlocks - 1) / numBlocks;
+
+    // counts[b * numBuckets + k]: elements of block b in bucket k
+    std::vector<size_t> counts(numBlocks * numBuckets, 0);
+    std::vector<std::future<void>> tasks;
+    for(size_t b = 0; b < numBlocks; b++) {
+        tasks.push_back(pool.submit([=, &counts, &bucketOf](size_t) {
+            size_t *pCount = &counts[b * numBuckets];
+            size_t end = std::min(n, (b + 1) * blockSize);
+            for(size_t i = b * blockSize; i < end; i++) {
+                pCount[bucketOf(pArr[i], numBuckets)]++;
+            }
+        }));
+    }
+    for(std::future<void> &t : tasks) {
+        pool.wait(t);
+    }
+    tasks.clear();
+
+    // bucket k starts at starts[k]; within it, block b writes after the
+    // elements of blocks 0 to b - 1
+    std::vector<size_t> starts(numBuckets + 1);
+    size_t offset = 0;
+    for(size_t k = 0; k < numBuckets; k++) {
+        starts[k] = offset;
+        for(size_t b = 0; b < numBlocks; b++) {
+            size_t c = counts[b * numBuckets + k];
+            counts[b * numBuckets + k] = offset;
+            offset += c;
+        }
+    }
+    starts[numBuckets] = n;
+
+    // scatter into the scratch buffer
+    T *pBuf = new T[n];
+    for(size_t b = 0; b < numBlocks; b++) {
+        tasks.push_back(pool.submit([=, &counts, &bucketOf](size_t) {
+            size_t *pPos = &counts[b * numBuckets];
+            size_t end = std::min(n, (b + 1) * blockSize);
+            for(size_t i = b * blockSize; i < end; i++) {
+                pBuf[pPos[bucketOf(pArr[i], numBuckets)]++] = pArr[i];
+            }
+        }));
+    }
+    for(std::future<void> &t : tasks) {
+        pool.wait(t);
+    }
+    tasks.clear();
+
+    // sort groups of whole buckets holding about n / numBlocks elements
+    // each, and copy them back
+    auto less = [](const T &x, const T &y) { return x < y; };
+    size_t first = 0;
+    for(size_t b = 0; b < numBlocks && first < numBuckets; b++) {
+        size_t target = (b + 1) * n / numBlocks;
+        size_t last = std::upper_bound(starts.begin() + first,
+            starts.end() - 1, target) - starts.begin();
+        last = std::max(last, first + 1);
+        if(b == numBlocks - 1) {
+            last = numBuckets;
+        }
+        tasks.push_back(pool.submit([=, &starts](size_t) {
+            for(size_t k = first; k < last; k++) {
+                SearchNSort<T>::introSort(pBuf + starts[k],
+                    starts[k + 1] - starts[k], less);
+            }
+            std::copy(pBuf + starts[first], pBuf + starts[last],
+                pArr + starts[first]);
+        }));
+        first = last;
+    }
+    for(std::future<void> &t : tasks) {
+        pool.wait(t);
+    }
+
+    delete [] pBuf;
+}
+
+/**
+ * @brief Parallel bucket sort for doubles in [0, 1), the PA08 workload.
+ *
+ * @param pArr Pointer to the array to be sorted
+ *
+ * @param n Number of elements in the array
+ *
+ * @param pool Pool whose workers do the sorting
+ */
+void parallelBucketSort(double *pArr, size_t n, ThreadPool &pool) {
+    parallelBucketSort(pArr, n, UniformBuckets(), pool);
+}
+
+TEST_CASE("testing parallelBucketSort") {
+    ThreadPool pool(4);
+    std::mt19937_64 prng(time(0));
+
+    // the PA08 workload, at sizes around the edge cases
+    std::uniform_real_distribution<double> dist;
+    for(size_t n : {0, 1, 2, 3, 31, 32, 33, 100, 1000, 100000}) {
+        std::vector<double> pA(n), pB;
+        for(size_t i = 0; i < n; i++) {
+            pA[i] = dist(prng);
+        }
+        pB = pA;
+        parallelBucketSort(pA.data(), n, pool);
+        std::sort(pB.begin(), pB.end());
+        CHECK(pA == pB);
+    }
+
+    // skewed keys: squares of uniform values pile up near 0, and mapping
+    // through the square root spreads them back out
+    const size_t n = 100000;
+    std::vector<double> pA(n), pB;
+    for(size_t i = 0; i < n; i++) {
+        double u = dist(prng);
+        pA[i] = u * u;
+    }
+    pB = pA;
+    parallelBucketSort(pA.data(), n, [](double x, size_t numBuckets) {
+        return std::min(static_cast<size_t>(std::sqrt(x) * numBuckets),
+            numBuckets - 1);
+    }, pool);
+    std::sort(pB.begin(), pB.end());
+    CHECK(pA == pB);
+
+    // keys outside the expected range, and all keys in one bucket
+    for(size_t i = 0; i < n; i++) {
+        pA[i] = i % 3 == 0 ? -dist(prng) : (i % 3 == 1 ? 1 + dist(prng) : 0.5);
+    }
+    pB = pA;
+    parallelBucketSort(pA.data(), n, pool);
+    std::sort(pB.begin(), pB.end());
+    CHECK(pA == pB);
+
+    // integers over a known range
+    std::vector<int> ints(n), intsExpected;
+    std::uniform_int_distribution<int> intDist(-1000, 1000);
+    for(size_t i = 0; i < n; i++) {
+        ints[i] = intDist(prng);
+    }
+    intsExpected = ints;
+    parallelBucketSort(ints.data(), n, UniformBuckets(-1000, 1001), pool);
+    std::sort(intsExpected.begin(), intsExpected.end());
+    CHECK(ints == intsExpected);
+}